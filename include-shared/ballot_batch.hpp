@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "../include-shared/messages.hpp"
+
+/**
+ * A bump allocator over large blocks. Nothing allocated from it is freed on
+ * its own: Reset releases everything at once, keeping the first block to
+ * allocate from again. Only for types with trivial destructors, which are
+ * never run.
+ */
+class Arena {
+public:
+  explicit Arena(size_t block_size = 1 << 20);
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // Uninitialized room for n values of T
+  template <typename T> T *Allocate(size_t n) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "arena values are never destroyed");
+    static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__,
+                  "blocks are only aligned for new");
+    if (n > SIZE_MAX / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(this->AllocateBytes(n * sizeof(T), alignof(T)));
+  }
+
+  void Reset();
+  size_t BytesUsed() const;
+
+private:
+  void *AllocateBytes(size_t size, size_t alignment);
+
+  struct Block {
+    std::unique_ptr<unsigned char[]> data;
+    size_t size;
+  };
+  std::vector<Block> blocks;
+  size_t block_size;
+  size_t used; // bytes taken from the last block
+  size_t used_before; // bytes taken from every other block
+};
+
+/**
+ * One ballot, as spans over its votes and proofs. In a BallotBatch they
+ * point into the batch's arena, along with the columns the ballot was read
+ * from, and stay valid until the batch is reset.
+ */
+struct BallotView {
+  std::span<const Vote_Struct> votes;
+  std::span<const VoteZKP_Struct> zkps;
+  std::span<const Count_ZKP_Struct> count_zkps;
+
+  // Format versions of the three lists
+  int votes_version = MESSAGE_FORMAT_VERSION;
+  int zkps_version = MESSAGE_FORMAT_VERSION;
+  int count_zkps_version = MESSAGE_FORMAT_VERSION;
+
+  // The serialized lists, exactly as read, and the tallyer's signature
+  std::span<const unsigned char> votes_data;
+  std::span<const unsigned char> zkps_data;
+  std::span<const unsigned char> count_zkps_data;
+  std::string_view tallyer_signature;
+};
+
+/**
+ * Every ballot on the board, read in bulk for verification and aggregation.
+ * The votes and proofs of all ballots are laid out back to back in one
+ * arena, and each ballot is a BallotView of spans into it, so loading a
+ * board takes a handful of large allocations rather than several vectors
+ * per ballot, and dropping it is one reset.
+ */
+class BallotBatch {
+public:
+  explicit BallotBatch(size_t block_size = 1 << 20);
+
+  void Add(std::span<const unsigned char> votes_data,
+           std::span<const unsigned char> zkps_data,
+           std::span<const unsigned char> count_zkps_data,
+           std::span<const unsigned char> tallyer_signature);
+
+  size_t Size() const;
+  const BallotView &operator[](size_t i) const;
+  const std::vector<BallotView> &Ballots() const;
+  size_t BytesUsed() const;
+
+  void Reset();
+
+private:
+  std::span<const unsigned char> Keep(std::span<const unsigned char> data);
+
+  Arena arena;
+  std::vector<BallotView> ballots;
+};
+
+// A view of a ballot a voter sent, over the bytes it was deserialized from.
+BallotView view_ballot(const VoterToTallyer_Vote_Message &ballot);
+
+// signing helper for a ballot read into a BallotBatch; the same bytes as
+// concat_votes_and_zkps on the ballot's messages.
+std::vector<unsigned char> concat_votes_and_zkps(const BallotView &ballot,
+                                                 const Vote_Struct &vote_count);
@@ -18,6 +18,7 @@ struct CommonConfig {
   std::string tallyer_verification_key_path;
   std::string num_candidates; // number of candiates in ballot
   std::string k; // maximum number of candidates a voter can vote for
+  std::string group; // election group: "modp2048" (default) or "p256"
 };
 CommonConfig load_common_config(std::string filename);
 
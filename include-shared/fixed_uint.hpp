@@ -0,0 +1,415 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <crypto++/integer.h>
+
+/**
+ * An unsigned integer of N 64-bit limbs, least significant first, held by
+ * value. Group elements and scalars are passed around as these, so the
+ * election's arithmetic never allocates; Integers only appear where values
+ * are parsed, hashed, or loaded from key files.
+ */
+template <std::size_t N> struct FixedUInt {
+  static constexpr std::size_t LIMBS = N;
+  static constexpr std::size_t BYTES = 8 * N;
+
+  std::uint64_t limbs[N] = {};
+
+  constexpr std::uint64_t &operator[](std::size_t i) { return limbs[i]; }
+  constexpr const std::uint64_t &operator[](std::size_t i) const {
+    return limbs[i];
+  }
+  constexpr bool operator==(const FixedUInt &other) const = default;
+
+  static constexpr FixedUInt FromWord(std::uint64_t x) {
+    FixedUInt result;
+    result[0] = x;
+    return result;
+  }
+
+  constexpr bool IsZero() const {
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < N; i++) {
+      bits |= limbs[i];
+    }
+    return bits == 0;
+  }
+
+  unsigned int BitCount() const {
+    for (std::size_t i = N; i > 0; i--) {
+      if (limbs[i - 1] != 0) {
+        return 64 * (i - 1) + std::bit_width(limbs[i - 1]);
+      }
+    }
+    return 0;
+  }
+
+  /**
+   * Returns the `count` bits starting at bit `start`, for count below 32.
+   */
+  unsigned int GetBits(unsigned int start, unsigned int count) const {
+    std::size_t limb = start / 64;
+    unsigned int shift = start % 64;
+    if (limb >= N) {
+      return 0;
+    }
+    std::uint64_t bits = limbs[limb] >> shift;
+    if (shift + count > 64 && limb + 1 < N) {
+      bits |= limbs[limb + 1] << (64 - shift);
+    }
+    return (unsigned int)(bits & ((std::uint64_t(1) << count) - 1));
+  }
+
+  /**
+   * Writes the BYTES big-endian bytes of the value to output.
+   */
+  void Encode(std::uint8_t *output) const {
+    for (std::size_t i = 0; i < N; i++) {
+      std::uint8_t *limb_bytes = output + 8 * (N - 1 - i);
+      for (int b = 0; b < 8; b++) {
+        limb_bytes[b] = std::uint8_t(limbs[i] >> (56 - 8 * b));
+      }
+    }
+  }
+
+  /**
+   * Reads a value from BYTES big-endian bytes.
+   */
+  static FixedUInt Decode(const std::uint8_t *input) {
+    FixedUInt result;
+    for (std::size_t i = 0; i < N; i++) {
+      const std::uint8_t *limb_bytes = input + 8 * (N - 1 - i);
+      std::uint64_t limb = 0;
+      for (int b = 0; b < 8; b++) {
+        limb = (limb << 8) | limb_bytes[b];
+      }
+      result[i] = limb;
+    }
+    return result;
+  }
+
+  CryptoPP::Integer ToInteger() const {
+    std::uint8_t bytes[BYTES];
+    this->Encode(bytes);
+    return CryptoPP::Integer(bytes, BYTES);
+  }
+
+  /**
+   * Converts x; returns false if it is negative or does not fit in N limbs.
+   */
+  static bool FromInteger(const CryptoPP::Integer &x, FixedUInt *result) {
+    if (x.IsNegative() || x.ByteCount() > BYTES) {
+      return false;
+    }
+    std::uint8_t bytes[BYTES];
+    x.Encode(bytes, BYTES);
+    *result = Decode(bytes);
+    return true;
+  }
+};
+
+// Wide enough for any element of the election groups, and for their scalars.
+using UInt2048 = FixedUInt<32>;
+using UInt256 = FixedUInt<4>;
+
+/**
+ * Parses a hex constant, with or without a "0x" prefix. Fails to compile if
+ * the constant does not fit.
+ */
+template <std::size_t N>
+constexpr FixedUInt<N> ParseFixedUInt(const char *hex) {
+  std::size_t length = 0;
+  while (hex[length] != '\0') {
+    length++;
+  }
+  std::size_t start = 0;
+  if (length >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+    start = 2;
+  }
+
+  FixedUInt<N> result;
+  std::size_t bit = 0;
+  for (std::size_t i = length; i > start; i--, bit += 4) {
+    char c = hex[i - 1];
+    std::uint64_t digit = c >= 'a'   ? c - 'a' + 10
+                          : c >= 'A' ? c - 'A' + 10
+                                     : c - '0';
+    result[bit / 64] |= digit << (bit % 64);
+  }
+  return result;
+}
+
+/**
+ * Returns -1, 0 or 1 as x is below, equal to or above y.
+ */
+template <std::size_t N>
+constexpr int Compare(const FixedUInt<N> &x, const FixedUInt<N> &y) {
+  for (std::size_t i = N; i > 0; i--) {
+    if (x[i - 1] != y[i - 1]) {
+      return x[i - 1] < y[i - 1] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Returns -m^-1 mod 2^64 for odd m by Newton's iteration, which doubles the
+ * number of correct bits each step.
+ */
+constexpr std::uint64_t NegatedInverse(std::uint64_t m) {
+  std::uint64_t inverse = 1;
+  for (int i = 0; i < 6; i++) {
+    inverse *= 2 - m * inverse;
+  }
+  return 0 - inverse;
+}
+
+/**
+ * Subtracts modulus from x if x (with `carry` as an extra top bit) is at
+ * least modulus.
+ */
+template <std::size_t N>
+constexpr void ReduceOnce(FixedUInt<N> &x, std::uint64_t carry,
+                          const FixedUInt<N> &modulus) {
+  if (carry == 0 && Compare(x, modulus) < 0) {
+    return;
+  }
+  std::uint64_t borrow = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    std::uint64_t difference = x[i] - modulus[i] - borrow;
+    borrow = x[i] < modulus[i] || (x[i] == modulus[i] && borrow);
+    x[i] = difference;
+  }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FIXED_UINT_MULX 1
+
+/**
+ * Whether the CPU has MULX (BMI2) and ADCX/ADOX (ADX). Checked once.
+ */
+inline bool HasMulxAdx() {
+  static const bool supported =
+      __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+  return supported;
+}
+
+/**
+ * t[0, n) += a[0, n) * b, then t[n] += the carry out and carry_in. Returns
+ * the carry out of t[n]. n must be at least 1. MULX leaves the flags alone,
+ * so the low halves are summed on the carry flag (ADCX) and the high halves
+ * on the overflow flag (ADOX), as two independent chains.
+ */
+inline std::uint64_t MulAddRow(std::uint64_t *t, const std::uint64_t *a,
+                               std::uint64_t b, std::size_t n,
+                               std::uint64_t carry_in) {
+  std::uint64_t extra, low, high, current;
+  __asm__ volatile("movq (%[t]), %[current]\n\t"
+                   "xorl %k[low], %k[low]\n\t" // clears CF and OF
+                   "1:\n\t"
+                   "mulxq (%[a]), %[low], %[high]\n\t"
+                   "adcxq %[low], %[current]\n\t"
+                   "movq %[current], (%[t])\n\t"
+                   "movq 8(%[t]), %[current]\n\t"
+                   "adoxq %[high], %[current]\n\t"
+                   "leaq 8(%[a]), %[a]\n\t"
+                   "leaq 8(%[t]), %[t]\n\t"
+                   "leaq -1(%[n]), %[n]\n\t"
+                   "jrcxz 2f\n\t" // leaves the flags alone, unlike dec
+                   "jmp 1b\n\t"
+                   "2:\n\t"
+                   "adcxq %[carry], %[current]\n\t"
+                   "movq %[current], (%[t])\n\t"
+                   "movl $0, %k[extra]\n\t"
+                   "movl $0, %k[low]\n\t"
+                   "adcxq %[low], %[extra]\n\t"
+                   "adoxq %[low], %[extra]\n\t"
+                   : [t] "+r"(t), [a] "+r"(a), [n] "+c"(n),
+                     [extra] "=&r"(extra), [low] "=&r"(low),
+                     [high] "=&r"(high), [current] "=&r"(current)
+                   : "d"(b), [carry] "r"(carry_in)
+                   : "cc", "memory");
+  return extra;
+}
+
+/**
+ * Montgomery-reduces the 2N-limb t in place and returns t * 2^(-64N) mod
+ * modulus, one MulAddRow per limb.
+ */
+template <std::size_t N>
+FixedUInt<N> MontgomeryReduceMulx(std::uint64_t *t, const FixedUInt<N> &modulus,
+                                  std::uint64_t inverse) {
+  std::uint64_t extra = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    extra = MulAddRow(t + i, modulus.limbs, t[i] * inverse, N, extra);
+  }
+  FixedUInt<N> result;
+  for (std::size_t i = 0; i < N; i++) {
+    result[i] = t[N + i];
+  }
+  ReduceOnce(result, extra, modulus);
+  return result;
+}
+
+/**
+ * MontgomeryMultiply as separate operand scanning: the full product, then
+ * the reduction.
+ */
+template <std::size_t N>
+FixedUInt<N> MontgomeryMultiplyMulx(const FixedUInt<N> &a,
+                                    const FixedUInt<N> &b,
+                                    const FixedUInt<N> &modulus,
+                                    std::uint64_t inverse) {
+  std::uint64_t t[2 * N + 1] = {};
+  for (std::size_t i = 0; i < N; i++) {
+    t[i + N + 1] += MulAddRow(t + i, a.limbs, b[i], N, 0);
+  }
+  return MontgomeryReduceMulx(t, modulus, inverse);
+}
+
+/**
+ * MontgomeryMultiply(a, a) with each cross product a[i] * a[j] computed
+ * once and doubled.
+ */
+template <std::size_t N>
+FixedUInt<N> MontgomerySquareMulx(const FixedUInt<N> &a,
+                                  const FixedUInt<N> &modulus,
+                                  std::uint64_t inverse) {
+  using Wide = unsigned __int128;
+  std::uint64_t t[2 * N + 1] = {};
+  for (std::size_t i = 0; i + 1 < N; i++) {
+    t[i + N + 1] += MulAddRow(t + 2 * i + 1, a.limbs + i + 1, a[i], N - i - 1, 0);
+  }
+
+  std::uint64_t carry = 0;
+  for (std::size_t i = 0; i < 2 * N; i++) {
+    std::uint64_t next = t[i] >> 63;
+    t[i] = (t[i] << 1) | carry;
+    carry = next;
+  }
+
+  Wide sum = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    Wide square = Wide(a[i]) * a[i];
+    sum += Wide(t[2 * i]) + std::uint64_t(square);
+    t[2 * i] = std::uint64_t(sum);
+    sum >>= 64;
+    sum += Wide(t[2 * i + 1]) + std::uint64_t(square >> 64);
+    t[2 * i + 1] = std::uint64_t(sum);
+    sum >>= 64;
+  }
+  return MontgomeryReduceMulx(t, modulus, inverse);
+}
+#endif
+
+/**
+ * Returns a * b * 2^(-64N) mod modulus for a, b < modulus, where inverse is
+ * -modulus^-1 mod 2^64. Uses MULX/ADX at runtime when the CPU has them, and
+ * otherwise (and at compile time) coarsely integrated operand scanning with
+ * constant trip counts.
+ */
+template <std::size_t N>
+constexpr FixedUInt<N> MontgomeryMultiply(const FixedUInt<N> &a,
+                                          const FixedUInt<N> &b,
+                                          const FixedUInt<N> &modulus,
+                                          std::uint64_t inverse) {
+#ifdef FIXED_UINT_MULX
+  if (!std::is_constant_evaluated() && HasMulxAdx()) {
+    return MontgomeryMultiplyMulx(a, b, modulus, inverse);
+  }
+#endif
+
+  using Wide = unsigned __int128;
+  std::uint64_t t[N + 2] = {};
+  for (std::size_t i = 0; i < N; i++) {
+    // t += a * b[i]
+    std::uint64_t carry = 0;
+    for (std::size_t j = 0; j < N; j++) {
+      Wide sum = Wide(a[j]) * b[i] + t[j] + carry;
+      t[j] = std::uint64_t(sum);
+      carry = std::uint64_t(sum >> 64);
+    }
+    Wide top = Wide(t[N]) + carry;
+    t[N] = std::uint64_t(top);
+    t[N + 1] = std::uint64_t(top >> 64);
+
+    // t = (t + m * modulus) / 2^64, with m chosen to clear the low limb
+    std::uint64_t m = t[0] * inverse;
+    Wide sum = Wide(m) * modulus[0] + t[0];
+    carry = std::uint64_t(sum >> 64);
+    for (std::size_t j = 1; j < N; j++) {
+      sum = Wide(m) * modulus[j] + t[j] + carry;
+      t[j - 1] = std::uint64_t(sum);
+      carry = std::uint64_t(sum >> 64);
+    }
+    top = Wide(t[N]) + carry;
+    t[N - 1] = std::uint64_t(top);
+    t[N] = t[N + 1] + std::uint64_t(top >> 64);
+  }
+
+  FixedUInt<N> result;
+  for (std::size_t i = 0; i < N; i++) {
+    result[i] = t[i];
+  }
+  ReduceOnce(result, t[N], modulus);
+  return result;
+}
+
+/**
+ * Returns a * a * 2^(-64N) mod modulus; cheaper than MontgomeryMultiply
+ * on the MULX/ADX path.
+ */
+template <std::size_t N>
+constexpr FixedUInt<N> MontgomerySquare(const FixedUInt<N> &a,
+                                        const FixedUInt<N> &modulus,
+                                        std::uint64_t inverse) {
+#ifdef FIXED_UINT_MULX
+  if (!std::is_constant_evaluated() && HasMulxAdx()) {
+    return MontgomerySquareMulx(a, modulus, inverse);
+  }
+#endif
+  return MontgomeryMultiply(a, a, modulus, inverse);
+}
+
+/**
+ * Returns 2^(64N) mod modulus, for a modulus with its top bit set, so that
+ * 2^(64N) - modulus is already reduced.
+ */
+template <std::size_t N>
+constexpr FixedUInt<N> MontgomeryRadix(const FixedUInt<N> &modulus) {
+  FixedUInt<N> result;
+  std::uint64_t borrow = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    result[i] = 0 - modulus[i] - borrow;
+    borrow = modulus[i] != 0 || borrow;
+  }
+  return result;
+}
+
+/**
+ * Returns 2^(128N) mod modulus: the Montgomery form of 2 is squared until it
+ * is the Montgomery form of 2^(64N). Needs 64N to be a power of two.
+ */
+template <std::size_t N>
+constexpr FixedUInt<N> MontgomeryRadixSquared(const FixedUInt<N> &modulus,
+                                              std::uint64_t inverse) {
+  // two = 2 * R mod modulus
+  FixedUInt<N> two = MontgomeryRadix(modulus);
+  std::uint64_t carry = 0;
+  for (std::size_t i = 0; i < N; i++) {
+    std::uint64_t next = two[i] >> 63;
+    two[i] = (two[i] << 1) | carry;
+    carry = next;
+  }
+  ReduceOnce(two, carry, modulus);
+
+  // 2^(2^s) for s = 1, 2, ... until 2^s = 64N
+  for (std::size_t bits = 1; bits < 64 * N; bits *= 2) {
+    two = MontgomeryMultiply(two, two, modulus, inverse);
+  }
+  return two;
+}
@@ -34,5 +34,5 @@ void LoadPRGSeed(const std::string &filename, CryptoPP::SecByteBlock &seed);
 void SaveInteger(const std::string &filename, const CryptoPP::Integer &i);
 void LoadInteger(const std::string &filename, CryptoPP::Integer *i);
 
-void LoadElectionPublicKey(const std::vector<std::string> &filenames,
-                           CryptoPP::Integer *public_key);
+void LoadElectionPublicKeys(const std::vector<std::string> &filenames,
+                            std::vector<CryptoPP::Integer> *public_keys);
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <iostream>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <boost/chrono.hpp>
@@ -14,6 +16,8 @@
 #include <crypto++/integer.h>
 #include <crypto++/nbtheory.h>
 
+#include "../include-shared/fixed_uint.hpp"
+
 // ================================================
 // MESSAGE TYPES
 // ================================================
@@ -37,33 +41,74 @@ enum T {
   Votes_Struct = 15,
   VoteZKPs_Struct = 16,
   PartialDecryptions_Struct = 17,
-  DecryptionZKPs_Struct = 18
+  DecryptionZKPs_Struct = 18,
+  TallyerToWorld_Aggregate_Message = 19
 };
 };
-MessageType::T get_message_type(std::vector<unsigned char> &data);
+
+// Format versions. Version 1 writes integers as decimal strings and sizes
+// as native size_t; version 2 writes group elements as their big-endian
+// bytes, scalars as a fixed 32 bytes and sizes as varints. Version 3 is
+// version 2 with compact proofs: challenges and responses only, the
+// commitments being recomputed by the verifier. The version is in the top
+// two bits of a message's leading type byte.
+const int MESSAGE_FORMAT_VERSION = 3;
+const unsigned char MESSAGE_V2 = 0x80;
+const unsigned char MESSAGE_V3 = 0xC0;
+
+MessageType::T get_message_type(std::span<const unsigned char> data);
+int get_message_version(std::span<const unsigned char> data);
 
 // ================================================
 // SERIALIZABLE
 // ================================================
 
 struct Serializable {
-  virtual void serialize(std::vector<unsigned char> &data) = 0;
-  virtual int deserialize(std::vector<unsigned char> &data) = 0;
+  // Version to serialize in: the one this was deserialized from, so a
+  // signed message re-serializes to the bytes that were signed
+  int format_version = MESSAGE_FORMAT_VERSION;
+
+  virtual void serialize(std::vector<unsigned char> &data) const = 0;
+  virtual int deserialize(std::span<const unsigned char> data) = 0;
+  // Exact number of bytes serialize appends
+  virtual size_t serialized_size() const = 0;
 };
 
 // serializers.
+int put_message_type(MessageType::T type, int version,
+                     std::vector<unsigned char> &data);
 int put_bool(bool b, std::vector<unsigned char> &data);
-int put_string(std::string s, std::vector<unsigned char> &data);
-int put_integer(CryptoPP::Integer i, std::vector<unsigned char> &data);
-
-// serializing helper
-void add_size_param(std::vector<unsigned char> &data, size_t &size_param);
+int put_size(size_t n, std::vector<unsigned char> &data, int version);
+int put_string(std::string_view s, std::vector<unsigned char> &data,
+               int version);
+int put_integer(const CryptoPP::Integer &i, std::vector<unsigned char> &data,
+                int version);
+int put_integer(const UInt2048 &i, std::vector<unsigned char> &data,
+                int version);
+int put_integer(const UInt256 &i, std::vector<unsigned char> &data,
+                int version);
+
+// sizers
+size_t size_of_size(size_t n, int version);
+size_t size_of_string(size_t length, int version);
+size_t size_of_integer(const CryptoPP::Integer &i, int version);
+size_t size_of_integer(const UInt2048 &i, int version);
+size_t size_of_integer(const UInt256 &i, int version);
+void reserve_serialized(const Serializable &s,
+                        std::vector<unsigned char> &data);
 
 // deserializers
-int get_bool(bool *b, std::vector<unsigned char> &data, int idx);
-int get_string(std::string *s, std::vector<unsigned char> &data, int idx);
-int get_integer(CryptoPP::Integer *i, std::vector<unsigned char> &data,
-                int idx);
+int get_bool(bool *b, std::span<const unsigned char> data, int idx);
+int get_size(size_t *n, std::span<const unsigned char> data, int idx,
+             int version);
+int get_string(std::string *s, std::span<const unsigned char> data, int idx,
+               int version);
+int get_integer(CryptoPP::Integer *i, std::span<const unsigned char> data,
+                int idx, int version);
+int get_integer(UInt2048 *i, std::span<const unsigned char> data, int idx,
+                int version);
+int get_integer(UInt256 *i, std::span<const unsigned char> data, int idx,
+                int version);
 
 // ================================================
 // WRAPPERS
@@ -74,8 +119,9 @@ struct HMACTagged_Wrapper : public Serializable {
   CryptoPP::SecByteBlock iv;
   std::string mac;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 // ================================================
@@ -85,8 +131,9 @@ struct HMACTagged_Wrapper : public Serializable {
 struct UserToServer_DHPublicValue_Message : public Serializable {
   CryptoPP::SecByteBlock public_value;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct ServerToUser_DHPublicValue_Message : public Serializable {
@@ -94,8 +141,9 @@ struct ServerToUser_DHPublicValue_Message : public Serializable {
   CryptoPP::SecByteBlock user_public_value;
   std::string server_signature; // computed on server_value + user_value
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 // ================================================
@@ -106,8 +154,9 @@ struct VoterToRegistrar_Register_Message : public Serializable {
   std::string id;
   CryptoPP::DSA::PublicKey user_verification_key;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct RegistrarToVoter_Certificate_Message : public Serializable {
@@ -115,8 +164,9 @@ struct RegistrarToVoter_Certificate_Message : public Serializable {
   CryptoPP::DSA::PublicKey verification_key;
   std::string registrar_signature; // computed on id + verification_key
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 // ================================================
@@ -125,83 +175,107 @@ struct RegistrarToVoter_Certificate_Message : public Serializable {
 
 // Struct for a vote (a, b) = (g^r, pk^r * g^v)
 struct Vote_Struct : public Serializable {
-  CryptoPP::Integer a;
-  CryptoPP::Integer b;
+  UInt2048 a;
+  UInt2048 b;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct Votes_Struct : public Serializable {
   std::vector<Vote_Struct> votes;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 // Struct for a dcp zkp of vote (a, b):
 // (aβ, bβ, cβ, rβ) = (g^r, pk^r, cβ, r''β)
+// From version 3 only cβ and rβ are serialized.
 struct VoteZKP_Struct : public Serializable {
-  CryptoPP::Integer a0;
-  CryptoPP::Integer a1;
-  CryptoPP::Integer b0;
-  CryptoPP::Integer b1;
-  CryptoPP::Integer c0;
-  CryptoPP::Integer c1;
-  CryptoPP::Integer r0;
-  CryptoPP::Integer r1;
-
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  UInt2048 a0;
+  UInt2048 a1;
+  UInt2048 b0;
+  UInt2048 b1;
+  UInt256 c0;
+  UInt256 c1;
+  UInt256 r0;
+  UInt256 r1;
+
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct VoteZKPs_Struct : public Serializable {
   std::vector<VoteZKP_Struct> zkps;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
+// From version 3 only c_i and r_i are serialized.
 struct Count_ZKP_Struct : public Serializable {
-  CryptoPP::Integer a_i;
-  CryptoPP::Integer b_i;
-  CryptoPP::Integer c_i;
-  CryptoPP::Integer r_i;
-
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  UInt2048 a_i;
+  UInt2048 b_i;
+  UInt256 c_i;
+  UInt256 r_i;
+
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct Count_ZKPs_Struct : public Serializable {
   std::vector<Count_ZKP_Struct> count_zkps;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct VoterToTallyer_Vote_Message : public Serializable {
   RegistrarToVoter_Certificate_Message cert;
   Votes_Struct votes;
   VoteZKPs_Struct zkps;
-
-  Vote_Struct vote_count;
   Count_ZKPs_Struct count_zkps;
-  std::string voter_signature; // computed on votes, zkps, vote_count, and count_zkps
+  std::string voter_signature; // computed on votes, zkps, vote count, and count_zkps
+
+  // Set by deserialize: the votes, zkps and count zkps exactly as read,
+  // views into the bytes it was given and only valid while they are
+  std::span<const unsigned char> votes_data;
+  std::span<const unsigned char> zkps_data;
+  std::span<const unsigned char> count_zkps_data;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct TallyerToWorld_Vote_Message : public Serializable {
   Votes_Struct votes;
   VoteZKPs_Struct zkps;
-
-  Vote_Struct vote_count;
   Count_ZKPs_Struct count_zkps;
-  std::string tallyer_signature; // computed on votes, zkps, vote_count, and count_zkps
+  std::string tallyer_signature; // computed on votes, zkps, vote count, and count_zkps
+
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
+};
+
+// Running product of every ballot the tallyer has accepted
+struct TallyerToWorld_Aggregate_Message : public Serializable {
+  Votes_Struct votes; // per-candidate product of the accepted ballots
+  CryptoPP::Integer ballot_count;
+  CryptoPP::Integer last_row_id; // vote table rowid of the last ballot folded in
+  std::string tallyer_signature; // computed on votes, ballot_count, and last_row_id
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 // ================================================
@@ -210,35 +284,41 @@ struct TallyerToWorld_Vote_Message : public Serializable {
 
 // Struct for a pd of `aggregate_ciphertext` (d) = (g^{r sk_i})
 struct PartialDecryption_Struct : public Serializable {
-  CryptoPP::Integer d;
+  UInt2048 d;
   Vote_Struct aggregate_ciphertext;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct PartialDecryptions_Struct : public Serializable {
   std::vector<PartialDecryption_Struct> decs;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 // Struct for a pd zkp of vote (a, b): (u, v, s) = (g^r, a^r, s)
+// From version 3 only sigma and s are serialized.
 struct DecryptionZKP_Struct : public Serializable {
-  CryptoPP::Integer u;
-  CryptoPP::Integer v;
-  CryptoPP::Integer s;
-
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  UInt2048 u;
+  UInt2048 v;
+  UInt256 s;
+  UInt256 sigma; // the challenge; recomputed from u and v before version 3
+
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct DecryptionZKPs_Struct : public Serializable {
   std::vector<DecryptionZKP_Struct> zkps;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 struct ArbiterToWorld_PartialDecryption_Message : public Serializable {
@@ -247,8 +327,9 @@ struct ArbiterToWorld_PartialDecryption_Message : public Serializable {
   PartialDecryptions_Struct decs;
   DecryptionZKPs_Struct zkps;
 
-  void serialize(std::vector<unsigned char> &data);
-  int deserialize(std::vector<unsigned char> &data);
+  void serialize(std::vector<unsigned char> &data) const;
+  int deserialize(std::span<const unsigned char> data);
+  size_t serialized_size() const;
 };
 
 
@@ -257,13 +338,18 @@ struct ArbiterToWorld_PartialDecryption_Message : public Serializable {
 // ================================================
 
 std::vector<unsigned char>
-concat_string_and_dsakey(std::string &s, CryptoPP::DSA::PublicKey &k);
-std::vector<unsigned char> concat_byteblocks(CryptoPP::SecByteBlock &b1,
-                                             CryptoPP::SecByteBlock &b2);
+concat_string_and_dsakey(const std::string &s,
+                         const CryptoPP::DSA::PublicKey &k);
+std::vector<unsigned char> concat_byteblocks(const CryptoPP::SecByteBlock &b1,
+                                             const CryptoPP::SecByteBlock &b2);
+std::vector<unsigned char>
+concat_byteblock_and_cert(const CryptoPP::SecByteBlock &b,
+                          const RegistrarToVoter_Certificate_Message &cert);
+std::vector<unsigned char>
+concat_votes_and_zkps(const Votes_Struct &votes, const VoteZKPs_Struct &zkps,
+                      const Vote_Struct &vote_count,
+                      const Count_ZKPs_Struct &count_zkps);
 std::vector<unsigned char>
-concat_byteblock_and_cert(CryptoPP::SecByteBlock &b,
-                          RegistrarToVoter_Certificate_Message &cert);
-std::vector<unsigned char> concat_votes_and_zkps(Votes_Struct &votes,
-                                               VoteZKPs_Struct &zkps,
-                                               Vote_Struct &vote_count,
-                                               Count_ZKPs_Struct &count_zkps);
+concat_votes_and_count(const Votes_Struct &votes,
+                       const CryptoPP::Integer &count,
+                       const CryptoPP::Integer &last_row_id);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+#include <crypto++/aes.h>
+#include <crypto++/cryptlib.h>
+#include <crypto++/modes.h>
+#include <crypto++/secblock.h>
+
+/**
+ * AES-256 in counter mode as a random bit generator. Keyed from the OS and
+ * rekeyed from its own keystream after every request, so a later compromise
+ * of the state does not reveal earlier output. Reseeds from the OS every
+ * RESEED_INTERVAL bytes. Not thread safe; use ThreadRNG().
+ */
+class SecureRNG : public CryptoPP::RandomNumberGenerator {
+public:
+  SecureRNG();
+
+  void GenerateBlock(CryptoPP::byte *output, size_t size) override;
+  std::string AlgorithmName() const override;
+
+  static const size_t RESEED_INTERVAL = 1 << 20;
+
+private:
+  void Reseed();
+  void Rekey(const CryptoPP::byte *seed);
+
+  CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption cipher;
+  size_t bytes_since_reseed;
+  unsigned long seed_epoch; // deterministic seed this state was derived from
+  unsigned long stream;     // order of creation, mixed into deterministic seeds
+};
+
+// This thread's generator.
+CryptoPP::RandomNumberGenerator &ThreadRNG();
+
+// Test hooks: make every thread's generator a deterministic function of seed
+// and the order the generators were created in.
+void SetDeterministicRNGSeed(const std::string &seed);
+void ClearDeterministicRNGSeed();
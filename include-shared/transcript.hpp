@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <crypto++/integer.h>
+#include <crypto++/sha.h>
+
+#include "../include-shared/fixed_uint.hpp"
+
+// Version of the transcript encoding, absorbed ahead of everything else.
+// Proofs made before transcripts existed hash decimal strings instead
+// (hash_vote_zkp and friends in util.hpp) and count as version 1.
+const std::uint8_t TRANSCRIPT_VERSION = 2;
+
+/**
+ * A Fiat-Shamir transcript: an incremental SHA-256 over a domain separator
+ * and then the proof's public values, each in a fixed-width big-endian
+ * encoding, so nothing is converted to decimal or reparsed. The domain
+ * separator holds the version, the kind of proof and the group, so a
+ * challenge for one can never be replayed as another.
+ */
+class Transcript {
+public:
+  Transcript(const std::string &proof, const std::string &group);
+
+  void Absorb(const UInt2048 &x);
+  void Absorb(const UInt256 &x);
+  void Absorb(const CryptoPP::Integer &x);
+
+  // The digest as a scalar mod order; order must fill its top limb.
+  UInt256 Challenge(const UInt256 &order);
+
+private:
+  void AbsorbLength(std::uint32_t length);
+
+  CryptoPP::SHA256 hash;
+};
@@ -14,39 +14,39 @@
 #include <crypto++/sha.h>
 
 // String <=> Vec<char>.
-std::string chvec2str(std::vector<unsigned char> data);
-std::vector<unsigned char> str2chvec(std::string s);
+std::string chvec2str(const std::vector<unsigned char> &data);
+std::vector<unsigned char> str2chvec(const std::string &s);
 
 // String <=> Hex.
-std::string hex_encode(std::string s);
-std::string hex_decode(std::string s);
+std::string hex_encode(const std::string &s);
+std::string hex_decode(const std::string &s);
 
 // SecByteBlock <=> Integer.
-CryptoPP::Integer byteblock_to_integer(CryptoPP::SecByteBlock block);
-CryptoPP::SecByteBlock integer_to_byteblock(CryptoPP::Integer x);
+CryptoPP::Integer byteblock_to_integer(const CryptoPP::SecByteBlock &block);
+CryptoPP::SecByteBlock integer_to_byteblock(const CryptoPP::Integer &x);
 
 // SecByteBlock <=> string.
 std::string byteblock_to_string(const CryptoPP::SecByteBlock &block);
 CryptoPP::SecByteBlock string_to_byteblock(const std::string &s);
 
 // Printers.
-void print_string_as_hex(std::string str);
-void print_key_as_int(CryptoPP::SecByteBlock block);
-void print_key_as_hex(CryptoPP::SecByteBlock block);
+void print_string_as_hex(const std::string &str);
+void print_key_as_int(const CryptoPP::SecByteBlock &block);
+void print_key_as_hex(const CryptoPP::SecByteBlock &block);
 
 // Splitter.
-std::vector<std::string> string_split(std::string str, char delimiter);
+std::vector<std::string> string_split(const std::string &str, char delimiter);
 
-// Hasher.
-CryptoPP::Integer hash_vote_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
-                                CryptoPP::Integer b, CryptoPP::Integer a0_p,
-                                CryptoPP::Integer b0_p, CryptoPP::Integer a1_p,
-                                CryptoPP::Integer b1_p);
+// Hashers of proofs made before transcript.hpp, kept to verify them.
+CryptoPP::Integer hash_vote_zkp(const CryptoPP::Integer &pk, const CryptoPP::Integer &a,
+                                const CryptoPP::Integer &b, const CryptoPP::Integer &a0_p,
+                                const CryptoPP::Integer &b0_p, const CryptoPP::Integer &a1_p,
+                                const CryptoPP::Integer &b1_p);
 
-CryptoPP::Integer hash_count_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
-                                CryptoPP::Integer b, std::vector<CryptoPP::Integer> a_vec,
-                                std::vector<CryptoPP::Integer> b_vec);
+CryptoPP::Integer hash_count_zkp(const CryptoPP::Integer &pk, const CryptoPP::Integer &a,
+                                const CryptoPP::Integer &b, const std::vector<CryptoPP::Integer> &a_vec,
+                                const std::vector<CryptoPP::Integer> &b_vec);
 
-CryptoPP::Integer hash_dec_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
-                               CryptoPP::Integer b, CryptoPP::Integer u,
-                               CryptoPP::Integer v);
+CryptoPP::Integer hash_dec_zkp(const CryptoPP::Integer &pk, const CryptoPP::Integer &a,
+                               const CryptoPP::Integer &b, const CryptoPP::Integer &u,
+                               const CryptoPP::Integer &v);
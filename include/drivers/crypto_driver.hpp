@@ -4,7 +4,9 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <span>
 #include <string>
+#include <string_view>
 
 #include <crypto++/cryptlib.h>
 #include <crypto++/dh.h>
@@ -24,17 +26,18 @@
 #include <crypto++/sha.h>
 
 #include "../../include-shared/messages.hpp"
+#include "../../include/pkg/election_math.hpp"
 
 using namespace CryptoPP;
 
 class CryptoDriver {
 public:
-  std::vector<unsigned char> encrypt_and_tag(SecByteBlock AES_key,
-                                             SecByteBlock HMAC_key,
+  std::vector<unsigned char> encrypt_and_tag(const SecByteBlock &AES_key,
+                                             const SecByteBlock &HMAC_key,
                                              Serializable *message);
   std::pair<std::vector<unsigned char>, bool>
-  decrypt_and_verify(SecByteBlock AES_key, SecByteBlock HMAC_key,
-                     std::vector<unsigned char> ciphertext_data);
+  decrypt_and_verify(const SecByteBlock &AES_key, const SecByteBlock &HMAC_key,
+                     const std::vector<unsigned char> &ciphertext_data);
 
   std::tuple<DH, SecByteBlock, SecByteBlock> DH_initialize();
   SecByteBlock
@@ -42,22 +45,26 @@ public:
                          const SecByteBlock &DH_other_public_value);
 
   SecByteBlock AES_generate_key(const SecByteBlock &DH_shared_key);
-  std::pair<std::string, SecByteBlock> AES_encrypt(SecByteBlock key,
-                                                   std::string plaintext);
-  std::string AES_decrypt(SecByteBlock key, SecByteBlock iv,
-                          std::string ciphertext);
+  std::pair<std::string, SecByteBlock> AES_encrypt(const SecByteBlock &key,
+                                                   const std::string &plaintext);
+  std::string AES_decrypt(const SecByteBlock &key, const SecByteBlock &iv,
+                          const std::string &ciphertext);
 
   SecByteBlock HMAC_generate_key(const SecByteBlock &DH_shared_key);
-  std::string HMAC_generate(SecByteBlock key, std::string ciphertext);
-  bool HMAC_verify(SecByteBlock key, std::string ciphertext, std::string hmac);
+  std::string HMAC_generate(const SecByteBlock &key,
+                            const std::string &ciphertext);
+  bool HMAC_verify(const SecByteBlock &key, const std::string &ciphertext,
+                   const std::string &hmac);
 
   std::pair<DSA::PrivateKey, DSA::PublicKey> DSA_generate_keys();
   std::string DSA_sign(const DSA::PrivateKey &DSA_signing_key,
-                       std::vector<unsigned char> message);
+                       std::span<const unsigned char> message);
   bool DSA_verify(const DSA::PublicKey &verification_key,
-                  std::vector<unsigned char> message, std::string signature);
+                  std::span<const unsigned char> message,
+                  std::string_view signature);
 
-  std::pair<CryptoPP::Integer, CryptoPP::Integer> EG_generate();
+  std::pair<CryptoPP::Integer, CryptoPP::Integer>
+  EG_generate(const GroupContext &group);
 
-  std::string hash(std::string msg);
+  std::string hash(const std::string &msg);
 };
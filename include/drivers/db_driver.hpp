@@ -4,35 +4,43 @@
 #include <sqlite3.h>
 #include <string>
 
+#include "../../include-shared/ballot_batch.hpp"
 #include "../../include-shared/messages.hpp"
 
 typedef RegistrarToVoter_Certificate_Message VoterRow;
 typedef TallyerToWorld_Vote_Message VoteRow;
 typedef ArbiterToWorld_PartialDecryption_Message PartialDecryptionRow;
+typedef TallyerToWorld_Aggregate_Message AggregateRow;
 
 class DBDriver {
 public:
   DBDriver();
-  int open(std::string dbpath);
+  int open(const std::string &dbpath);
   int close();
 
   void init_tables();
   void reset_tables();
 
-  VoterRow find_voter(std::string id);
-  VoterRow insert_voter(VoterRow voter);
+  VoterRow find_voter(const std::string &id);
+  void insert_voter(const VoterRow &voter);
 
   std::vector<VoteRow> all_votes();
-  VoteRow find_vote(Vote_Struct vote);
-  VoteRow insert_vote(VoteRow vote);
+  void all_votes(BallotBatch &batch);
+  VoteRow find_vote(const Vote_Struct &vote);
+  void insert_vote(const VoteRow &vote);
+
+  AggregateRow find_aggregate(CryptoPP::Integer *last_vote_row_id = nullptr);
+  void insert_aggregate(const AggregateRow &aggregate);
+  bool insert_vote_and_aggregate(const std::string &voter_id,
+                                 const BallotView &vote,
+                                 const AggregateRow &aggregate);
 
   std::vector<PartialDecryptionRow> all_partial_decryptions();
-  PartialDecryptionRow find_partial_decryption(std::string arbiter_id);
-  PartialDecryptionRow
-  insert_partial_decryption(PartialDecryptionRow partial_decryption);
+  PartialDecryptionRow find_partial_decryption(const std::string &arbiter_id);
+  void insert_partial_decryption(const PartialDecryptionRow &partial_decryption);
 
-  bool voter_voted(std::string id);
-  std::string insert_voted(std::string id);
+  bool voter_voted(const std::string &id);
+  void insert_voted(const std::string &id);
 
 private:
   std::mutex mtx;
@@ -13,6 +13,7 @@
 #include "../../include/drivers/cli_driver.hpp"
 #include "../../include/drivers/crypto_driver.hpp"
 #include "../../include/drivers/db_driver.hpp"
+#include "../../include/pkg/election_math.hpp"
 
 class ArbiterClient {
 public:
@@ -26,12 +27,14 @@ private:
   CommonConfig common_config;
   int num_candidates;
   int k;
+  const GroupContext *group; // The election group named in the config
   std::shared_ptr<CLIDriver> cli_driver;
   std::shared_ptr<CryptoDriver> crypto_driver;
   std::shared_ptr<DBDriver> db_driver;
 
   CryptoPP::Integer EG_arbiter_secret_key; // Our EG secret key
   CryptoPP::Integer EG_arbiter_public_key; // The election's EG public key
+  std::shared_ptr<FixedBaseTable> EG_arbiter_public_key_table; // Its fixed-base table
   CryptoPP::Integer EG_arbiter_public_key_i; // Our EG public key
   CryptoPP::DSA::PublicKey DSA_registrar_verification_key;
   CryptoPP::DSA::PublicKey DSA_tallyer_verification_key;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../../include/pkg/election.hpp"
+#include "../../include/pkg/election_math.hpp"
+
+/**
+ * Ballot precomputations prepared on a background thread. The thread keeps
+ * `size` ballots ready for the election key, so casting a vote only has to
+ * finish one with multiplications and hashing.
+ */
+class BallotPool {
+public:
+  BallotPool(const GroupContext &group, std::shared_ptr<FixedBaseTable> pk,
+             int num_candidates, int k, int size = 2);
+  ~BallotPool();
+
+  PrecomputedBallot Take();
+
+private:
+  void Fill();
+
+  const GroupContext &group;
+  std::shared_ptr<FixedBaseTable> pk;
+  int num_candidates;
+  int k;
+  int size;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<PrecomputedBallot> ballots;
+  bool stopping;
+  std::thread worker;
+};
@@ -8,42 +8,119 @@
 #include <crypto++/nbtheory.h>
 #include <crypto++/osrng.h>
 
+#include "../../include-shared/ballot_batch.hpp"
 #include "../../include-shared/config.hpp"
 #include "../../include-shared/constants.hpp"
 #include "../../include-shared/messages.hpp"
+#include "../../include-shared/transcript.hpp"
 #include "../../include-shared/util.hpp"
 #include "../../include/drivers/cli_driver.hpp"
 #include "../../include/drivers/db_driver.hpp"
+#include "../../include/pkg/election_math.hpp"
+
+// Nonce of a real proof branch and its commitments
+struct ProofCommitment {
+  Scalar w;
+  GroupElement g_w;  // g^w
+  GroupElement pk_w; // pk^w
+};
+
+// A simulated proof branch, sampled before the ciphertext is known
+struct ProofSimulation {
+  Scalar c; // challenge
+  Scalar t; // response minus r * c
+  GroupElement g_t;
+  GroupElement pk_t;
+  GroupElement g_c;     // g^c
+  GroupElement g_neg_c; // g^-c
+};
+
+// Everything about one candidate's vote that does not depend on the vote
+struct PrecomputedVote {
+  Scalar r;          // encryption randomness
+  GroupElement a;    // g^r
+  GroupElement pk_r; // pk^r
+  ProofCommitment real;
+  ProofSimulation simulated;
+};
+
+// A ballot's worth of precomputation for one election key
+struct PrecomputedBallot {
+  CryptoPP::Integer pk;
+  std::vector<PrecomputedVote> votes;
+  ProofCommitment count_real;
+  std::vector<ProofSimulation> count_simulated; // one per count 0..k
+};
+
+// Ballot ciphertexts by candidate: a[i * num_ballots + j] is the a of
+// candidate i on ballot j, so each candidate's column is contiguous
+struct VoteColumns {
+  int num_candidates = 0;
+  size_t num_ballots = 0;
+  std::vector<GroupElement> a;
+  std::vector<GroupElement> b;
+};
 
 class ElectionClient {
 public:
-  static std::tuple<Vote_Struct, VoteZKP_Struct, CryptoPP::Integer>
-  GenerateVote(CryptoPP::Integer vote, CryptoPP::Integer pk);
-  static std::tuple<Votes_Struct, VoteZKPs_Struct, CryptoPP::Integer>
-  GenerateVotes(std::vector<CryptoPP::Integer> votes, CryptoPP::Integer pk);
+  static std::tuple<Vote_Struct, VoteZKP_Struct, Scalar>
+  GenerateVote(const GroupContext &group, const CryptoPP::Integer &vote, const FixedBaseTable &pk);
+  static std::tuple<Votes_Struct, VoteZKPs_Struct, Scalar>
+  GenerateVotes(const GroupContext &group, const std::vector<CryptoPP::Integer> &votes, const FixedBaseTable &pk);
+  static std::tuple<Votes_Struct, VoteZKPs_Struct, Scalar>
+  GenerateVotes(const GroupContext &group, const std::vector<CryptoPP::Integer> &votes, const FixedBaseTable &pk,
+                const PrecomputedBallot &pre);
 
-  static bool VerifyVoteZKP(std::pair<Vote_Struct, VoteZKP_Struct> vote, CryptoPP::Integer pk);
-  static bool VerifyVoteZKPs(std::pair<Votes_Struct, VoteZKPs_Struct> votes, CryptoPP::Integer pk);
+  static bool VerifyVoteZKP(const GroupContext &group, const Vote_Struct &vote, const VoteZKP_Struct &zkp,
+                            const FixedBaseTable &pk);
+  static bool VerifyVoteZKPs(const GroupContext &group, const Votes_Struct &votes, const VoteZKPs_Struct &zkps,
+                             const FixedBaseTable &pk);
 
   static std::pair<Vote_Struct, Count_ZKPs_Struct>
-  GenerateCountZKPs(std::vector<Vote_Struct> votes, int num_votes, int k, CryptoPP::Integer r, CryptoPP::Integer pk);
+  GenerateCountZKPs(const GroupContext &group, std::span<const Vote_Struct> votes, int num_votes, int k, const Scalar &r,
+                    const FixedBaseTable &pk);
+  static std::pair<Vote_Struct, Count_ZKPs_Struct>
+  GenerateCountZKPs(const GroupContext &group, std::span<const Vote_Struct> votes, int num_votes, int k, const Scalar &r,
+                    const FixedBaseTable &pk, const PrecomputedBallot &pre);
+
+  static PrecomputedBallot PrecomputeBallot(const GroupContext &group, int num_candidates, int k, const FixedBaseTable &pk);
+
+  static Vote_Struct CountVotes(const GroupContext &group, const Votes_Struct &votes);
+  static Vote_Struct CountVotes(const GroupContext &group, const BallotView &ballot);
+  static bool VerifyCountZKPs(const GroupContext &group, const Vote_Struct &vote_count,
+                              const Count_ZKPs_Struct &count_zkps, const FixedBaseTable &pk);
 
-  static bool VerifyCountZKPs(std::pair<Vote_Struct, Count_ZKPs_Struct> vote_count, CryptoPP::Integer pk);
+  static std::vector<bool>
+  BatchVerifyCiphertexts(const GroupContext &group,
+                         const std::vector<VoteRow> &ballots);
+  static std::vector<bool>
+  BatchVerifyBallots(const GroupContext &group,
+                     const std::vector<VoteRow> &ballots, int num_candidates,
+                     int k, const FixedBaseTable &pk);
+  static std::vector<bool>
+  BatchVerifyBallots(const GroupContext &group, const BallotBatch &ballots,
+                     int num_candidates, int k, const FixedBaseTable &pk);
 
   static std::pair<PartialDecryption_Struct, DecryptionZKP_Struct>
-  PartialDecrypt(Vote_Struct combined_vote, CryptoPP::Integer pk,
-                 CryptoPP::Integer sk);
+  PartialDecrypt(const GroupContext &group, const Vote_Struct &combined_vote, const CryptoPP::Integer &pk,
+                 const CryptoPP::Integer &sk);
   
   static std::pair<PartialDecryptions_Struct, DecryptionZKPs_Struct>
-  PartialDecryptions(Votes_Struct combined_votes, CryptoPP::Integer pk, CryptoPP::Integer sk);
+  PartialDecryptions(const GroupContext &group, const Votes_Struct &combined_votes, const CryptoPP::Integer &pk,
+                     const CryptoPP::Integer &sk);
 
   static bool
-  VerifyPartialDecryptZKPs(ArbiterToWorld_PartialDecryption_Message a2w_dec_s,
-                          CryptoPP::Integer pki);
+  VerifyPartialDecryptZKPs(const GroupContext &group, const ArbiterToWorld_PartialDecryption_Message &a2w_dec_s,
+                          const CryptoPP::Integer &pki);
 
-  static Votes_Struct CombineVotes(std::vector<VoteRow> all_votes, int num_candidates);
+  static Votes_Struct CombineVotes(const GroupContext &group, const std::vector<VoteRow> &all_votes, int num_candidates);
+  static Votes_Struct CombineVotes(const GroupContext &group, const BallotBatch &ballots,
+                                   const std::vector<int> &indices, int num_candidates);
+  static Votes_Struct CombineVotes(const GroupContext &group, const VoteColumns &columns);
+  static Votes_Struct FoldVotes(const GroupContext &group, Votes_Struct aggregate, const Votes_Struct &votes);
   
   static std::vector<CryptoPP::Integer>
-  CombineResults(Votes_Struct combined_vote,
-                 std::vector<PartialDecryptionRow> all_partial_decryptions);
+  CombineResults(const GroupContext &group, const Votes_Struct &combined_vote,
+                 const std::vector<PartialDecryptionRow> &all_partial_decryptions,
+                 const DiscreteLogTable &dlog);
 };
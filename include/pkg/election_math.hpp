@@ -0,0 +1,201 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <crypto++/cryptlib.h>
+#include <crypto++/integer.h>
+#include <crypto++/nbtheory.h>
+
+#include "../../include-shared/constants.hpp"
+#include "../../include-shared/fixed_uint.hpp"
+
+class GroupContext;
+
+// A group element as it is sent, and an exponent mod the group order.
+using GroupElement = UInt2048;
+using Scalar = UInt256;
+
+/**
+ * State a backend keeps for one of the helper classes below, such as a
+ * table of precomputed powers, in the backend's own element type.
+ */
+class GroupState {
+public:
+  virtual ~GroupState() {}
+};
+
+/**
+ * Precomputed powers of a fixed group element. The exponent is split into
+ * windows of `window_bits` bits and the table holds base^(d * 2^(w * i)) for
+ * every window i and nonzero digit d, so an exponentiation is one
+ * multiplication per window and no squarings.
+ */
+class FixedBaseTable {
+public:
+  FixedBaseTable(const GroupContext &group, CryptoPP::Integer base,
+                 int window_bits = 6);
+
+  GroupElement Exponentiate(const Scalar &exponent) const;
+  const CryptoPP::Integer &GetBase() const;
+
+private:
+  friend class GroupContext;
+  friend class MultiExponentiation;
+
+  const GroupContext &group;
+  CryptoPP::Integer base;
+  bool in_subgroup; // whether exponents may be added mod the group order
+  std::unique_ptr<GroupState> state; // the table, built by the group
+};
+
+/**
+ * A product of powers of group elements, evaluated in one pass. Terms over
+ * a FixedBaseTable are table lookups; the remaining bases share their
+ * squarings, interleaved (Straus) for a few bases and bucketed (Pippenger)
+ * for many. For a negative exponent, add the inverse of the base.
+ */
+class MultiExponentiation {
+public:
+  explicit MultiExponentiation(const GroupContext &group);
+
+  void Add(const FixedBaseTable &table, const Scalar &exponent);
+  void Add(const GroupElement &base, const Scalar &exponent);
+  GroupElement Evaluate() const;
+
+private:
+  const GroupContext &group;
+  std::vector<std::pair<const FixedBaseTable *, Scalar>> fixed_terms;
+  std::vector<GroupElement> bases;
+  std::vector<Scalar> exponents;
+};
+
+/**
+ * A prime-order group for the election, written multiplicatively. Elements
+ * are passed around as the fixed-width values they are sent as, and
+ * exponents as scalars; Integers are only taken for keys. Each backend is a
+ * template instantiated on compile-time group parameters (group_traits.hpp)
+ * and works in Montgomery form internally; the helper classes above and
+ * below call into it once per operation, so the group is picked at startup
+ * and not on every multiplication. Backends are immutable, so one context
+ * can be shared by every thread.
+ */
+class GroupContext {
+public:
+  virtual ~GroupContext() {}
+
+  virtual std::string Name() const = 0;
+  virtual const CryptoPP::Integer &Order() const = 0;
+  virtual const Scalar &ScalarOrder() const = 0; // the same, as a scalar
+  const FixedBaseTable &Generator() const;
+
+  // Whether x encodes an element, and whether a key has prime order.
+  virtual bool IsElement(const GroupElement &x) const = 0;
+  virtual bool IsSubgroupElement(const CryptoPP::Integer &x) const = 0;
+
+  virtual GroupElement Multiply(const GroupElement &x,
+                                const GroupElement &y) const = 0;
+  virtual GroupElement Divide(const GroupElement &x,
+                              const GroupElement &y) const = 0;
+  virtual GroupElement Inverse(const GroupElement &x) const = 0;
+  GroupElement Exponentiate(const GroupElement &base,
+                            const Scalar &exponent) const;
+
+  // Many unrelated powers, and many membership checks, evaluated together
+  // where the backend can.
+  virtual std::vector<GroupElement>
+  BatchExponentiate(const std::vector<GroupElement> &bases,
+                    const std::vector<Scalar> &exponents) const;
+  virtual std::vector<bool>
+  BatchIsSubgroupElement(const std::vector<GroupElement> &xs) const = 0;
+  // The product of many elements, such as one candidate's ciphertexts.
+  virtual GroupElement BatchMultiply(std::span<const GroupElement> xs) const;
+
+  // Arithmetic mod the order. Operands need not be reduced; results are.
+  virtual Scalar RandomScalar() const = 0; // uniform in [1, order)
+  virtual Scalar ReduceScalar(const CryptoPP::Integer &x) const = 0;
+  virtual Scalar ScalarAdd(const Scalar &x, const Scalar &y) const = 0;
+  virtual Scalar ScalarSubtract(const Scalar &x, const Scalar &y) const = 0;
+  virtual Scalar ScalarMultiply(const Scalar &x, const Scalar &y) const = 0;
+
+  // The election key from the arbiters' public keys.
+  virtual CryptoPP::Integer
+  CombinePublicKeys(const std::vector<CryptoPP::Integer> &keys) const;
+
+protected:
+  friend class FixedBaseTable;
+  friend class MultiExponentiation;
+  friend class GroupProduct;
+  friend class DiscreteLogTable;
+
+  using FixedTerms = std::vector<std::pair<const FixedBaseTable *, Scalar>>;
+
+  // FixedBaseTable
+  virtual std::unique_ptr<GroupState>
+  BuildFixedBase(const CryptoPP::Integer &base, int window_bits) const = 0;
+  virtual GroupElement FixedBaseExponentiate(const GroupState &table,
+                                             const Scalar &exponent) const = 0;
+  static const GroupState &TableState(const FixedBaseTable &table);
+
+  // MultiExponentiation
+  virtual GroupElement
+  EvaluateProduct(const FixedTerms &fixed_terms,
+                  const std::vector<GroupElement> &bases,
+                  const std::vector<Scalar> &exponents) const = 0;
+
+  // GroupProduct
+  virtual std::unique_ptr<GroupState> StartProduct() const = 0;
+  virtual void ProductStep(GroupState &product,
+                           const GroupElement &x) const = 0;
+  virtual GroupElement ProductValue(const GroupState &product) const = 0;
+
+  // DiscreteLogTable
+  virtual std::unique_ptr<GroupState> BuildDiscreteLog(long step) const = 0;
+  virtual bool SolveDiscreteLog(const GroupState &table, long step, long bound,
+                                const GroupElement &h, long *m) const = 0;
+
+  std::unique_ptr<FixedBaseTable> generator; // set by each backend
+};
+
+/**
+ * A running product of group elements. Backends may keep the product in a
+ * form that is cheaper to extend than their internal form; it is converted
+ * once when the value is read.
+ */
+class GroupProduct {
+public:
+  explicit GroupProduct(const GroupContext &group);
+
+  void Multiply(const GroupElement &x);
+  GroupElement Value() const;
+
+private:
+  const GroupContext &group;
+  std::unique_ptr<GroupState> state;
+};
+
+/**
+ * Baby-step giant-step solver for m = log_g(h) with 0 <= m <= bound. Holds
+ * the baby steps g^j for j < ceil(sqrt(bound + 1)), so a solve costs at most
+ * that many multiplications. Immutable once built; reuse one table for every
+ * candidate and across tallies while the bound still holds.
+ */
+class DiscreteLogTable {
+public:
+  DiscreteLogTable(const GroupContext &group, long bound);
+
+  bool Solve(const GroupElement &h, long *m) const;
+  long GetBound() const;
+
+private:
+  const GroupContext &group;
+  long bound;
+  long step;
+  std::unique_ptr<GroupState> state; // baby steps, built by the group
+};
+
+const GroupContext &DLGroup();
+const GroupContext &ECGroup();
+const GroupContext &ElectionGroup(const std::string &name);
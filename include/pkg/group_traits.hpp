@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../../include-shared/constants.hpp"
+#include "../../include-shared/fixed_uint.hpp"
+
+/**
+ * Compile-time parameters of the RFC 5114 group. The field constants are
+ * what election_math.cxx instantiates the Montgomery kernel (fixed_uint.hpp)
+ * on; the ORDER_ ones are the same for arithmetic on exponents.
+ */
+struct ModP2048Traits {
+  static constexpr const char *NAME = "modp2048";
+  static constexpr std::size_t MODULUS_BITS = 2048;
+  static constexpr std::size_t LIMBS = MODULUS_BITS / 64;
+  static constexpr std::size_t ORDER_LIMBS = 4;
+
+  static constexpr FixedUInt<LIMBS> MODULUS = ParseFixedUInt<LIMBS>(DL_P_HEX);
+  static constexpr FixedUInt<ORDER_LIMBS> ORDER = ParseFixedUInt<ORDER_LIMBS>(DL_Q_HEX);
+  static constexpr FixedUInt<LIMBS> GENERATOR = ParseFixedUInt<LIMBS>(DL_G_HEX);
+
+  static constexpr std::uint64_t MONTGOMERY_INVERSE = NegatedInverse(MODULUS[0]);
+  static constexpr FixedUInt<LIMBS> MONTGOMERY_R = MontgomeryRadix(MODULUS);
+  static constexpr FixedUInt<LIMBS> MONTGOMERY_R_SQUARED =
+      MontgomeryRadixSquared(MODULUS, MONTGOMERY_INVERSE);
+
+  static constexpr std::uint64_t ORDER_MONTGOMERY_INVERSE =
+      NegatedInverse(ORDER[0]);
+  static constexpr FixedUInt<ORDER_LIMBS> ORDER_MONTGOMERY_R =
+      MontgomeryRadix(ORDER);
+  static constexpr FixedUInt<ORDER_LIMBS> ORDER_MONTGOMERY_R_SQUARED =
+      MontgomeryRadixSquared(ORDER, ORDER_MONTGOMERY_INVERSE);
+};
+
+/**
+ * Compile-time parameters of NIST P-256, y^2 = x^3 - 3x + b: its base
+ * field, its order, b, and its generator in affine coordinates.
+ */
+struct P256Traits {
+  static constexpr const char *NAME = "p256";
+  static constexpr std::size_t MODULUS_BITS = 256;
+  static constexpr std::size_t LIMBS = MODULUS_BITS / 64;
+  static constexpr std::size_t ORDER_LIMBS = 4;
+
+  static constexpr FixedUInt<LIMBS> MODULUS = ParseFixedUInt<LIMBS>(EC_P_HEX);
+  static constexpr FixedUInt<ORDER_LIMBS> ORDER = ParseFixedUInt<ORDER_LIMBS>(EC_N_HEX);
+  static constexpr FixedUInt<LIMBS> B = ParseFixedUInt<LIMBS>(EC_B_HEX);
+  static constexpr FixedUInt<LIMBS> GENERATOR_X = ParseFixedUInt<LIMBS>(EC_GX_HEX);
+  static constexpr FixedUInt<LIMBS> GENERATOR_Y = ParseFixedUInt<LIMBS>(EC_GY_HEX);
+
+  static constexpr std::uint64_t MONTGOMERY_INVERSE = NegatedInverse(MODULUS[0]);
+  static constexpr FixedUInt<LIMBS> MONTGOMERY_R = MontgomeryRadix(MODULUS);
+  static constexpr FixedUInt<LIMBS> MONTGOMERY_R_SQUARED =
+      MontgomeryRadixSquared(MODULUS, MONTGOMERY_INVERSE);
+
+  static constexpr std::uint64_t ORDER_MONTGOMERY_INVERSE =
+      NegatedInverse(ORDER[0]);
+  static constexpr FixedUInt<ORDER_LIMBS> ORDER_MONTGOMERY_R =
+      MontgomeryRadix(ORDER);
+  static constexpr FixedUInt<ORDER_LIMBS> ORDER_MONTGOMERY_R_SQUARED =
+      MontgomeryRadixSquared(ORDER, ORDER_MONTGOMERY_INVERSE);
+};
+
+static_assert(ModP2048Traits::MODULUS[ModP2048Traits::LIMBS - 1] >> 63,
+              "DL_P must fill its limbs");
+static_assert(P256Traits::MODULUS[P256Traits::LIMBS - 1] >> 63,
+              "EC_P must fill its limbs");
+static_assert(ModP2048Traits::MODULUS[0] *
+                      (0 - ModP2048Traits::MONTGOMERY_INVERSE) ==
+                  1,
+              "bad Montgomery constant for DL_P");
+static_assert(P256Traits::MONTGOMERY_INVERSE == 1,
+              "bad Montgomery constant for EC_P");
+static_assert(ModP2048Traits::ORDER[ModP2048Traits::ORDER_LIMBS - 1] >> 63,
+              "DL_Q must fill its limbs");
+static_assert(P256Traits::ORDER[P256Traits::ORDER_LIMBS - 1] >> 63,
+              "EC_N must fill its limbs");
+
+/**
+ * The exponent field of a group, mod its order, in the shape of the traits
+ * above so the same Montgomery kernel runs on it.
+ */
+template <typename Traits> struct ScalarTraits {
+  static constexpr std::size_t LIMBS = Traits::ORDER_LIMBS;
+  static constexpr FixedUInt<LIMBS> MODULUS = Traits::ORDER;
+  static constexpr std::uint64_t MONTGOMERY_INVERSE =
+      Traits::ORDER_MONTGOMERY_INVERSE;
+  static constexpr FixedUInt<LIMBS> MONTGOMERY_R = Traits::ORDER_MONTGOMERY_R;
+  static constexpr FixedUInt<LIMBS> MONTGOMERY_R_SQUARED =
+      Traits::ORDER_MONTGOMERY_R_SQUARED;
+};
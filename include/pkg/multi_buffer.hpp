@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "../../include-shared/fixed_uint.hpp"
+
+/**
+ * Many independent exponentiations mod one 2048-bit modulus, evaluated a
+ * batch at a time with one exponentiation per vector lane. Each lane has its
+ * own base and exponent; the lanes share every squaring and multiplication
+ * instruction. The kernel is picked once, from what the CPU supports:
+ *
+ * - AVX-512 IFMA: 8 lanes, 52-bit limbs multiplied with VPMADD52{LUQ,HUQ}.
+ * - AVX2: 4 lanes, 28-bit limbs multiplied with VPMULUDQ.
+ * - Scalar: one at a time on the Montgomery kernel in fixed_uint.hpp, which
+ *   uses MULX/ADX when it can and then beats 4-lane AVX2.
+ *
+ * Exponentiation walks fixed 4-bit windows; the vector kernels read each
+ * window's table entry with masked moves, as every lane wants a different
+ * one. Immutable once built, so one engine can be shared by every thread.
+ */
+class MultiBufferModExp {
+public:
+  enum class Kernel { AVX512_IFMA, AVX2, SCALAR };
+
+  // Lanes in the widest kernel; callers should batch at least this many.
+  static constexpr std::size_t LANES = 8;
+
+  explicit MultiBufferModExp(const UInt2048 &modulus);
+  MultiBufferModExp(const UInt2048 &modulus, Kernel kernel);
+
+  /**
+   * Returns bases[i]^exponents[i] mod the modulus for every i. Bases may be
+   * any value below 2^2048.
+   */
+  std::vector<UInt2048> Exponentiate(const std::vector<UInt2048> &bases,
+                                     const std::vector<UInt256> &exponents) const;
+
+  /**
+   * Returns the product of the factors mod the modulus, 1 for none. Factor i
+   * goes to lane i % LANES and the lanes are multiplied together at the end.
+   * Factors may be any value below 2^2048 and are never converted to
+   * Montgomery form; a single correction at the end accounts for that.
+   */
+  UInt2048 Multiply(std::span<const UInt2048> factors) const;
+
+  Kernel GetKernel() const;
+  static Kernel DetectKernel();
+
+private:
+  UInt2048 modulus;
+  std::uint64_t inverse;   // -modulus^-1 mod 2^64
+  UInt2048 radix_squared;  // 2^4096 mod modulus
+  Kernel kernel;
+
+  // The same for a vector kernel, in its limb size
+  std::vector<std::uint64_t> limb_modulus;
+  std::vector<std::uint64_t> limb_radix_squared;
+  std::uint64_t limb_inverse;
+  UInt2048 limb_radix; // the vector kernel's R mod modulus, whole
+};
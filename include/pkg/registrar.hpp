@@ -14,6 +14,7 @@
 #include "../../include/drivers/crypto_driver.hpp"
 #include "../../include/drivers/db_driver.hpp"
 #include "../../include/drivers/network_driver.hpp"
+#include "../../include/pkg/election_math.hpp"
 
 class RegistrarClient {
 public:
@@ -30,6 +31,7 @@ private:
   CommonConfig common_config;
   int num_candidates;
   int k;
+  const GroupContext *group; // The election group named in the config
   std::shared_ptr<CLIDriver> cli_driver;
   std::shared_ptr<DBDriver> db_driver;
 
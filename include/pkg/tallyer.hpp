@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 #include <crypto++/cryptlib.h>
 #include <crypto++/dh.h>
 #include <crypto++/dh2.h>
@@ -14,6 +16,7 @@
 #include "../../include/drivers/crypto_driver.hpp"
 #include "../../include/drivers/db_driver.hpp"
 #include "../../include/drivers/network_driver.hpp"
+#include "../../include/pkg/election_math.hpp"
 
 class TallyerClient {
 public:
@@ -30,13 +33,17 @@ private:
   CommonConfig common_config;
   int num_candidates;
   int k;
+  const GroupContext *group; // The election group named in the config
   std::shared_ptr<CLIDriver> cli_driver;
   std::shared_ptr<DBDriver> db_driver;
+  std::mutex aggregate_mtx; // Serializes folding ballots into the aggregate
 
   CryptoPP::Integer EG_arbiter_public_key; // The election's EG public key
+  std::shared_ptr<FixedBaseTable> EG_arbiter_public_key_table; // Its fixed-base table
   CryptoPP::DSA::PublicKey DSA_registrar_verification_key;
   CryptoPP::DSA::PrivateKey DSA_tallyer_signing_key;
   CryptoPP::DSA::PublicKey DSA_tallyer_verification_key;
 
   void ListenForConnections(int port);
+  AggregateRow CurrentAggregate(std::shared_ptr<CryptoDriver> crypto_driver);
 };
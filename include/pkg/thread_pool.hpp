@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * A fixed set of worker threads for data-parallel loops. A loop's
+ * iterations are claimed one at a time by the workers and by the thread
+ * that started it, which returns once every iteration has finished. The
+ * caller always makes progress on its own loop, so a loop may start
+ * another on the same pool.
+ */
+class ThreadPool {
+public:
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  // Runs task(i) for every i in [0, count); rethrows the first exception.
+  void ParallelFor(int count, const std::function<void(int)> &task);
+  int Size() const;
+
+  // One worker per hardware thread, shared by the whole process.
+  static ThreadPool &Shared();
+
+private:
+  struct Loop;
+  void Work();
+  static void RunLoop(Loop &loop);
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<std::shared_ptr<Loop>> loops; // one entry per helper wanted
+  bool stopping;
+  std::vector<std::thread> workers;
+};
+
+/**
+ * Reduces count values in parallel: map(i) computes each one on the pool,
+ * and then neighbours are merged pairwise, every merge of a level on the
+ * pool, until one value is left. merge takes the left value by rvalue, to
+ * reuse it, and must be associative; count must be at least 1.
+ */
+template <typename T, typename Map, typename Merge>
+T ParallelReduce(ThreadPool &pool, int count, Map map, Merge merge) {
+  std::vector<T> values(count);
+  pool.ParallelFor(count, [&](int i) { values[i] = map(i); });
+  for (int width = 1; width < count; width *= 2) {
+    int pairs = (count + 2 * width - 1) / (2 * width);
+    pool.ParallelFor(pairs, [&](int p) {
+      int left = 2 * width * p;
+      if (left + width < count) {
+        values[left] = merge(std::move(values[left]), values[left + width]);
+      }
+    });
+  }
+  return values[0];
+}
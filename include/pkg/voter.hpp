@@ -14,6 +14,8 @@
 #include "../../include/drivers/crypto_driver.hpp"
 #include "../../include/drivers/db_driver.hpp"
 #include "../../include/drivers/network_driver.hpp"
+#include "../../include/pkg/ballot_pool.hpp"
+#include "../../include/pkg/election_math.hpp"
 
 class VoterClient {
 public:
@@ -26,7 +28,7 @@ public:
   void HandleRegister(std::string input);
   void HandleVote(std::string input);
   void HandleVerify(std::string input);
-  std::tuple<std::vector<CryptoPP::Integer>, std::vector<CryptoPP::Integer>, bool> DoVerify();
+  std::tuple<std::vector<CryptoPP::Integer>, std::vector<CryptoPP::Integer>, bool> DoVerify(bool audit = false);
 
 private:
   std::string id;
@@ -36,12 +38,16 @@ private:
   CommonConfig common_config;
   int num_candidates;
   int k;
+  const GroupContext *group; // The election group named in the config
   std::shared_ptr<CLIDriver> cli_driver;
   std::shared_ptr<CryptoDriver> crypto_driver;
   std::shared_ptr<DBDriver> db_driver;
   std::shared_ptr<NetworkDriver> network_driver;
 
   CryptoPP::Integer EG_arbiter_public_key; // The election's EG public key
+  std::shared_ptr<FixedBaseTable> EG_arbiter_public_key_table; // Its fixed-base table
+  std::shared_ptr<DiscreteLogTable> tally_dlog_table; // Reused while the ballot count fits
+  std::shared_ptr<BallotPool> ballot_pool; // Ballots precomputed for the election key
   CryptoPP::SecByteBlock AES_key;
   CryptoPP::SecByteBlock HMAC_key;
 
@@ -0,0 +1,238 @@
+#include "../include-shared/ballot_batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// ================================================
+// ARENA
+// ================================================
+
+/**
+ * Starts an empty arena; blocks are allocated as they are needed.
+ */
+Arena::Arena(size_t block_size)
+    : block_size(block_size), used(0), used_before(0) {}
+
+/**
+ * Takes size bytes from the last block, or from a new one if it is full.
+ * A request larger than the block size gets a block of its own.
+ */
+void *Arena::AllocateBytes(size_t size, size_t alignment) {
+  if (!this->blocks.empty()) {
+    Block &block = this->blocks.back();
+    size_t start = (this->used + alignment - 1) & ~(alignment - 1);
+    if (start <= block.size && size <= block.size - start) {
+      this->used = start + size;
+      return block.data.get() + start;
+    }
+    this->used_before += this->used;
+  }
+
+  // left uninitialized, as every value is constructed over it
+  Block block;
+  block.size = std::max(size, this->block_size);
+  block.data = std::unique_ptr<unsigned char[]>(new unsigned char[block.size]);
+  this->blocks.push_back(std::move(block));
+  this->used = size;
+  return this->blocks.back().data.get();
+}
+
+/**
+ * Releases everything allocated, keeping the first block for reuse.
+ */
+void Arena::Reset() {
+  if (this->blocks.size() > 1) {
+    this->blocks.resize(1);
+  }
+  this->used = 0;
+  this->used_before = 0;
+}
+
+/**
+ * Bytes handed out since the last reset.
+ */
+size_t Arena::BytesUsed() const { return this->used_before + this->used; }
+
+// ================================================
+// BALLOT BATCH
+// ================================================
+
+namespace {
+/**
+ * The fewest bytes an element of type T can be serialized in, in any
+ * format version: that of a default element, whose fields are all zero.
+ */
+template <typename T> size_t MinimumSerializedSize() {
+  static const size_t size = [] {
+    size_t smallest = SIZE_MAX;
+    for (int version = 1; version <= MESSAGE_FORMAT_VERSION; version++) {
+      T element;
+      element.format_version = version;
+      smallest = std::min(smallest, element.serialized_size());
+    }
+    return smallest;
+  }();
+  return size;
+}
+
+/**
+ * Reads a list serialized as its container message of the given type, such
+ * as Votes_Struct, straight into the arena. Returns the bytes read.
+ */
+template <typename T>
+int ReadList(Arena &arena, MessageType::T type,
+             std::span<const unsigned char> data, std::span<const T> *list,
+             int *version) {
+  if (get_message_type(data) != type) {
+    throw std::runtime_error("unexpected message type");
+  }
+  *version = get_message_version(data);
+
+  int n = 1;
+  size_t size;
+  n += get_size(&size, data, n, *version);
+  // the bytes left bound how many elements there can be, and with them the
+  // allocation, which is far larger per element than its encoding
+  if (size > (data.size() - n) / MinimumSerializedSize<T>()) {
+    throw std::runtime_error("truncated message");
+  }
+
+  T *elements = arena.Allocate<T>(size);
+  for (size_t i = 0; i < size; i++) {
+    new (&elements[i]) T();
+    n += elements[i].deserialize(data.subspan(n));
+  }
+  *list = std::span<const T>(elements, size);
+  return n;
+}
+} // namespace
+
+/**
+ * Starts an empty batch whose arena allocates block_size bytes at a time.
+ */
+BallotBatch::BallotBatch(size_t block_size) : arena(block_size) {}
+
+/**
+ * Reads one ballot from its serialized votes, zkps and count zkps, and its
+ * tallyer signature, such as the columns of a vote row. The bytes are
+ * copied into the arena; the arguments need not outlive the call. Throws
+ * if a list is malformed.
+ */
+void BallotBatch::Add(std::span<const unsigned char> votes_data,
+                      std::span<const unsigned char> zkps_data,
+                      std::span<const unsigned char> count_zkps_data,
+                      std::span<const unsigned char> tallyer_signature) {
+  BallotView ballot;
+
+  std::span<const unsigned char> votes = this->Keep(votes_data);
+  int n = ReadList(this->arena, MessageType::Votes_Struct, votes,
+                   &ballot.votes, &ballot.votes_version);
+  ballot.votes_data = votes.first(n);
+
+  std::span<const unsigned char> zkps = this->Keep(zkps_data);
+  n = ReadList(this->arena, MessageType::VoteZKPs_Struct, zkps, &ballot.zkps,
+               &ballot.zkps_version);
+  ballot.zkps_data = zkps.first(n);
+
+  std::span<const unsigned char> count_zkps = this->Keep(count_zkps_data);
+  n = ReadList(this->arena, MessageType::Count_ZKPs_Struct, count_zkps,
+               &ballot.count_zkps, &ballot.count_zkps_version);
+  ballot.count_zkps_data = count_zkps.first(n);
+
+  std::span<const unsigned char> signature = this->Keep(tallyer_signature);
+  ballot.tallyer_signature =
+      std::string_view((const char *)signature.data(), signature.size());
+
+  this->ballots.push_back(ballot);
+}
+
+/**
+ * Copies data into the arena.
+ */
+std::span<const unsigned char>
+BallotBatch::Keep(std::span<const unsigned char> data) {
+  unsigned char *copy = this->arena.Allocate<unsigned char>(data.size());
+  if (!data.empty()) {
+    std::memcpy(copy, data.data(), data.size());
+  }
+  return std::span<const unsigned char>(copy, data.size());
+}
+
+/**
+ * Number of ballots.
+ */
+size_t BallotBatch::Size() const { return this->ballots.size(); }
+
+/**
+ * The i-th ballot added.
+ */
+const BallotView &BallotBatch::operator[](size_t i) const {
+  return this->ballots[i];
+}
+
+/**
+ * Every ballot, in the order added.
+ */
+const std::vector<BallotView> &BallotBatch::Ballots() const {
+  return this->ballots;
+}
+
+/**
+ * Bytes of the arena the ballots take.
+ */
+size_t BallotBatch::BytesUsed() const { return this->arena.BytesUsed(); }
+
+/**
+ * Drops every ballot at once.
+ */
+void BallotBatch::Reset() {
+  this->ballots.clear();
+  this->arena.Reset();
+}
+
+// ================================================
+// SIGNING HELPERS
+// ================================================
+
+/**
+ * Views a ballot received from a voter: its lists, and the bytes they were
+ * read from, which stay owned by the caller. The tallyer signature is left
+ * empty. Throws if the ballot was not deserialized.
+ */
+BallotView view_ballot(const VoterToTallyer_Vote_Message &ballot) {
+  if (ballot.votes_data.empty() || ballot.zkps_data.empty() ||
+      ballot.count_zkps_data.empty()) {
+    throw std::runtime_error("ballot was not deserialized");
+  }
+
+  BallotView view;
+  view.votes = ballot.votes.votes;
+  view.zkps = ballot.zkps.zkps;
+  view.count_zkps = ballot.count_zkps.count_zkps;
+  view.votes_version = ballot.votes.format_version;
+  view.zkps_version = ballot.zkps.format_version;
+  view.count_zkps_version = ballot.count_zkps.format_version;
+  view.votes_data = ballot.votes_data;
+  view.zkps_data = ballot.zkps_data;
+  view.count_zkps_data = ballot.count_zkps_data;
+  return view;
+}
+
+/**
+ * Concatenate a ballot's votes, zkps, vote count and count zkps into vector
+ * of unsigned char, reusing the bytes the lists were read from
+ */
+std::vector<unsigned char> concat_votes_and_zkps(const BallotView &ballot,
+                                                 const Vote_Struct &vote_count) {
+  std::vector<unsigned char> v;
+  v.reserve(ballot.votes_data.size() + ballot.zkps_data.size() +
+            vote_count.serialized_size() + ballot.count_zkps_data.size());
+  v.insert(v.end(), ballot.votes_data.begin(), ballot.votes_data.end());
+  v.insert(v.end(), ballot.zkps_data.begin(), ballot.zkps_data.end());
+  vote_count.serialize(v);
+  v.insert(v.end(), ballot.count_zkps_data.begin(),
+           ballot.count_zkps_data.end());
+  return v;
+}
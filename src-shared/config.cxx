@@ -46,6 +46,8 @@ CommonConfig load_common_config(std::string filename) {
     root.get<std::string>("num_candidates", "");
   config.k =
     root.get<std::string>("k", "");
+  config.group =
+    root.get<std::string>("group", "");
 
   return config;
 }
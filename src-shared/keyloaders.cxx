@@ -1,5 +1,6 @@
 #include "../include-shared/keyloaders.hpp"
 #include "../include-shared/constants.hpp"
+#include "../include-shared/rng.hpp"
 #include "../include-shared/util.hpp"
 
 /**
@@ -16,8 +17,7 @@ void SaveDSAPrivateKey(const std::string &filename,
 void LoadDSAPrivateKey(const std::string &filename, CryptoPP::PrivateKey &key) {
   key.Load(CryptoPP::FileStore(filename.c_str()).Ref());
 
-  CryptoPP::AutoSeededRandomPool rng;
-  if (!key.Validate(rng, 3)) {
+  if (!key.Validate(ThreadRNG(), 3)) {
     throw std::runtime_error("DSA private key loading failed");
   }
 }
@@ -36,8 +36,7 @@ void SaveDSAPublicKey(const std::string &filename,
 void LoadDSAPublicKey(const std::string &filename, CryptoPP::PublicKey &key) {
   key.Load(CryptoPP::FileStore(filename.c_str()).Ref());
 
-  CryptoPP::AutoSeededRandomPool rng;
-  if (!key.Validate(rng, 3)) {
+  if (!key.Validate(ThreadRNG(), 3)) {
     throw std::runtime_error("DSA public key loading failed");
   }
 }
@@ -103,15 +102,15 @@ void LoadInteger(const std::string &filename, CryptoPP::Integer *i) {
 }
 
 /**
- * Loads the election public key from the files provided.
+ * Loads the arbiters' public keys from the files provided; the election
+ * group combines them into the election public key.
  */
-void LoadElectionPublicKey(const std::vector<std::string> &filenames,
-                           CryptoPP::Integer *public_key) {
-  CryptoPP::Integer final_key = CryptoPP::Integer::One();
+void LoadElectionPublicKeys(const std::vector<std::string> &filenames,
+                            std::vector<CryptoPP::Integer> *public_keys) {
+  public_keys->clear();
   for (auto path : filenames) {
     CryptoPP::Integer key;
     LoadInteger(path, &key);
-    final_key *= key;
+    public_keys->push_back(key);
   }
-  *public_key = CryptoPP::Integer(final_key);
 }
@@ -8,8 +8,39 @@
 /**
  * Get message type.
  */
-MessageType::T get_message_type(std::vector<unsigned char> &data) {
-  return (MessageType::T)data[0];
+MessageType::T get_message_type(std::span<const unsigned char> data) {
+  if (data.empty()) {
+    throw std::runtime_error("truncated message");
+  }
+  return (MessageType::T)(data[0] & ~MESSAGE_V3);
+}
+
+/**
+ * Get the format version data was written in, from its leading byte.
+ */
+int get_message_version(std::span<const unsigned char> data) {
+  if (data.empty()) {
+    throw std::runtime_error("truncated message");
+  }
+  switch (data[0] & MESSAGE_V3) {
+  case MESSAGE_V3:
+    return 3;
+  case MESSAGE_V2:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+/**
+ * Puts the type of a message written in the given version into the end of
+ * data.
+ */
+int put_message_type(MessageType::T type, int version,
+                     std::vector<unsigned char> &data) {
+  unsigned char flags = version == 1 ? 0 : version == 2 ? MESSAGE_V2 : MESSAGE_V3;
+  data.push_back((unsigned char)(type | flags));
+  return 1;
 }
 
 // ================================================
@@ -24,15 +55,33 @@ int put_bool(bool b, std::vector<unsigned char> &data) {
   return 1;
 }
 
+/**
+ * Puts the size n into the end of data: a native size_t in version 1, a
+ * varint (seven bits a byte, low bits first) in version 2.
+ */
+int put_size(size_t n, std::vector<unsigned char> &data, int version) {
+  int idx = data.size();
+  if (version == 1) {
+    data.resize(idx + sizeof(size_t));
+    std::memcpy(&data[idx], &n, sizeof(size_t));
+    return sizeof(size_t);
+  }
+  do {
+    unsigned char byte = n & 0x7f;
+    n >>= 7;
+    data.push_back(n ? byte | 0x80 : byte);
+  } while (n);
+  return data.size() - idx;
+}
+
 /**
  * Puts the string s into the end of data.
  */
-int put_string(std::string s, std::vector<unsigned char> &data) {
+int put_string(std::string_view s, std::vector<unsigned char> &data,
+               int version) {
   // Put length
   int idx = data.size();
-  data.resize(idx + sizeof(size_t));
-  size_t str_size = s.size();
-  std::memcpy(&data[idx], &str_size, sizeof(size_t));
+  put_size(s.size(), data, version);
 
   // Put string
   data.insert(data.end(), s.begin(), s.end());
@@ -40,54 +89,277 @@ int put_string(std::string s, std::vector<unsigned char> &data) {
 }
 
 /**
- * Puts the integer i into the end of data.
+ * Puts the integer i into the end of data: as a decimal string in version
+ * 1, as a length and its big-endian bytes in version 2.
+ */
+int put_integer(const CryptoPP::Integer &i, std::vector<unsigned char> &data,
+                int version) {
+  if (version == 1) {
+    return put_string(CryptoPP::IntToString(i), data, version);
+  }
+  if (i.IsNegative()) {
+    throw std::runtime_error("cannot serialize a negative integer");
+  }
+  int idx = data.size();
+  size_t size = i.MinEncodedSize();
+  put_size(size, data, version);
+  int bytes_idx = data.size();
+  data.resize(bytes_idx + size);
+  i.Encode(&data[bytes_idx], size);
+  return data.size() - idx;
+}
+
+/**
+ * Puts the group element i into the end of data, in the same encoding as
+ * an Integer. Version 2 drops the leading zero bytes, so an element of a
+ * small group, like a compressed P-256 point, costs what it needs.
  */
-int put_integer(CryptoPP::Integer i, std::vector<unsigned char> &data) {
-  return put_string(CryptoPP::IntToString(i), data);
+int put_integer(const UInt2048 &i, std::vector<unsigned char> &data,
+                int version) {
+  if (version == 1) {
+    return put_integer(i.ToInteger(), data, version);
+  }
+  unsigned char bytes[UInt2048::BYTES];
+  i.Encode(bytes);
+  size_t skip = 0;
+  while (skip < UInt2048::BYTES - 1 && bytes[skip] == 0) {
+    skip++;
+  }
+  int idx = data.size();
+  put_size(UInt2048::BYTES - skip, data, version);
+  data.insert(data.end(), bytes + skip, bytes + UInt2048::BYTES);
+  return data.size() - idx;
 }
 
 /**
- * Adds a size param to the end of data.
-*/
-void add_size_param(std::vector<unsigned char> &data, size_t &size_param) {
+ * Puts the scalar i into the end of data: in the same encoding as an
+ * Integer in version 1, as a fixed 32 big-endian bytes in version 2.
+ */
+int put_integer(const UInt256 &i, std::vector<unsigned char> &data,
+                int version) {
+  if (version == 1) {
+    return put_integer(i.ToInteger(), data, version);
+  }
   int idx = data.size();
-  data.resize(idx + sizeof(size_t));
-  std::memcpy(&data[idx], &size_param, sizeof(size_t));
+  data.resize(idx + UInt256::BYTES);
+  i.Encode(&data[idx]);
+  return UInt256::BYTES;
 }
 
 /**
  * Puts the nest bool from data at index idx into b.
  */
-int get_bool(bool *b, std::vector<unsigned char> &data, int idx) {
+int get_bool(bool *b, std::span<const unsigned char> data, int idx) {
+  if (idx >= data.size()) {
+    throw std::runtime_error("truncated message");
+  }
   *b = (bool)data[idx];
   return 1;
 }
 
+/**
+ * Puts the next size from data at index idx into n.
+ */
+int get_size(size_t *n, std::span<const unsigned char> data, int idx,
+             int version) {
+  if (version == 1) {
+    if (idx + sizeof(size_t) > data.size()) {
+      throw std::runtime_error("truncated message");
+    }
+    std::memcpy(n, &data[idx], sizeof(size_t));
+    return sizeof(size_t);
+  }
+  size_t value = 0;
+  int count = 0;
+  while (true) {
+    if (idx + count >= data.size() || count * 7 >= 64) {
+      throw std::runtime_error("bad size in message");
+    }
+    unsigned char byte = data[idx + count];
+    value |= size_t(byte & 0x7f) << (7 * count);
+    count++;
+    if (!(byte & 0x80)) {
+      break;
+    }
+  }
+  *n = value;
+  return count;
+}
+
 /**
  * Puts the nest string from data at index idx into s.
  */
-int get_string(std::string *s, std::vector<unsigned char> &data, int idx) {
+int get_string(std::string *s, std::span<const unsigned char> data, int idx,
+               int version) {
   // Get length
   size_t str_size;
-  std::memcpy(&str_size, &data[idx], sizeof(size_t));
+  int n = get_size(&str_size, data, idx, version);
+  if (str_size > data.size() - idx - n) {
+    throw std::runtime_error("truncated message");
+  }
 
   // Get string
-  std::vector<unsigned char> svec(&data[idx + sizeof(size_t)],
-                                  &data[idx + sizeof(size_t) + str_size]);
-  *s = chvec2str(svec);
-  return sizeof(size_t) + str_size;
+  s->assign((const char *)data.data() + idx + n, str_size);
+  return n + str_size;
 }
 
 /**
  * Puts the next integer from data at index idx into i.
  */
-int get_integer(CryptoPP::Integer *i, std::vector<unsigned char> &data,
-                int idx) {
-  std::string i_str;
-  int n = get_string(&i_str, data, idx);
-  *i = CryptoPP::Integer(i_str.c_str());
+int get_integer(CryptoPP::Integer *i, std::span<const unsigned char> data,
+                int idx, int version) {
+  if (version == 1) {
+    std::string i_str;
+    int n = get_string(&i_str, data, idx, version);
+    *i = CryptoPP::Integer(i_str.c_str());
+    return n;
+  }
+  size_t size;
+  int n = get_size(&size, data, idx, version);
+  if (size > data.size() - idx - n) {
+    throw std::runtime_error("truncated message");
+  }
+  i->Decode(data.data() + idx + n, size);
+  return n + size;
+}
+
+namespace {
+/**
+ * Sets every limb of i, which reads a value too wide for it as all ones:
+ * not a group element.
+ */
+template <std::size_t N> void set_all_ones(FixedUInt<N> *i) {
+  for (std::size_t limb = 0; limb < N; limb++) {
+    (*i)[limb] = ~std::uint64_t(0);
+  }
+}
+
+/**
+ * Puts the next integer in the version 1 encoding from data at index idx
+ * into i.
+ */
+template <std::size_t N>
+int get_fixed_integer(FixedUInt<N> *i, std::span<const unsigned char> data,
+                      int idx) {
+  CryptoPP::Integer value;
+  int n = get_integer(&value, data, idx, 1);
+  if (!FixedUInt<N>::FromInteger(value, i)) {
+    set_all_ones(i);
+  }
   return n;
 }
+} // namespace
+
+/**
+ * Puts the next group element from data at index idx into i.
+ */
+int get_integer(UInt2048 *i, std::span<const unsigned char> data, int idx,
+                int version) {
+  if (version == 1) {
+    return get_fixed_integer(i, data, idx);
+  }
+  size_t size;
+  int n = get_size(&size, data, idx, version);
+  if (size > data.size() - idx - n) {
+    throw std::runtime_error("truncated message");
+  }
+  if (size > UInt2048::BYTES) {
+    set_all_ones(i);
+  } else {
+    unsigned char bytes[UInt2048::BYTES] = {0};
+    std::memcpy(bytes + UInt2048::BYTES - size, &data[idx + n], size);
+    *i = UInt2048::Decode(bytes);
+  }
+  return n + size;
+}
+
+/**
+ * Puts the next scalar from data at index idx into i.
+ */
+int get_integer(UInt256 *i, std::span<const unsigned char> data, int idx,
+                int version) {
+  if (version == 1) {
+    return get_fixed_integer(i, data, idx);
+  }
+  if (idx + UInt256::BYTES > data.size()) {
+    throw std::runtime_error("truncated message");
+  }
+  *i = UInt256::Decode(&data[idx]);
+  return UInt256::BYTES;
+}
+
+// ================================================
+// SIZERS
+// ================================================
+
+/**
+ * Returns how many bytes put_size writes for n.
+ */
+size_t size_of_size(size_t n, int version) {
+  if (version == 1) {
+    return sizeof(size_t);
+  }
+  size_t count = 1;
+  while (n >>= 7) {
+    count++;
+  }
+  return count;
+}
+
+/**
+ * Returns how many bytes put_string writes for a string of the given
+ * length.
+ */
+size_t size_of_string(size_t length, int version) {
+  return size_of_size(length, version) + length;
+}
+
+/**
+ * Returns how many bytes put_integer writes for i.
+ */
+size_t size_of_integer(const CryptoPP::Integer &i, int version) {
+  if (version == 1) {
+    return size_of_string(CryptoPP::IntToString(i).size(), version);
+  }
+  return size_of_string(i.MinEncodedSize(), version);
+}
+
+/**
+ * Returns how many bytes put_integer writes for the group element i.
+ */
+size_t size_of_integer(const UInt2048 &i, int version) {
+  if (version == 1) {
+    return size_of_integer(i.ToInteger(), version);
+  }
+  size_t length = (i.BitCount() + 7) / 8;
+  return size_of_string(length == 0 ? 1 : length, version);
+}
+
+/**
+ * Returns how many bytes put_integer writes for the scalar i.
+ */
+size_t size_of_integer(const UInt256 &i, int version) {
+  if (version == 1) {
+    return size_of_integer(i.ToInteger(), version);
+  }
+  return UInt256::BYTES;
+}
+
+/**
+ * Makes room for s at the end of data, so serializing it takes at most one
+ * allocation. A version 1 struct would pay for its decimal conversions
+ * twice to be sized, so it grows as it goes instead.
+ */
+void reserve_serialized(const Serializable &s,
+                        std::vector<unsigned char> &data) {
+  if (s.format_version == 1) {
+    return;
+  }
+  size_t needed = data.size() + s.serialized_size();
+  if (needed > data.capacity()) {
+    data.reserve(std::max(needed, 2 * data.capacity()));
+  }
+}
 
 // ================================================
 // WRAPPERS
@@ -96,40 +368,54 @@ int get_integer(CryptoPP::Integer *i, std::vector<unsigned char> &data,
 /**
  * serialize HMACTagged_Wrapper.
  */
-void HMACTagged_Wrapper::serialize(std::vector<unsigned char> &data) {
-  // Add message type.
-  data.push_back((char)MessageType::HMACTagged_Wrapper);
+void HMACTagged_Wrapper::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
 
-  // Add fields.
-  put_string(chvec2str(this->payload), data);
+  // Add message type.
+  put_message_type(MessageType::HMACTagged_Wrapper, this->format_version, data);
 
-  std::string iv = byteblock_to_string(this->iv);
-  put_string(iv, data);
+  // Add fields, straight from their bytes.
+  put_string(std::string_view((const char *)this->payload.data(),
+                              this->payload.size()),
+             data, this->format_version);
+  put_string(std::string_view((const char *)this->iv.data(), this->iv.size()),
+             data, this->format_version);
 
-  put_string(this->mac, data);
+  put_string(this->mac, data, this->format_version);
 }
 
 /**
  * deserialize HMACTagged_Wrapper.
  */
-int HMACTagged_Wrapper::deserialize(std::vector<unsigned char> &data) {
+int HMACTagged_Wrapper::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::HMACTagged_Wrapper);
+  assert(get_message_type(data) == MessageType::HMACTagged_Wrapper);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   std::string payload_string;
   int n = 1;
-  n += get_string(&payload_string, data, n);
+  n += get_string(&payload_string, data, n, this->format_version);
   this->payload = str2chvec(payload_string);
 
   std::string iv;
-  n += get_string(&iv, data, n);
+  n += get_string(&iv, data, n, this->format_version);
   this->iv = string_to_byteblock(iv);
 
-  n += get_string(&this->mac, data, n);
+  n += get_string(&this->mac, data, n, this->format_version);
   return n;
 }
 
+/**
+ * serialized_size HMACTagged_Wrapper.
+ */
+size_t HMACTagged_Wrapper::serialized_size() const {
+  return 1 + size_of_string(this->payload.size(), this->format_version) +
+         size_of_string(this->iv.size(), this->format_version) +
+         size_of_string(this->mac.size(), this->format_version);
+}
+
 // ================================================
 // KEY EXCHANGE
 // ================================================
@@ -138,69 +424,93 @@ int HMACTagged_Wrapper::deserialize(std::vector<unsigned char> &data) {
  * serialize UserToServer_DHPublicValue_Message.
  */
 void UserToServer_DHPublicValue_Message::serialize(
-    std::vector<unsigned char> &data) {
+    std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::UserToServer_DHPublicValue_Message);
+  put_message_type(MessageType::UserToServer_DHPublicValue_Message, this->format_version, data);
 
   // Add fields.
   std::string public_string = byteblock_to_string(this->public_value);
-  put_string(public_string, data);
+  put_string(public_string, data, this->format_version);
 }
 
 /**
  * deserialize UserToServer_DHPublicValue_Message.
  */
 int UserToServer_DHPublicValue_Message::deserialize(
-    std::vector<unsigned char> &data) {
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::UserToServer_DHPublicValue_Message);
+  assert(get_message_type(data) == MessageType::UserToServer_DHPublicValue_Message);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   std::string public_string;
   int n = 1;
-  n += get_string(&public_string, data, n);
+  n += get_string(&public_string, data, n, this->format_version);
   this->public_value = string_to_byteblock(public_string);
   return n;
 }
 
+/**
+ * serialized_size UserToServer_DHPublicValue_Message.
+ */
+size_t UserToServer_DHPublicValue_Message::serialized_size() const {
+  return 1 + size_of_string(this->public_value.size(), this->format_version);
+}
+
 /**
  * serialize ServerToUser_DHPublicValue_Message.
  */
 void ServerToUser_DHPublicValue_Message::serialize(
-    std::vector<unsigned char> &data) {
+    std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::ServerToUser_DHPublicValue_Message);
+  put_message_type(MessageType::ServerToUser_DHPublicValue_Message, this->format_version, data);
 
   // Add fields.
   std::string server_public_string =
       byteblock_to_string(this->server_public_value);
   std::string user_public_string =
       byteblock_to_string(this->user_public_value);
-  put_string(server_public_string, data);
-  put_string(user_public_string, data);
-  put_string(this->server_signature, data);
+  put_string(server_public_string, data, this->format_version);
+  put_string(user_public_string, data, this->format_version);
+  put_string(this->server_signature, data, this->format_version);
 }
 
 /**
  * deserialize ServerToUser_DHPublicValue_Message.
  */
 int ServerToUser_DHPublicValue_Message::deserialize(
-    std::vector<unsigned char> &data) {
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::ServerToUser_DHPublicValue_Message);
+  assert(get_message_type(data) == MessageType::ServerToUser_DHPublicValue_Message);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   std::string server_public_string;
   std::string user_public_string;
   int n = 1;
-  n += get_string(&server_public_string, data, n);
-  n += get_string(&user_public_string, data, n);
-  n += get_string(&this->server_signature, data, n);
+  n += get_string(&server_public_string, data, n, this->format_version);
+  n += get_string(&user_public_string, data, n, this->format_version);
+  n += get_string(&this->server_signature, data, n, this->format_version);
   this->server_public_value = string_to_byteblock(server_public_string);
   this->user_public_value = string_to_byteblock(user_public_string);
   return n;
 }
 
+/**
+ * serialized_size ServerToUser_DHPublicValue_Message.
+ */
+size_t ServerToUser_DHPublicValue_Message::serialized_size() const {
+  return 1 + size_of_string(this->server_public_value.size(), this->format_version) +
+         size_of_string(this->user_public_value.size(), this->format_version) +
+         size_of_string(this->server_signature.size(), this->format_version);
+}
+
 // ================================================
 // VOTER <==> REGISTRAR
 // ================================================
@@ -209,9 +519,12 @@ int ServerToUser_DHPublicValue_Message::deserialize(
  * serialize VoterToRegistrar_Register_Message.
  */
 void VoterToRegistrar_Register_Message::serialize(
-    std::vector<unsigned char> &data) {
+    std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::VoterToRegistrar_Register_Message);
+  put_message_type(MessageType::VoterToRegistrar_Register_Message, this->format_version, data);
 
   // Serialize signing key.
   std::string user_verification_key_str;
@@ -219,23 +532,24 @@ void VoterToRegistrar_Register_Message::serialize(
   this->user_verification_key.Save(ss);
 
   // Add fields.
-  put_string(this->id, data);
-  put_string(user_verification_key_str, data);
+  put_string(this->id, data, this->format_version);
+  put_string(user_verification_key_str, data, this->format_version);
 }
 
 /**
  * deserialize VoterToRegistrar_Register_Message.
  */
 int VoterToRegistrar_Register_Message::deserialize(
-    std::vector<unsigned char> &data) {
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::VoterToRegistrar_Register_Message);
+  assert(get_message_type(data) == MessageType::VoterToRegistrar_Register_Message);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   std::string user_verification_key_str;
   int n = 1;
-  n += get_string(&this->id, data, n);
-  n += get_string(&user_verification_key_str, data, n);
+  n += get_string(&this->id, data, n, this->format_version);
+  n += get_string(&user_verification_key_str, data, n, this->format_version);
 
   // Deserialize signing key.
   CryptoPP::StringSource ss(user_verification_key_str, true);
@@ -243,13 +557,27 @@ int VoterToRegistrar_Register_Message::deserialize(
   return n;
 }
 
+/**
+ * serialized_size VoterToRegistrar_Register_Message.
+ */
+size_t VoterToRegistrar_Register_Message::serialized_size() const {
+  std::string user_verification_key_str;
+  CryptoPP::StringSink ss(user_verification_key_str);
+  this->user_verification_key.Save(ss);
+  return 1 + size_of_string(this->id.size(), this->format_version) +
+         size_of_string(user_verification_key_str.size(), this->format_version);
+}
+
 /**
  * serialize RegistrarToVoter_Certificate_Message.
  */
 void RegistrarToVoter_Certificate_Message::serialize(
-    std::vector<unsigned char> &data) {
+    std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::RegistrarToVoter_Certificate_Message);
+  put_message_type(MessageType::RegistrarToVoter_Certificate_Message, this->format_version, data);
 
   // Serialize signing key.
   std::string verification_key_str;
@@ -257,25 +585,26 @@ void RegistrarToVoter_Certificate_Message::serialize(
   this->verification_key.Save(ss);
 
   // Add fields.
-  put_string(this->id, data);
-  put_string(verification_key_str, data);
-  put_string(this->registrar_signature, data);
+  put_string(this->id, data, this->format_version);
+  put_string(verification_key_str, data, this->format_version);
+  put_string(this->registrar_signature, data, this->format_version);
 }
 
 /**
  * deserialize RegistrarToVoter_Certificate_Message.
  */
 int RegistrarToVoter_Certificate_Message::deserialize(
-    std::vector<unsigned char> &data) {
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::RegistrarToVoter_Certificate_Message);
+  assert(get_message_type(data) == MessageType::RegistrarToVoter_Certificate_Message);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   std::string verification_key_str;
   int n = 1;
-  n += get_string(&this->id, data, n);
-  n += get_string(&verification_key_str, data, n);
-  n += get_string(&this->registrar_signature, data, n);
+  n += get_string(&this->id, data, n, this->format_version);
+  n += get_string(&verification_key_str, data, n, this->format_version);
+  n += get_string(&this->registrar_signature, data, n, this->format_version);
 
   // Deserialize signing key.
   CryptoPP::StringSource ss(verification_key_str, true);
@@ -283,6 +612,18 @@ int RegistrarToVoter_Certificate_Message::deserialize(
   return n;
 }
 
+/**
+ * serialized_size RegistrarToVoter_Certificate_Message.
+ */
+size_t RegistrarToVoter_Certificate_Message::serialized_size() const {
+  std::string verification_key_str;
+  CryptoPP::StringSink ss(verification_key_str);
+  this->verification_key.Save(ss);
+  return 1 + size_of_string(this->id.size(), this->format_version) +
+         size_of_string(verification_key_str.size(), this->format_version) +
+         size_of_string(this->registrar_signature.size(), this->format_version);
+}
+
 // ================================================
 // VOTER <==> TALLYER
 // ================================================
@@ -290,336 +631,474 @@ int RegistrarToVoter_Certificate_Message::deserialize(
 /**
  * serialize Vote_Struct.
  */
-void Vote_Struct::serialize(std::vector<unsigned char> &data) {
+void Vote_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::Vote_Struct);
+  put_message_type(MessageType::Vote_Struct, this->format_version, data);
 
   // Add fields.
-  put_integer(this->a, data);
-  put_integer(this->b, data);
+  put_integer(this->a, data, this->format_version);
+  put_integer(this->b, data, this->format_version);
 }
 
 /**
  * deserialize Vote_Struct.
  */
-int Vote_Struct::deserialize(std::vector<unsigned char> &data) {
+int Vote_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::Vote_Struct);
+  assert(get_message_type(data) == MessageType::Vote_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
-  n += get_integer(&this->a, data, n);
-  n += get_integer(&this->b, data, n);
+  n += get_integer(&this->a, data, n, this->format_version);
+  n += get_integer(&this->b, data, n, this->format_version);
   return n;
 }
 
+/**
+ * serialized_size Vote_Struct.
+ */
+size_t Vote_Struct::serialized_size() const {
+  return 1 + size_of_integer(this->a, this->format_version) +
+         size_of_integer(this->b, this->format_version);
+}
+
 /**
  * serialize Votes_Struct.
  */
-void Votes_Struct::serialize(std::vector<unsigned char> &data) {
+void Votes_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::Votes_Struct);
+  put_message_type(MessageType::Votes_Struct, this->format_version, data);
 
   size_t num_votes = this->votes.size();
-  add_size_param(data, num_votes);
+  put_size(num_votes, data, this->format_version);
 
   for (auto &vote : this->votes) {
-    std::vector<unsigned char> vote_data;
-    vote.serialize(vote_data);
-    data.insert(data.end(), vote_data.begin(), vote_data.end());
+    vote.serialize(data);
   }
 }
 
 /**
  * deserialize Votes_Struct.
  */
-int Votes_Struct::deserialize(std::vector<unsigned char> &data) {
+int Votes_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::Votes_Struct);
+  assert(get_message_type(data) == MessageType::Votes_Struct);
+  this->format_version = get_message_version(data);
 
   int n = 1;
 
   // Get fields.
   size_t num_votes;
-  std::memcpy(&num_votes, &data[n], sizeof(size_t));
-  n += sizeof(size_t);
+  n += get_size(&num_votes, data, n, this->format_version);
 
   std::vector<Vote_Struct> votes;
   for (int i=0; i<num_votes; i++) {
     Vote_Struct vote;
-    std::vector<unsigned char> vote_data = 
-      std::vector<unsigned char>(data.begin() + n, data.end());
-    
-    n += vote.deserialize(vote_data);
-    votes.push_back(vote);
+    n += vote.deserialize(data.subspan(n));
+    votes.push_back(std::move(vote));
   }
-  this->votes = votes;
+  this->votes = std::move(votes);
 
   return n;
 }
 
+/**
+ * serialized_size Votes_Struct.
+ */
+size_t Votes_Struct::serialized_size() const {
+  size_t size = 1 + size_of_size(this->votes.size(), this->format_version);
+  for (auto &vote : this->votes) {
+    size += vote.serialized_size();
+  }
+  return size;
+}
+
 
 /**
  * serialize VoteZKP_Struct.
  */
-void VoteZKP_Struct::serialize(std::vector<unsigned char> &data) {
-  // Add message type.
-  data.push_back((char)MessageType::VoteZKP_Struct);
+void VoteZKP_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
 
-  // Add fields.
-  put_integer(this->a0, data);
-  put_integer(this->a1, data);
-  put_integer(this->b0, data);
-  put_integer(this->b1, data);
-  put_integer(this->c0, data);
-  put_integer(this->c1, data);
-  put_integer(this->r0, data);
-  put_integer(this->r1, data);
+  // Add message type.
+  put_message_type(MessageType::VoteZKP_Struct, this->format_version, data);
+
+  // Add fields; a compact proof leaves out the commitments.
+  if (this->format_version < 3) {
+    put_integer(this->a0, data, this->format_version);
+    put_integer(this->a1, data, this->format_version);
+    put_integer(this->b0, data, this->format_version);
+    put_integer(this->b1, data, this->format_version);
+  }
+  put_integer(this->c0, data, this->format_version);
+  put_integer(this->c1, data, this->format_version);
+  put_integer(this->r0, data, this->format_version);
+  put_integer(this->r1, data, this->format_version);
 }
 
 /**
  * deserialize VoteZKP_Struct.
  */
-int VoteZKP_Struct::deserialize(std::vector<unsigned char> &data) {
+int VoteZKP_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::VoteZKP_Struct);
+  assert(get_message_type(data) == MessageType::VoteZKP_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
-  n += get_integer(&this->a0, data, n);
-  n += get_integer(&this->a1, data, n);
-  n += get_integer(&this->b0, data, n);
-  n += get_integer(&this->b1, data, n);
-  n += get_integer(&this->c0, data, n);
-  n += get_integer(&this->c1, data, n);
-  n += get_integer(&this->r0, data, n);
-  n += get_integer(&this->r1, data, n);
+  if (this->format_version < 3) {
+    n += get_integer(&this->a0, data, n, this->format_version);
+    n += get_integer(&this->a1, data, n, this->format_version);
+    n += get_integer(&this->b0, data, n, this->format_version);
+    n += get_integer(&this->b1, data, n, this->format_version);
+  }
+  n += get_integer(&this->c0, data, n, this->format_version);
+  n += get_integer(&this->c1, data, n, this->format_version);
+  n += get_integer(&this->r0, data, n, this->format_version);
+  n += get_integer(&this->r1, data, n, this->format_version);
   return n;
 }
 
+/**
+ * serialized_size VoteZKP_Struct.
+ */
+size_t VoteZKP_Struct::serialized_size() const {
+  size_t commitments = 0;
+  if (this->format_version < 3) {
+    commitments = size_of_integer(this->a0, this->format_version) +
+                  size_of_integer(this->a1, this->format_version) +
+                  size_of_integer(this->b0, this->format_version) +
+                  size_of_integer(this->b1, this->format_version);
+  }
+  return 1 + commitments + size_of_integer(this->c0, this->format_version) +
+         size_of_integer(this->c1, this->format_version) +
+         size_of_integer(this->r0, this->format_version) +
+         size_of_integer(this->r1, this->format_version);
+}
+
 /**
  * serialize VoteZKPs_Struct.
  */
-void VoteZKPs_Struct::serialize(std::vector<unsigned char> &data) {
+void VoteZKPs_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::VoteZKPs_Struct);
+  put_message_type(MessageType::VoteZKPs_Struct, this->format_version, data);
 
   // Add fields.
   size_t num_zkps = this->zkps.size();
-  add_size_param(data, num_zkps);
+  put_size(num_zkps, data, this->format_version);
 
   for (auto &zkp: this->zkps) {
-    std::vector<unsigned char> zkp_data;
-    zkp.serialize(zkp_data);
-    data.insert(data.end(), zkp_data.begin(), zkp_data.end());
+    zkp.serialize(data);
   }
 }
 
 /**
  * deserialize VoteZKPs_Struct.
  */
-int VoteZKPs_Struct::deserialize(std::vector<unsigned char> &data) {
+int VoteZKPs_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::VoteZKPs_Struct);
+  assert(get_message_type(data) == MessageType::VoteZKPs_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
 
   size_t num_zkps;
-  std::memcpy(&num_zkps, &data[n], sizeof(size_t));
-  n += sizeof(size_t);
+  n += get_size(&num_zkps, data, n, this->format_version);
 
   std::vector<VoteZKP_Struct> zkps;
   for (int i=0; i<num_zkps; i++) {
     VoteZKP_Struct zkp;
-    std::vector<unsigned char> zkp_data =
-      std::vector<unsigned char>(data.begin() + n, data.end());
-    
-    n += zkp.deserialize(zkp_data);
-    zkps.push_back(zkp);
+    n += zkp.deserialize(data.subspan(n));
+    zkps.push_back(std::move(zkp));
   }
-  this->zkps = zkps;
+  this->zkps = std::move(zkps);
 
   return n;
 }
 
-void Count_ZKP_Struct::serialize(std::vector<unsigned char> &data) {
-  data.push_back((char)MessageType::Count_ZKP_Struct);
+/**
+ * serialized_size VoteZKPs_Struct.
+ */
+size_t VoteZKPs_Struct::serialized_size() const {
+  size_t size = 1 + size_of_size(this->zkps.size(), this->format_version);
+  for (auto &zkp : this->zkps) {
+    size += zkp.serialized_size();
+  }
+  return size;
+}
+
+void Count_ZKP_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
 
-  put_integer(this->a_i, data);
-  put_integer(this->b_i, data);
-  put_integer(this->c_i, data);
-  put_integer(this->r_i, data);
+  put_message_type(MessageType::Count_ZKP_Struct, this->format_version, data);
+
+  if (this->format_version < 3) {
+    put_integer(this->a_i, data, this->format_version);
+    put_integer(this->b_i, data, this->format_version);
+  }
+  put_integer(this->c_i, data, this->format_version);
+  put_integer(this->r_i, data, this->format_version);
 }
 
-int Count_ZKP_Struct::deserialize(std::vector<unsigned char> &data) {
-  assert(data[0] == MessageType::Count_ZKP_Struct);
+int Count_ZKP_Struct::deserialize(std::span<const unsigned char> data) {
+  assert(get_message_type(data) == MessageType::Count_ZKP_Struct);
+  this->format_version = get_message_version(data);
 
   int n = 1;
-  n += get_integer(&this->a_i, data, n);
-  n += get_integer(&this->b_i, data, n);
-  n += get_integer(&this->c_i, data, n);
-  n += get_integer(&this->r_i, data, n);
+  if (this->format_version < 3) {
+    n += get_integer(&this->a_i, data, n, this->format_version);
+    n += get_integer(&this->b_i, data, n, this->format_version);
+  }
+  n += get_integer(&this->c_i, data, n, this->format_version);
+  n += get_integer(&this->r_i, data, n, this->format_version);
   return n;
 }
 
-void Count_ZKPs_Struct::serialize(std::vector<unsigned char> &data) {
-  data.push_back((char)MessageType::Count_ZKPs_Struct);
+/**
+ * serialized_size Count_ZKP_Struct.
+ */
+size_t Count_ZKP_Struct::serialized_size() const {
+  size_t commitments = 0;
+  if (this->format_version < 3) {
+    commitments = size_of_integer(this->a_i, this->format_version) +
+                  size_of_integer(this->b_i, this->format_version);
+  }
+  return 1 + commitments + size_of_integer(this->c_i, this->format_version) +
+         size_of_integer(this->r_i, this->format_version);
+}
+
+void Count_ZKPs_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
+  put_message_type(MessageType::Count_ZKPs_Struct, this->format_version, data);
 
   size_t num_count_zkps = this->count_zkps.size();
-  add_size_param(data, num_count_zkps);
+  put_size(num_count_zkps, data, this->format_version);
 
   for (auto &count_zkp : this->count_zkps) {
-    std::vector<unsigned char> zkp_data;
-    count_zkp.serialize(zkp_data);
-    data.insert(data.end(), zkp_data.begin(), zkp_data.end());
+    count_zkp.serialize(data);
   }
 }
 
-int Count_ZKPs_Struct::deserialize(std::vector<unsigned char> &data) {
-  assert(data[0] == MessageType::Count_ZKPs_Struct);
+int Count_ZKPs_Struct::deserialize(std::span<const unsigned char> data) {
+  assert(get_message_type(data) == MessageType::Count_ZKPs_Struct);
+  this->format_version = get_message_version(data);
 
   int n = 1;
 
   size_t num_count_zkps;
-  std::memcpy(&num_count_zkps, &data[n], sizeof(size_t));
-  n += sizeof(size_t);
+  n += get_size(&num_count_zkps, data, n, this->format_version);
 
   std::vector<Count_ZKP_Struct> count_zkps;
   for (int i=0; i<num_count_zkps; i++) {
     Count_ZKP_Struct zkp;
-    std::vector<unsigned char> zkp_data = 
-      std::vector<unsigned char>(data.begin() + n, data.end());
-    
-    n += zkp.deserialize(zkp_data);
-    count_zkps.push_back(zkp);
+    n += zkp.deserialize(data.subspan(n));
+    count_zkps.push_back(std::move(zkp));
   }
-  this->count_zkps = count_zkps;
+  this->count_zkps = std::move(count_zkps);
   
   return n;
 }
 
+/**
+ * serialized_size Count_ZKPs_Struct.
+ */
+size_t Count_ZKPs_Struct::serialized_size() const {
+  size_t size = 1 + size_of_size(this->count_zkps.size(), this->format_version);
+  for (auto &count_zkp : this->count_zkps) {
+    size += count_zkp.serialized_size();
+  }
+  return size;
+}
+
 /**
  * serialize VoterToTallyer_Vote_Message.
  */
-void VoterToTallyer_Vote_Message::serialize(std::vector<unsigned char> &data) {
+void VoterToTallyer_Vote_Message::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::VoterToTallyer_Vote_Message);
+  put_message_type(MessageType::VoterToTallyer_Vote_Message, this->format_version, data);
 
   // Add fields.
-  std::vector<unsigned char> cert_data;
-  this->cert.serialize(cert_data);
-  data.insert(data.end(), cert_data.begin(), cert_data.end());
-
-  std::vector<unsigned char> votes_data;
-  this->votes.serialize(votes_data);
-  data.insert(data.end(), votes_data.begin(), votes_data.end());
+  this->cert.serialize(data);
+  this->votes.serialize(data);
+  this->zkps.serialize(data);
+  this->count_zkps.serialize(data);
 
-  std::vector<unsigned char> zkps_data;
-  this->zkps.serialize(zkps_data);
-  data.insert(data.end(), zkps_data.begin(), zkps_data.end());
-
-  std::vector<unsigned char> vote_count_data;
-  this->vote_count.serialize(vote_count_data);
-  data.insert(data.end(), vote_count_data.begin(), vote_count_data.end());
-
-  std::vector<unsigned char> count_zkps_data;
-  this->count_zkps.serialize(count_zkps_data);
-  data.insert(data.end(), count_zkps_data.begin(), count_zkps_data.end());
-  
-  put_string(this->voter_signature, data);
+  put_string(this->voter_signature, data, this->format_version);
 }
 
 /**
  * deserialize VoterToTallyer_Vote_Message.
  */
-int VoterToTallyer_Vote_Message::deserialize(std::vector<unsigned char> &data) {
+int VoterToTallyer_Vote_Message::deserialize(
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::VoterToTallyer_Vote_Message);
+  assert(get_message_type(data) == MessageType::VoterToTallyer_Vote_Message);
 
-  // Get fields.
+  // Written back in the current version, as a version 1 ballot also
+  // carried its vote count, which is now recomputed from its votes.
+  int version = get_message_version(data);
+
+  // Get fields, keeping where the ballot's lists lie so they can be
+  // signed and stored without serializing them again.
   int n = 1;
 
-  std::vector<unsigned char> cert_data =
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->cert.deserialize(cert_data);
+  n += this->cert.deserialize(data.subspan(n));
 
-  std::vector<unsigned char> votes_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->votes.deserialize(votes_data);
+  int start = n;
+  n += this->votes.deserialize(data.subspan(n));
+  this->votes_data = data.subspan(start, n - start);
 
-  std::vector<unsigned char> zkps_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->zkps.deserialize(zkps_data);
+  start = n;
+  n += this->zkps.deserialize(data.subspan(n));
+  this->zkps_data = data.subspan(start, n - start);
 
-  std::vector<unsigned char> vote_count_data =
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->vote_count.deserialize(vote_count_data);
+  if (version == 1) {
+    Vote_Struct vote_count;
+    n += vote_count.deserialize(data.subspan(n));
+  }
 
-  std::vector<unsigned char> count_zkps_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->count_zkps.deserialize(count_zkps_data);
+  start = n;
+  n += this->count_zkps.deserialize(data.subspan(n));
+  this->count_zkps_data = data.subspan(start, n - start);
 
-  n += get_string(&this->voter_signature, data, n);
+  n += get_string(&this->voter_signature, data, n, version);
   return n;
 }
 
+/**
+ * serialized_size VoterToTallyer_Vote_Message.
+ */
+size_t VoterToTallyer_Vote_Message::serialized_size() const {
+  return 1 + this->cert.serialized_size() +
+         this->votes.serialized_size() +
+         this->zkps.serialized_size() +
+         this->count_zkps.serialized_size() +
+         size_of_string(this->voter_signature.size(), this->format_version);
+}
+
 /**
  * serialize TallyerToWorld_Vote_Message.
  */
-void TallyerToWorld_Vote_Message::serialize(std::vector<unsigned char> &data) {
+void TallyerToWorld_Vote_Message::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::TallyerToWorld_Vote_Message);
+  put_message_type(MessageType::TallyerToWorld_Vote_Message, this->format_version, data);
 
   // Add fields.
-  std::vector<unsigned char> votes_data;
-  this->votes.serialize(votes_data);
-  data.insert(data.end(), votes_data.begin(), votes_data.end());
-
-  std::vector<unsigned char> zkps_data;
-  this->zkps.serialize(zkps_data);
-  data.insert(data.end(), zkps_data.begin(), zkps_data.end());
+  this->votes.serialize(data);
+  this->zkps.serialize(data);
+  this->count_zkps.serialize(data);
 
-  std::vector<unsigned char> vote_count_data;
-  this->vote_count.serialize(vote_count_data);
-  data.insert(data.end(), vote_count_data.begin(), vote_count_data.end());
-
-  std::vector<unsigned char> count_zkps_data;
-  this->count_zkps.serialize(count_zkps_data);
-  data.insert(data.end(), count_zkps_data.begin(), count_zkps_data.end());
-
-  put_string(this->tallyer_signature, data);
+  put_string(this->tallyer_signature, data, this->format_version);
 }
 
 /**
  * deserialize TallyerToWorld_Vote_Message.
  */
-int TallyerToWorld_Vote_Message::deserialize(std::vector<unsigned char> &data) {
+int TallyerToWorld_Vote_Message::deserialize(
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::TallyerToWorld_Vote_Message);
+  assert(get_message_type(data) == MessageType::TallyerToWorld_Vote_Message);
+
+  // Written back in the current version, as a version 1 ballot also
+  // carried its vote count, which is now recomputed from its votes.
+  int version = get_message_version(data);
 
   // Get fields.
   int n = 1;
-  std::vector<unsigned char> votes_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->votes.deserialize(votes_data);
+  n += this->votes.deserialize(data.subspan(n));
+
+  n += this->zkps.deserialize(data.subspan(n));
+
+  if (version == 1) {
+    Vote_Struct vote_count;
+    n += vote_count.deserialize(data.subspan(n));
+  }
+
+  n += this->count_zkps.deserialize(data.subspan(n));
+
+  n += get_string(&this->tallyer_signature, data, n, version);
+  return n;
+}
 
-  std::vector<unsigned char> zkps_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->zkps.deserialize(zkps_data);
+/**
+ * serialized_size TallyerToWorld_Vote_Message.
+ */
+size_t TallyerToWorld_Vote_Message::serialized_size() const {
+  return 1 + this->votes.serialized_size() +
+         this->zkps.serialized_size() +
+         this->count_zkps.serialized_size() +
+         size_of_string(this->tallyer_signature.size(), this->format_version);
+}
 
-  std::vector<unsigned char> vote_count_data =
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->vote_count.deserialize(vote_count_data);
+/**
+ * serialize TallyerToWorld_Aggregate_Message.
+ */
+void TallyerToWorld_Aggregate_Message::serialize(
+    std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
 
-  std::vector<unsigned char> count_zkps_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->count_zkps.deserialize(count_zkps_data);
+  // Add message type.
+  put_message_type(MessageType::TallyerToWorld_Aggregate_Message, this->format_version, data);
 
-  n += get_string(&this->tallyer_signature, data, n);
+  // Add fields.
+  this->votes.serialize(data);
+
+  put_integer(this->ballot_count, data, this->format_version);
+  put_integer(this->last_row_id, data, this->format_version);
+  put_string(this->tallyer_signature, data, this->format_version);
+}
+
+/**
+ * deserialize TallyerToWorld_Aggregate_Message.
+ */
+int TallyerToWorld_Aggregate_Message::deserialize(
+    std::span<const unsigned char> data) {
+  // Check correct message type.
+  assert(get_message_type(data) == MessageType::TallyerToWorld_Aggregate_Message);
+  this->format_version = get_message_version(data);
+
+  // Get fields.
+  int n = 1;
+  n += this->votes.deserialize(data.subspan(n));
+
+  n += get_integer(&this->ballot_count, data, n, this->format_version);
+  n += get_integer(&this->last_row_id, data, n, this->format_version);
+  n += get_string(&this->tallyer_signature, data, n, this->format_version);
   return n;
 }
 
+/**
+ * serialized_size TallyerToWorld_Aggregate_Message.
+ */
+size_t TallyerToWorld_Aggregate_Message::serialized_size() const {
+  return 1 + this->votes.serialized_size() +
+         size_of_integer(this->ballot_count, this->format_version) +
+         size_of_integer(this->last_row_id, this->format_version) +
+         size_of_string(this->tallyer_signature.size(), this->format_version);
+}
+
 // ================================================
 // ARBITER <==> WORLD
 // ================================================
@@ -627,201 +1106,258 @@ int TallyerToWorld_Vote_Message::deserialize(std::vector<unsigned char> &data) {
 /**
  * serialize PartialDecryption_Struct.
  */
-void PartialDecryption_Struct::serialize(std::vector<unsigned char> &data) {
+void PartialDecryption_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::PartialDecryption_Struct);
+  put_message_type(MessageType::PartialDecryption_Struct, this->format_version, data);
 
   // Add fields.
-  put_integer(this->d, data);
-  std::vector<unsigned char> aggregate_ciphertext_data;
-  this->aggregate_ciphertext.serialize(aggregate_ciphertext_data);
-  data.insert(data.end(), aggregate_ciphertext_data.begin(),
-              aggregate_ciphertext_data.end());
+  put_integer(this->d, data, this->format_version);
+  this->aggregate_ciphertext.serialize(data);
 }
 
 /**
  * deserialize PartialDecryption_Struct.
  */
-int PartialDecryption_Struct::deserialize(std::vector<unsigned char> &data) {
+int PartialDecryption_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::PartialDecryption_Struct);
+  assert(get_message_type(data) == MessageType::PartialDecryption_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
-  n += get_integer(&this->d, data, n);
-  std::vector<unsigned char> aggregate_ciphertext_slice =
-      std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->aggregate_ciphertext.deserialize(aggregate_ciphertext_slice);
+  n += get_integer(&this->d, data, n, this->format_version);
+  n += this->aggregate_ciphertext.deserialize(data.subspan(n));
   return n;
 }
 
+/**
+ * serialized_size PartialDecryption_Struct.
+ */
+size_t PartialDecryption_Struct::serialized_size() const {
+  return 1 + size_of_integer(this->d, this->format_version) +
+         this->aggregate_ciphertext.serialized_size();
+}
+
 /**
  * serialize PartialDecryptions_Struct.
  */
-void PartialDecryptions_Struct::serialize(std::vector<unsigned char> &data) {
+void PartialDecryptions_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::PartialDecryptions_Struct);
+  put_message_type(MessageType::PartialDecryptions_Struct, this->format_version, data);
 
   // Add fields.
   size_t num_decs = this->decs.size();
-  add_size_param(data, num_decs);
+  put_size(num_decs, data, this->format_version);
 
   for (auto &dec : decs) {
-    std::vector<unsigned char> dec_data;
-    dec.serialize(dec_data);
-    data.insert(data.end(), dec_data.begin(), dec_data.end());
+    dec.serialize(data);
   }
 }
 
 /**
  * deserialize PartialDecryptions_Struct.
  */
-int PartialDecryptions_Struct::deserialize(std::vector<unsigned char> &data) {
+int PartialDecryptions_Struct::deserialize(
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::PartialDecryptions_Struct);
+  assert(get_message_type(data) == MessageType::PartialDecryptions_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
 
   size_t num_decs;
-  std::memcpy(&num_decs, &data[n], sizeof(size_t));
-  n += sizeof(size_t);
+  n += get_size(&num_decs, data, n, this->format_version);
 
   std::vector<PartialDecryption_Struct> decs;
   for (int i=0; i<num_decs; i++) {
     PartialDecryption_Struct dec;
-    std::vector<unsigned char> dec_data = 
-      std::vector<unsigned char>(data.begin() + n, data.end());
-    
-    n += dec.deserialize(dec_data);
-    decs.push_back(dec);
+    n += dec.deserialize(data.subspan(n));
+    decs.push_back(std::move(dec));
   }
-  this->decs = decs;
+  this->decs = std::move(decs);
 
   return n;
 }
 
+/**
+ * serialized_size PartialDecryptions_Struct.
+ */
+size_t PartialDecryptions_Struct::serialized_size() const {
+  size_t size = 1 + size_of_size(this->decs.size(), this->format_version);
+  for (auto &dec : this->decs) {
+    size += dec.serialized_size();
+  }
+  return size;
+}
+
 /**
  * serialize DecryptionZKP_Struct.
  */
-void DecryptionZKP_Struct::serialize(std::vector<unsigned char> &data) {
+void DecryptionZKP_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::DecryptionZKP_Struct);
+  put_message_type(MessageType::DecryptionZKP_Struct, this->format_version, data);
 
   // Add fields.
-  put_integer(this->u, data);
-  put_integer(this->v, data);
-  put_integer(this->s, data);
+  if (this->format_version < 3) {
+    put_integer(this->u, data, this->format_version);
+    put_integer(this->v, data, this->format_version);
+  } else {
+    put_integer(this->sigma, data, this->format_version);
+  }
+  put_integer(this->s, data, this->format_version);
 }
 
 /**
  * deserialize DecryptionZKP_Struct.
  */
-int DecryptionZKP_Struct::deserialize(std::vector<unsigned char> &data) {
+int DecryptionZKP_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::DecryptionZKP_Struct);
+  assert(get_message_type(data) == MessageType::DecryptionZKP_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
-  n += get_integer(&this->u, data, n);
-  n += get_integer(&this->v, data, n);
-  n += get_integer(&this->s, data, n);
+  if (this->format_version < 3) {
+    n += get_integer(&this->u, data, n, this->format_version);
+    n += get_integer(&this->v, data, n, this->format_version);
+  } else {
+    n += get_integer(&this->sigma, data, n, this->format_version);
+  }
+  n += get_integer(&this->s, data, n, this->format_version);
   return n;
 }
 
+/**
+ * serialized_size DecryptionZKP_Struct.
+ */
+size_t DecryptionZKP_Struct::serialized_size() const {
+  size_t size = 1 + size_of_integer(this->s, this->format_version);
+  if (this->format_version < 3) {
+    size += size_of_integer(this->u, this->format_version) +
+            size_of_integer(this->v, this->format_version);
+  } else {
+    size += size_of_integer(this->sigma, this->format_version);
+  }
+  return size;
+}
+
 /**
  * serialize DecryptionZKPs_Struct.
  */
-void DecryptionZKPs_Struct::serialize(std::vector<unsigned char> &data) {
+void DecryptionZKPs_Struct::serialize(std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::DecryptionZKPs_Struct);
+  put_message_type(MessageType::DecryptionZKPs_Struct, this->format_version, data);
 
   // Add fields.
   size_t num_zkps = this->zkps.size();
-  add_size_param(data, num_zkps);
+  put_size(num_zkps, data, this->format_version);
 
   for (auto &zkp : zkps) {
-    std::vector<unsigned char> zkp_data;
-    zkp.serialize(zkp_data);
-    data.insert(data.end(), zkp_data.begin(), zkp_data.end());
+    zkp.serialize(data);
   }
 }
 
 /**
  * deserialize DecryptionZKPs_Struct.
  */
-int DecryptionZKPs_Struct::deserialize(std::vector<unsigned char> &data) {
+int DecryptionZKPs_Struct::deserialize(std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::DecryptionZKPs_Struct);
+  assert(get_message_type(data) == MessageType::DecryptionZKPs_Struct);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
 
   size_t num_zkps;
-  std::memcpy(&num_zkps, &data[n], sizeof(size_t));
-  n += sizeof(size_t);
+  n += get_size(&num_zkps, data, n, this->format_version);
 
   std::vector<DecryptionZKP_Struct> zkps;
   for (int i=0; i<num_zkps; i++) {
     DecryptionZKP_Struct zkp;
-    std::vector<unsigned char> zkp_data = 
-      std::vector<unsigned char>(data.begin() + n, data.end());
-    
-    n += zkp.deserialize(zkp_data);
-    zkps.push_back(zkp);
+    n += zkp.deserialize(data.subspan(n));
+    zkps.push_back(std::move(zkp));
   }
-  this->zkps = zkps;
+  this->zkps = std::move(zkps);
 
   return n;
 }
 
+/**
+ * serialized_size DecryptionZKPs_Struct.
+ */
+size_t DecryptionZKPs_Struct::serialized_size() const {
+  size_t size = 1 + size_of_size(this->zkps.size(), this->format_version);
+  for (auto &zkp : this->zkps) {
+    size += zkp.serialized_size();
+  }
+  return size;
+}
+
 /**
  * serialize ArbiterToWorld_PartialDecryption_Message.
  */
 void ArbiterToWorld_PartialDecryption_Message::serialize(
-    std::vector<unsigned char> &data) {
+    std::vector<unsigned char> &data) const {
+  // Size the buffer once.
+  reserve_serialized(*this, data);
+
   // Add message type.
-  data.push_back((char)MessageType::ArbiterToWorld_PartialDecryption_Message);
+  put_message_type(MessageType::ArbiterToWorld_PartialDecryption_Message, this->format_version, data);
 
   // Add fields.
-  put_string(this->arbiter_id, data);
-
-  put_string(this->arbiter_vk_path, data);
+  put_string(this->arbiter_id, data, this->format_version);
 
-  std::vector<unsigned char> decs_data;
-  this->decs.serialize(decs_data);
-  data.insert(data.end(), decs_data.begin(), decs_data.end());
+  put_string(this->arbiter_vk_path, data, this->format_version);
 
-  std::vector<unsigned char> zkps_data;
-  this->zkps.serialize(zkps_data);
-  data.insert(data.end(), zkps_data.begin(), zkps_data.end());
+  this->decs.serialize(data);
+  this->zkps.serialize(data);
 }
 
 /**
  * deserialize ArbiterToWorld_PartialDecryption_Message.
  */
 int ArbiterToWorld_PartialDecryption_Message::deserialize(
-    std::vector<unsigned char> &data) {
+    std::span<const unsigned char> data) {
   // Check correct message type.
-  assert(data[0] == MessageType::ArbiterToWorld_PartialDecryption_Message);
+  assert(get_message_type(data) == MessageType::ArbiterToWorld_PartialDecryption_Message);
+  this->format_version = get_message_version(data);
 
   // Get fields.
   int n = 1;
-  n += get_string(&this->arbiter_id, data, n);
+  n += get_string(&this->arbiter_id, data, n, this->format_version);
 
-  n += get_string(&this->arbiter_vk_path, data, n);
+  n += get_string(&this->arbiter_vk_path, data, n, this->format_version);
 
-  std::vector<unsigned char> decs_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->decs.deserialize(decs_data);
+  n += this->decs.deserialize(data.subspan(n));
 
-  std::vector<unsigned char> zkps_data = 
-    std::vector<unsigned char>(data.begin() + n, data.end());
-  n += this->zkps.deserialize(zkps_data);
+  n += this->zkps.deserialize(data.subspan(n));
 
   return n;
 }
 
+/**
+ * serialized_size ArbiterToWorld_PartialDecryption_Message.
+ */
+size_t ArbiterToWorld_PartialDecryption_Message::serialized_size() const {
+  return 1 + size_of_string(this->arbiter_id.size(), this->format_version) +
+         size_of_string(this->arbiter_vk_path.size(), this->format_version) +
+         this->decs.serialized_size() +
+         this->zkps.serialized_size();
+}
+
 // ================================================
 // SIGNING HELPERS
 // ================================================
@@ -830,7 +1366,8 @@ int ArbiterToWorld_PartialDecryption_Message::deserialize(
  * Concatenate a string and a DSA public key into vector of unsigned char
  */
 std::vector<unsigned char>
-concat_string_and_dsakey(std::string &s, CryptoPP::DSA::PublicKey &k) {
+concat_string_and_dsakey(const std::string &s,
+                         const CryptoPP::DSA::PublicKey &k) {
   // Concat s to vec
   std::vector<unsigned char> v;
   v.insert(v.end(), s.begin(), s.end());
@@ -846,16 +1383,13 @@ concat_string_and_dsakey(std::string &s, CryptoPP::DSA::PublicKey &k) {
 /**
  * Concatenate two byteblocks into vector of unsigned char
  */
-std::vector<unsigned char> concat_byteblocks(CryptoPP::SecByteBlock &b1,
-                                             CryptoPP::SecByteBlock &b2) {
-  // Convert byteblocks to strings
-  std::string b1_str = byteblock_to_string(b1);
-  std::string b2_str = byteblock_to_string(b2);
-
-  // Concat strings to vec
+std::vector<unsigned char> concat_byteblocks(const CryptoPP::SecByteBlock &b1,
+                                             const CryptoPP::SecByteBlock &b2) {
+  // Concat byteblocks to vec
   std::vector<unsigned char> v;
-  v.insert(v.end(), b1_str.begin(), b1_str.end());
-  v.insert(v.end(), b2_str.begin(), b2_str.end());
+  v.reserve(b1.size() + b2.size());
+  v.insert(v.end(), b1.begin(), b1.end());
+  v.insert(v.end(), b2.begin(), b2.end());
   return v;
 }
 
@@ -863,43 +1397,49 @@ std::vector<unsigned char> concat_byteblocks(CryptoPP::SecByteBlock &b1,
  * Concatenate a byteblock and certificate into vector of unsigned char
  */
 std::vector<unsigned char>
-concat_byteblock_and_cert(CryptoPP::SecByteBlock &b,
-                          RegistrarToVoter_Certificate_Message &cert) {
-  // Convert byteblock to strings, serialize cert
-  std::string b_str = byteblock_to_string(b);
-
-  std::vector<unsigned char> cert_data;
-  cert.serialize(cert_data);
-
-  // Concat string and data to vec.
+concat_byteblock_and_cert(const CryptoPP::SecByteBlock &b,
+                          const RegistrarToVoter_Certificate_Message &cert) {
+  // Concat byteblock and cert to vec.
   std::vector<unsigned char> v;
-  v.insert(v.end(), b_str.begin(), b_str.end());
-  v.insert(v.end(), cert_data.begin(), cert_data.end());
+  v.reserve(b.size() + cert.serialized_size());
+  v.insert(v.end(), b.begin(), b.end());
+  cert.serialize(v);
   return v;
 }
 
 /**
  * Concatenate a vote and zkp into vector of unsigned char
  */
-std::vector<unsigned char> concat_votes_and_zkps(Votes_Struct &votes,
-                                               VoteZKPs_Struct &zkps,
-                                               Vote_Struct &vote_count,
-                                               Count_ZKPs_Struct &count_zkps) {
-  // Serialize vote and zkp.
-  std::vector<unsigned char> votes_data;
-  votes.serialize(votes_data);
-  std::vector<unsigned char> zkps_data;
-  zkps.serialize(zkps_data);
-  std::vector<unsigned char> vote_count_data;
-  vote_count.serialize(vote_count_data);
-  std::vector<unsigned char> count_zkps_data;
-  count_zkps.serialize(count_zkps_data);
-
-  // Concat data to vec.
+std::vector<unsigned char>
+concat_votes_and_zkps(const Votes_Struct &votes, const VoteZKPs_Struct &zkps,
+                      const Vote_Struct &vote_count,
+                      const Count_ZKPs_Struct &count_zkps) {
+  // Serialize votes and zkps into one buffer.
+  std::vector<unsigned char> v;
+  v.reserve(votes.serialized_size() + zkps.serialized_size() +
+            vote_count.serialized_size() + count_zkps.serialized_size());
+  votes.serialize(v);
+  zkps.serialize(v);
+  vote_count.serialize(v);
+  count_zkps.serialize(v);
+  return v;
+}
+
+/**
+ * Concatenate votes, a ballot count and the last vote's rowid into vector of
+ * unsigned char, the integers in the same format version as the votes
+ */
+std::vector<unsigned char>
+concat_votes_and_count(const Votes_Struct &votes,
+                       const CryptoPP::Integer &count,
+                       const CryptoPP::Integer &last_row_id) {
+  // Serialize votes, count and rowid into one buffer.
   std::vector<unsigned char> v;
-  v.insert(v.end(), votes_data.begin(), votes_data.end());
-  v.insert(v.end(), zkps_data.begin(), zkps_data.end());
-  v.insert(v.end(), vote_count_data.begin(), vote_count_data.end());
-  v.insert(v.end(), count_zkps_data.begin(), count_zkps_data.end());
+  v.reserve(votes.serialized_size() +
+            size_of_integer(count, votes.format_version) +
+            size_of_integer(last_row_id, votes.format_version));
+  votes.serialize(v);
+  put_integer(count, v, votes.format_version);
+  put_integer(last_row_id, v, votes.format_version);
   return v;
-}
\ No newline at end of file
+}
@@ -0,0 +1,117 @@
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#include <crypto++/osrng.h>
+#include <crypto++/sha.h>
+
+#include "../include-shared/rng.hpp"
+
+namespace {
+const size_t KEY_LENGTH = 32; // AES-256
+const size_t SEED_LENGTH = KEY_LENGTH + CryptoPP::AES::BLOCKSIZE;
+
+// Bumped on every change to the deterministic seed; 0 means none is set.
+std::atomic<unsigned long> deterministic_epoch{0};
+unsigned long next_epoch = 0;
+std::string deterministic_seed;
+std::mutex deterministic_mtx;
+
+// Index of the next generator created, so every thread's deterministic
+// stream differs.
+std::atomic<unsigned long> next_stream{0};
+} // namespace
+
+SecureRNG::SecureRNG()
+    : bytes_since_reseed(0), seed_epoch(0), stream(next_stream++) {
+  this->Reseed();
+}
+
+/**
+ * Key the cipher from the OS, or from the deterministic seed and this
+ * generator's stream index if a seed is set.
+ */
+void SecureRNG::Reseed() {
+  CryptoPP::SecByteBlock seed(SEED_LENGTH);
+  std::unique_lock<std::mutex> lock(deterministic_mtx);
+  this->seed_epoch = deterministic_epoch.load();
+  if (this->seed_epoch != 0) {
+    // SHA-256 twice, with distinct prefixes, for key and counter
+    std::string stream_prefix = std::to_string(this->stream) + ":";
+    std::string key_input = "key" + stream_prefix + deterministic_seed;
+    std::string iv_input = "iv" + stream_prefix + deterministic_seed;
+    CryptoPP::SecByteBlock digest(CryptoPP::SHA256::DIGESTSIZE);
+    CryptoPP::SHA256().CalculateDigest(
+        seed.BytePtr(), (const CryptoPP::byte *)key_input.data(),
+        key_input.size());
+    CryptoPP::SHA256().CalculateDigest(
+        digest.BytePtr(), (const CryptoPP::byte *)iv_input.data(),
+        iv_input.size());
+    std::memcpy(seed.BytePtr() + KEY_LENGTH, digest.BytePtr(),
+                CryptoPP::AES::BLOCKSIZE);
+  } else {
+    CryptoPP::OS_GenerateRandomBlock(false, seed.BytePtr(), seed.size());
+  }
+  lock.unlock();
+
+  this->Rekey(seed.BytePtr());
+  this->bytes_since_reseed = 0;
+}
+
+/**
+ * Replace the key and counter with the SEED_LENGTH bytes at seed.
+ */
+void SecureRNG::Rekey(const CryptoPP::byte *seed) {
+  this->cipher.SetKeyWithIV(seed, KEY_LENGTH, seed + KEY_LENGTH,
+                            CryptoPP::AES::BLOCKSIZE);
+}
+
+/**
+ * Fill output with keystream, then rekey from the keystream that follows.
+ */
+void SecureRNG::GenerateBlock(CryptoPP::byte *output, size_t size) {
+  unsigned long epoch = deterministic_epoch.load(std::memory_order_relaxed);
+  if (epoch != this->seed_epoch ||
+      (epoch == 0 && this->bytes_since_reseed >= RESEED_INTERVAL)) {
+    this->Reseed();
+  }
+
+  std::memset(output, 0, size);
+  this->cipher.ProcessData(output, output, size);
+
+  CryptoPP::SecByteBlock next(SEED_LENGTH);
+  std::memset(next.BytePtr(), 0, next.size());
+  this->cipher.ProcessData(next.BytePtr(), next.BytePtr(), next.size());
+  this->Rekey(next.BytePtr());
+  this->bytes_since_reseed += size;
+}
+
+std::string SecureRNG::AlgorithmName() const { return "AES-256/CTR DRBG"; }
+
+/**
+ * Returns this thread's generator, created on first use.
+ */
+CryptoPP::RandomNumberGenerator &ThreadRNG() {
+  thread_local SecureRNG rng;
+  return rng;
+}
+
+/**
+ * Derive every generator from seed and its stream index, including ones
+ * already created; each restarts from the same state for its index, so
+ * threads draw distinct streams. For tests only.
+ */
+void SetDeterministicRNGSeed(const std::string &seed) {
+  std::unique_lock<std::mutex> lock(deterministic_mtx);
+  deterministic_seed = seed;
+  deterministic_epoch.store(++next_epoch);
+}
+
+/**
+ * Return every generator to OS seeding.
+ */
+void ClearDeterministicRNGSeed() {
+  std::unique_lock<std::mutex> lock(deterministic_mtx);
+  deterministic_seed.clear();
+  deterministic_epoch.store(0);
+}
@@ -0,0 +1,70 @@
+#include "../include-shared/transcript.hpp"
+
+#include <stdexcept>
+
+/**
+ * Starts a transcript for one kind of proof in the named group.
+ */
+Transcript::Transcript(const std::string &proof, const std::string &group) {
+  const std::string domain = "online-voting/fiat-shamir";
+  this->hash.Update((const CryptoPP::byte *)domain.data(), domain.size());
+  this->hash.Update(&TRANSCRIPT_VERSION, 1);
+  for (const std::string *label : {&proof, &group}) {
+    this->AbsorbLength(label->size());
+    this->hash.Update((const CryptoPP::byte *)label->data(), label->size());
+  }
+}
+
+/**
+ * Absorbs a group element as its 256 big-endian bytes.
+ */
+void Transcript::Absorb(const UInt2048 &x) {
+  CryptoPP::byte bytes[UInt2048::BYTES];
+  x.Encode(bytes);
+  this->hash.Update(bytes, sizeof(bytes));
+}
+
+/**
+ * Absorbs a scalar as its 32 big-endian bytes.
+ */
+void Transcript::Absorb(const UInt256 &x) {
+  CryptoPP::byte bytes[UInt256::BYTES];
+  x.Encode(bytes);
+  this->hash.Update(bytes, sizeof(bytes));
+}
+
+/**
+ * Absorbs a non-negative Integer of any width, such as an unreduced election
+ * key, as its length and then its big-endian bytes.
+ */
+void Transcript::Absorb(const CryptoPP::Integer &x) {
+  if (x.IsNegative()) {
+    throw std::runtime_error("cannot absorb a negative integer");
+  }
+  CryptoPP::SecByteBlock bytes(x.MinEncodedSize());
+  x.Encode(bytes, bytes.size());
+  this->AbsorbLength(bytes.size());
+  this->hash.Update(bytes, bytes.size());
+}
+
+/**
+ * Finishes the hash. The digest is below 2^256, so below twice an order that
+ * fills its top limb, and one subtraction reduces it.
+ */
+UInt256 Transcript::Challenge(const UInt256 &order) {
+  CryptoPP::byte digest[CryptoPP::SHA256::DIGESTSIZE];
+  this->hash.Final(digest);
+  UInt256 challenge = UInt256::Decode(digest);
+  ReduceOnce(challenge, 0, order);
+  return challenge;
+}
+
+/**
+ * Absorbs a 4-byte big-endian length.
+ */
+void Transcript::AbsorbLength(std::uint32_t length) {
+  CryptoPP::byte bytes[4] = {CryptoPP::byte(length >> 24),
+                             CryptoPP::byte(length >> 16),
+                             CryptoPP::byte(length >> 8), CryptoPP::byte(length)};
+  this->hash.Update(bytes, sizeof(bytes));
+}
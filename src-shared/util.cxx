@@ -3,7 +3,7 @@
 /**
  * Convert char vec to string.
  */
-std::string chvec2str(std::vector<unsigned char> data) {
+std::string chvec2str(const std::vector<unsigned char> &data) {
   std::string s(data.begin(), data.end());
   return s;
 }
@@ -11,7 +11,7 @@ std::string chvec2str(std::vector<unsigned char> data) {
 /**
  * Convert string to char vec.
  */
-std::vector<unsigned char> str2chvec(std::string s) {
+std::vector<unsigned char> str2chvec(const std::string &s) {
   std::vector<unsigned char> v(s.begin(), s.end());
   return v;
 }
@@ -19,7 +19,7 @@ std::vector<unsigned char> str2chvec(std::string s) {
 /**
  * Convert char vec to string.
  */
-std::string hex_encode(std::string s) {
+std::string hex_encode(const std::string &s) {
   std::string res;
   CryptoPP::StringSource(
       s, true, new CryptoPP::HexEncoder(new CryptoPP::StringSink(res)));
@@ -29,7 +29,7 @@ std::string hex_encode(std::string s) {
 /**
  * Convert string to char vec.
  */
-std::string hex_decode(std::string s) {
+std::string hex_decode(const std::string &s) {
   std::string res;
   CryptoPP::StringSource(
       s, true, new CryptoPP::HexDecoder(new CryptoPP::StringSink(res)));
@@ -39,14 +39,14 @@ std::string hex_decode(std::string s) {
 /**
  * Converts a byte block into an integer.
  */
-CryptoPP::Integer byteblock_to_integer(CryptoPP::SecByteBlock block) {
+CryptoPP::Integer byteblock_to_integer(const CryptoPP::SecByteBlock &block) {
   return CryptoPP::Integer(block, block.size());
 }
 
 /**
  * Converts an integer into a byte block.
  */
-CryptoPP::SecByteBlock integer_to_byteblock(CryptoPP::Integer x) {
+CryptoPP::SecByteBlock integer_to_byteblock(const CryptoPP::Integer &x) {
   size_t encodedSize = x.MinEncodedSize(CryptoPP::Integer::UNSIGNED);
   CryptoPP::SecByteBlock bytes(encodedSize);
   x.Encode(bytes.BytePtr(), encodedSize, CryptoPP::Integer::UNSIGNED);
@@ -72,7 +72,7 @@ CryptoPP::SecByteBlock string_to_byteblock(const std::string &s) {
  * Given a string, it prints its hex representation of the raw bytes it
  * contains. Used for debugging.
  */
-void print_string_as_hex(std::string str) {
+void print_string_as_hex(const std::string &str) {
   for (int i = 0; i < str.length(); i++) {
     std::cout << std::hex << std::setfill('0') << std::setw(2)
               << static_cast<int>(str[i]) << " ";
@@ -83,14 +83,14 @@ void print_string_as_hex(std::string str) {
 /**
  * Prints contents as integer
  */
-void print_key_as_int(CryptoPP::SecByteBlock block) {
+void print_key_as_int(const CryptoPP::SecByteBlock &block) {
   std::cout << byteblock_to_integer(block) << std::endl;
 }
 
 /**
  * Prints contents as hex.
  */
-void print_key_as_hex(CryptoPP::SecByteBlock block) {
+void print_key_as_hex(const CryptoPP::SecByteBlock &block) {
   std::string result;
   CryptoPP::HexEncoder encoder(new CryptoPP::StringSink(result));
 
@@ -103,7 +103,7 @@ void print_key_as_hex(CryptoPP::SecByteBlock block) {
 /**
  * Split a string.
  */
-std::vector<std::string> string_split(std::string str, char delimiter) {
+std::vector<std::string> string_split(const std::string &str, char delimiter) {
   std::vector<std::string> result;
   // construct a stream from the string
   std::stringstream ss(str);
@@ -117,10 +117,10 @@ std::vector<std::string> string_split(std::string str, char delimiter) {
 /**
  * Hash vote zkp
  */
-CryptoPP::Integer hash_vote_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
-                                CryptoPP::Integer b, CryptoPP::Integer a0_p,
-                                CryptoPP::Integer b0_p, CryptoPP::Integer a1_p,
-                                CryptoPP::Integer b1_p) {
+CryptoPP::Integer hash_vote_zkp(const CryptoPP::Integer &pk, const CryptoPP::Integer &a,
+                                const CryptoPP::Integer &b, const CryptoPP::Integer &a0_p,
+                                const CryptoPP::Integer &b0_p, const CryptoPP::Integer &a1_p,
+                                const CryptoPP::Integer &b1_p) {
   std::string res;
   res += CryptoPP::IntToString(pk);
   res += CryptoPP::IntToString(a);
@@ -142,9 +142,9 @@ CryptoPP::Integer hash_vote_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
 /**
  * Hash count zkp
  */
-CryptoPP::Integer hash_count_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
-                                CryptoPP::Integer b, std::vector<CryptoPP::Integer> a_vec,
-                                std::vector<CryptoPP::Integer> b_vec) {
+CryptoPP::Integer hash_count_zkp(const CryptoPP::Integer &pk, const CryptoPP::Integer &a,
+                                const CryptoPP::Integer &b, const std::vector<CryptoPP::Integer> &a_vec,
+                                const std::vector<CryptoPP::Integer> &b_vec) {
   std::string res;
   res += CryptoPP::IntToString(pk);
   res += CryptoPP::IntToString(a);
@@ -166,9 +166,9 @@ CryptoPP::Integer hash_count_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
 /**
  * Hash partial decryption zkp
  */
-CryptoPP::Integer hash_dec_zkp(CryptoPP::Integer pk, CryptoPP::Integer a,
-                               CryptoPP::Integer b, CryptoPP::Integer u,
-                               CryptoPP::Integer v) {
+CryptoPP::Integer hash_dec_zkp(const CryptoPP::Integer &pk, const CryptoPP::Integer &a,
+                               const CryptoPP::Integer &b, const CryptoPP::Integer &u,
+                               const CryptoPP::Integer &v) {
   std::string res;
   res += CryptoPP::IntToString(pk);
   res += CryptoPP::IntToString(a);
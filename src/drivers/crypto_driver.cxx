@@ -13,6 +13,7 @@
 #include <crypto++/queue.h>
 
 #include "../../include-shared/constants.hpp"
+#include "../../include-shared/rng.hpp"
 #include "../../include-shared/util.hpp"
 #include "../../include/drivers/crypto_driver.hpp"
 
@@ -23,7 +24,8 @@ using namespace CryptoPP;
  * HMAC. Outputs an HMACTagged_Wrapper as bytes.
  */
 std::vector<unsigned char>
-CryptoDriver::encrypt_and_tag(SecByteBlock AES_key, SecByteBlock HMAC_key,
+CryptoDriver::encrypt_and_tag(const SecByteBlock &AES_key,
+                              const SecByteBlock &HMAC_key,
                               Serializable *message) {
   // Serialize given message.
   std::vector<unsigned char> plaintext;
@@ -53,23 +55,23 @@ CryptoDriver::encrypt_and_tag(SecByteBlock AES_key, SecByteBlock HMAC_key,
  * the given message using AES. Takes in an HMACTagged_Wrapper as bytes.
  */
 std::pair<std::vector<unsigned char>, bool>
-CryptoDriver::decrypt_and_verify(SecByteBlock AES_key, SecByteBlock HMAC_key,
-                                 std::vector<unsigned char> ciphertext_data) {
+CryptoDriver::decrypt_and_verify(
+    const SecByteBlock &AES_key, const SecByteBlock &HMAC_key,
+    const std::vector<unsigned char> &ciphertext_data) {
   // Deserialize
   HMACTagged_Wrapper ciphertext;
   ciphertext.deserialize(ciphertext_data);
 
   // Verify HMAC
+  std::string payload = chvec2str(ciphertext.payload);
   std::string to_verify =
       std::string((const char *)ciphertext.iv.data(), ciphertext.iv.size()) +
-      chvec2str(ciphertext.payload);
+      payload;
   bool valid = this->HMAC_verify(HMAC_key, to_verify, ciphertext.mac);
 
   // Decrypt
-  std::string plaintext =
-      this->AES_decrypt(AES_key, ciphertext.iv, chvec2str(ciphertext.payload));
-  std::vector<unsigned char> plaintext_data = str2chvec(plaintext);
-  return std::make_pair(plaintext_data, valid);
+  std::string plaintext = this->AES_decrypt(AES_key, ciphertext.iv, payload);
+  return std::make_pair(str2chvec(plaintext), valid);
 }
 
 /**
@@ -77,7 +79,7 @@ CryptoDriver::decrypt_and_verify(SecByteBlock AES_key, SecByteBlock HMAC_key,
  */
 std::tuple<DH, SecByteBlock, SecByteBlock> CryptoDriver::DH_initialize() {
   DH DH_obj(DL_P, DL_Q, DL_G);
-  AutoSeededRandomPool prng;
+  RandomNumberGenerator &prng = ThreadRNG();
   SecByteBlock DH_private_key(DH_obj.PrivateKeyLength());
   SecByteBlock DH_public_key(DH_obj.PublicKeyLength());
   DH_obj.GenerateKeyPair(prng, DH_private_key, DH_public_key);
@@ -117,13 +119,14 @@ SecByteBlock CryptoDriver::AES_generate_key(const SecByteBlock &DH_shared_key) {
  * @brief Encrypts the given plaintext.
  */
 std::pair<std::string, SecByteBlock>
-CryptoDriver::AES_encrypt(SecByteBlock key, std::string plaintext) {
+CryptoDriver::AES_encrypt(const SecByteBlock &key,
+                          const std::string &plaintext) {
   try {
     // Create encryptor and set key
     CBC_Mode<AES>::Encryption AES_encryptor = CBC_Mode<AES>::Encryption();
 
     SecByteBlock iv(AES::BLOCKSIZE);
-    AutoSeededRandomPool rng;
+    RandomNumberGenerator &rng = ThreadRNG();
     AES_encryptor.GetNextIV(rng, iv.BytePtr());
     AES_encryptor.SetKeyWithIV(key, key.size(), iv);
 
@@ -145,8 +148,9 @@ CryptoDriver::AES_encrypt(SecByteBlock key, std::string plaintext) {
 /**
  * @brief Decrypts the given ciphertext.
  */
-std::string CryptoDriver::AES_decrypt(SecByteBlock key, SecByteBlock iv,
-                                      std::string ciphertext) {
+std::string CryptoDriver::AES_decrypt(const SecByteBlock &key,
+                                      const SecByteBlock &iv,
+                                      const std::string &ciphertext) {
   try {
     CBC_Mode<AES>::Decryption AES_decryptor = CBC_Mode<AES>::Decryption();
     AES_decryptor.SetKeyWithIV(key, key.size(), iv);
@@ -184,8 +188,8 @@ CryptoDriver::HMAC_generate_key(const SecByteBlock &DH_shared_key) {
 /**
  * @brief Given a ciphertext, generates an HMAC
  */
-std::string CryptoDriver::HMAC_generate(SecByteBlock key,
-                                        std::string ciphertext) {
+std::string CryptoDriver::HMAC_generate(const SecByteBlock &key,
+                                        const std::string &ciphertext) {
   try {
     std::string mac;
     HMAC<SHA256> hmac(key, key.size());
@@ -201,8 +205,9 @@ std::string CryptoDriver::HMAC_generate(SecByteBlock key,
 /**
  * @brief Given a message and MAC, checks the MAC is valid.
  */
-bool CryptoDriver::HMAC_verify(SecByteBlock key, std::string ciphertext,
-                               std::string mac) {
+bool CryptoDriver::HMAC_verify(const SecByteBlock &key,
+                               const std::string &ciphertext,
+                               const std::string &mac) {
   const int flags = HashVerificationFilter::THROW_EXCEPTION |
                     HashVerificationFilter::HASH_AT_END;
   try {
@@ -221,7 +226,7 @@ bool CryptoDriver::HMAC_verify(SecByteBlock key, std::string ciphertext,
  */
 std::pair<DSA::PrivateKey, DSA::PublicKey> CryptoDriver::DSA_generate_keys() {
   // TODO: implement me!
-  AutoSeededRandomPool rng;
+  RandomNumberGenerator &rng = ThreadRNG();
 
   DSA::PrivateKey privateKey;
   privateKey.GenerateRandomWithKeySize(rng, DSA_KEYSIZE);
@@ -242,16 +247,17 @@ std::pair<DSA::PrivateKey, DSA::PublicKey> CryptoDriver::DSA_generate_keys() {
  * @brief Sign the given message with the given signing key.
  */
 std::string CryptoDriver::DSA_sign(const DSA::PrivateKey &signing_key,
-                                   std::vector<unsigned char> message) {
+                                   std::span<const unsigned char> message) {
   // TODO: implement me!
-  AutoSeededRandomPool rng;
+  RandomNumberGenerator &rng = ThreadRNG();
   
   DSA::Signer signer(signing_key);
 
-  std::string str_message = chvec2str(message);
-  std::string signature;
-
-  StringSource ss(str_message, true, new SignerFilter(rng, signer, new StringSink(signature)));
+  // sign the message where it is, rather than a copy of it in a string
+  std::string signature(signer.MaxSignatureLength(), '\0');
+  size_t length = signer.SignMessage(rng, message.data(), message.size(),
+                                     (byte *)signature.data());
+  signature.resize(length);
   return signature;
 }
 
@@ -259,42 +265,42 @@ std::string CryptoDriver::DSA_sign(const DSA::PrivateKey &signing_key,
  * @brief Verify that signature is valid on message with the verification_key.
  */
 bool CryptoDriver::DSA_verify(const DSA::PublicKey &verification_key,
-                              std::vector<unsigned char> message,
-                              std::string signature) {
-  const int flags = SignatureVerificationFilter::PUT_RESULT |
-                    SignatureVerificationFilter::SIGNATURE_AT_END;
+                              std::span<const unsigned char> message,
+                              std::string_view signature) {
   // TODO: implement me!
   DSA::Verifier verifier(verification_key);
 
-  std::string str_message = chvec2str(message);
-
-  bool result = false;
-  StringSource ss(str_message + signature, true, 
-    new SignatureVerificationFilter(verifier, new ArraySink((byte*)&result, sizeof(result)), flags));
-
-  return result;
+  // verify the message where it is, rather than a copy with the signature
+  // appended
+  if (signature.size() != verifier.SignatureLength()) {
+    return false;
+  }
+  return verifier.VerifyMessage(message.data(), message.size(),
+                                (const byte *)signature.data(),
+                                signature.size());
 }
 
 /**
  * @brief Generates a pair of El Gamal keys. This function should:
- * 1) Generate a random `a` value using an CryptoPP::AutoSeededRandomPool
- * 2) Exponentiate the base DL_G to get the public value, 
+ * 1) Generate a random `a` value below the group order using the thread's
+ *    generator
+ * 2) Exponentiate the group's generator to get the public value, 
  *    then return (private key, public key)
  */
-std::pair<CryptoPP::Integer, CryptoPP::Integer> CryptoDriver::EG_generate() {
+std::pair<CryptoPP::Integer, CryptoPP::Integer>
+CryptoDriver::EG_generate(const GroupContext &group) {
   // TODO: implement me!
-  AutoSeededRandomPool a;
-  
-  Integer sk(a, 1, DL_P-1);
-  Integer pk = ModularExponentiation(DL_G, sk, DL_P);
+  // the generator has prime order, so larger exponents give no more keys
+  Scalar sk = group.RandomScalar();
+  GroupElement pk = group.Generator().Exponentiate(sk);
 
-  return std::make_pair(sk, pk);
+  return std::make_pair(sk.ToInteger(), pk.ToInteger());
 }
 
 /**
  * @brief Generates a SHA-256 hash of msg.
  */
-std::string CryptoDriver::hash(std::string msg) {
+std::string CryptoDriver::hash(const std::string &msg) {
   SHA256 hash;
   std::string encodedHex;
   HexEncoder encoder(new StringSink(encodedHex));
@@ -18,7 +18,7 @@ DBDriver::DBDriver() {}
 /**
  * Open a particular db file.
  */
-int DBDriver::open(std::string dbpath) {
+int DBDriver::open(const std::string &dbpath) {
   return sqlite3_open(dbpath.c_str(), &this->db);
 }
 
@@ -51,7 +51,6 @@ void DBDriver::init_tables() {
   std::string create_vote_query = "CREATE TABLE IF NOT EXISTS vote("
                                   "votes TEXT PRIMARY KEY  NOT NULL, "
                                   "zkps TEXT NOT NULL, "
-                                  "vote_count TEXT NOT NULL, "
                                   "count_zkps TEXT NOT NULL, "
                                   "signature TEXT NOT NULL);";
   exit = sqlite3_exec(this->db, create_vote_query.c_str(), NULL, 0, &err);
@@ -61,6 +60,24 @@ void DBDriver::init_tables() {
     std::cout << "Table created successfully" << std::endl;
   }
 
+  // drop the vote_count column of a vote table made before ballots stopped
+  // carrying their vote count; it is recomputed from votes
+  std::string find_vote_count_query =
+      "SELECT COUNT(*) FROM pragma_table_info('vote') WHERE name = 'vote_count';";
+  sqlite3_stmt *stmt;
+  sqlite3_prepare_v2(this->db, find_vote_count_query.c_str(),
+                     find_vote_count_query.length(), &stmt, nullptr);
+  bool has_vote_count =
+      sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int(stmt, 0) > 0;
+  sqlite3_finalize(stmt);
+  if (has_vote_count) {
+    exit = sqlite3_exec(this->db, "ALTER TABLE vote DROP COLUMN vote_count;",
+                        NULL, 0, &err);
+    if (exit != SQLITE_OK) {
+      std::cerr << "Error migrating table: " << err << std::endl;
+    }
+  }
+
   // create partial_decryption table
   std::string create_partial_decryption_query =
       "CREATE TABLE IF NOT EXISTS partial_decryption("
@@ -76,6 +93,20 @@ void DBDriver::init_tables() {
     std::cout << "Table created successfully" << std::endl;
   }
 
+  // create aggregate table, which holds a single row
+  std::string create_aggregate_query = "CREATE TABLE IF NOT EXISTS aggregate("
+                                       "id INTEGER PRIMARY KEY NOT NULL, "
+                                       "votes TEXT NOT NULL, "
+                                       "ballot_count TEXT NOT NULL, "
+                                       "last_row_id TEXT NOT NULL, "
+                                       "signature TEXT NOT NULL);";
+  exit = sqlite3_exec(this->db, create_aggregate_query.c_str(), NULL, 0, &err);
+  if (exit != SQLITE_OK) {
+    std::cerr << "Error creating table: " << err << std::endl;
+  } else {
+    std::cout << "Table created successfully" << std::endl;
+  }
+
   // create voted table
   std::string create_voted_query = "CREATE TABLE IF NOT EXISTS voted("
                                    "id TEXT PRIMARY KEY NOT NULL);";
@@ -100,6 +131,7 @@ void DBDriver::reset_tables() {
   table_names.push_back("vote");
   table_names.push_back("partial_decryption");
   table_names.push_back("voted");
+  table_names.push_back("aggregate");
 
   sqlite3_stmt *stmt;
   // For each table, drop it
@@ -128,7 +160,7 @@ void DBDriver::reset_tables() {
 /**
  * Find the given voter. Returns an empty voter if none was found.
  */
-VoterRow DBDriver::find_voter(std::string id) {
+VoterRow DBDriver::find_voter(const std::string &id) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
@@ -178,7 +210,7 @@ VoterRow DBDriver::find_voter(std::string id) {
 /**
  * Insert the given voter; prints an error if violated a primary key constraint.
  */
-VoterRow DBDriver::insert_voter(VoterRow voter) {
+void DBDriver::insert_voter(const VoterRow &voter) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
@@ -201,13 +233,12 @@ VoterRow DBDriver::insert_voter(VoterRow voter) {
   sqlite3_bind_blob(stmt, 3, voter.registrar_signature.c_str(),
                     voter.registrar_signature.length(), SQLITE_STATIC);
 
-  // Run and return.
+  // Run.
   sqlite3_step(stmt);
   int exit = sqlite3_finalize(stmt);
   if (exit != SQLITE_OK) {
     std::cerr << "Error inserting voter " << std::endl;
   }
-  return voter;
 }
 
 // ================================================
@@ -221,7 +252,7 @@ std::vector<VoteRow> DBDriver::all_votes() {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
-  std::string find_query = "SELECT votes, zkps, vote_count, count_zkps, signature FROM vote";
+  std::string find_query = "SELECT votes, zkps, count_zkps, signature FROM vote";
 
   // Prepare statement.
   sqlite3_stmt *stmt;
@@ -234,30 +265,24 @@ std::vector<VoteRow> DBDriver::all_votes() {
     for (int colIndex = 0; colIndex < sqlite3_column_count(stmt); colIndex++) {
       const void *raw_result = sqlite3_column_blob(stmt, colIndex);
       int num_bytes = sqlite3_column_bytes(stmt, colIndex);
-      std::vector<unsigned char> data;
+      std::span<const unsigned char> data((const unsigned char *)raw_result,
+                                          num_bytes);
       switch (colIndex) {
       case 0:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         vote.votes.deserialize(data);
         break;
       case 1:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         vote.zkps.deserialize(data);
         break;
       case 2:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
-        vote.vote_count.deserialize(data);
-        break;
-      case 3:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         vote.count_zkps.deserialize(data);
         break;
-      case 4:
+      case 3:
         vote.tallyer_signature = std::string((const char *)raw_result, num_bytes);
         break;
       }
     }
-    res.push_back(vote);
+    res.push_back(std::move(vote));
   }
 
   // Finalize and return.
@@ -268,25 +293,61 @@ std::vector<VoteRow> DBDriver::all_votes() {
   return res;
 }
 
+/**
+ * Read all votes into batch, straight from the column bytes. A malformed
+ * vote is skipped, as it can never be counted.
+ */
+void DBDriver::all_votes(BallotBatch &batch) {
+  // Lock db driver.
+  std::unique_lock<std::mutex> lck(this->mtx);
+
+  std::string find_query = "SELECT votes, zkps, count_zkps, signature FROM vote";
+
+  // Prepare statement.
+  sqlite3_stmt *stmt;
+  sqlite3_prepare_v2(this->db, find_query.c_str(), find_query.length(), &stmt, nullptr);
+
+  // Retreive votes.
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    std::span<const unsigned char> columns[4];
+    for (int colIndex = 0; colIndex < 4; colIndex++) {
+      const void *raw_result = sqlite3_column_blob(stmt, colIndex);
+      int num_bytes = sqlite3_column_bytes(stmt, colIndex);
+      columns[colIndex] = std::span<const unsigned char>(
+          (const unsigned char *)raw_result, num_bytes);
+    }
+    try {
+      batch.Add(columns[0], columns[1], columns[2], columns[3]);
+    } catch (std::exception &e) {
+      std::cerr << "Skipping malformed vote: " << e.what() << std::endl;
+    }
+  }
+
+  // Finalize.
+  int exit = sqlite3_finalize(stmt);
+  if (exit != SQLITE_OK) {
+    std::cerr << "Error finding vote " << std::endl;
+  }
+}
+
 /**
  * Find the given vote. Returns an empty vote if none was found.
  */
-VoteRow DBDriver::find_vote(Vote_Struct vote_s) {
+VoteRow DBDriver::find_vote(const Vote_Struct &vote_s) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
   std::string find_query =
-      "SELECT votes, zkps, vote_count, count_zkps, signature FROM vote WHERE vote = ?";
+      "SELECT votes, zkps, count_zkps, signature FROM vote WHERE vote = ?";
 
   // Serialize cert.
   std::vector<unsigned char> vote_data;
   vote_s.serialize(vote_data);
-  std::string vote_str = chvec2str(vote_data);
 
   // Prepare statement.
   sqlite3_stmt *stmt;
   sqlite3_prepare_v2(this->db, find_query.c_str(), find_query.length(), &stmt, nullptr);
-  sqlite3_bind_blob(stmt, 1, vote_str.c_str(), vote_str.length(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 1, vote_data.data(), vote_data.size(), SQLITE_STATIC);
 
   // Retreive vote.
   VoteRow vote;
@@ -294,25 +355,19 @@ VoteRow DBDriver::find_vote(Vote_Struct vote_s) {
     for (int colIndex = 0; colIndex < sqlite3_column_count(stmt); colIndex++) {
       const void *raw_result = sqlite3_column_blob(stmt, colIndex);
       int num_bytes = sqlite3_column_bytes(stmt, colIndex);
-      std::vector<unsigned char> data;
+      std::span<const unsigned char> data((const unsigned char *)raw_result,
+                                          num_bytes);
       switch (colIndex) {
       case 0:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         vote.votes.deserialize(data);
         break;
       case 1:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         vote.zkps.deserialize(data);
         break;
       case 2:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
-        vote.vote_count.deserialize(data);
-        break;
-      case 3:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         vote.count_zkps.deserialize(data);
         break;
-      case 4:
+      case 3:
         vote.tallyer_signature = std::string((const char *)raw_result, num_bytes);
         break;
       }
@@ -330,49 +385,243 @@ VoteRow DBDriver::find_vote(Vote_Struct vote_s) {
 /**
  * Insert the given vote; prints an error if violated a primary key constraint.
  */
-VoteRow DBDriver::insert_vote(VoteRow vote) {
+void DBDriver::insert_vote(const VoteRow &vote) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
   std::string insert_query =
-      "INSERT INTO vote(votes, zkps, vote_count, count_zkps, signature) VALUES(?, ?, ?, ?, ?);";
+      "INSERT INTO vote(votes, zkps, count_zkps, signature) VALUES(?, ?, ?, ?);";
 
   // Serialize vote fields.
   std::vector<unsigned char> votes_data;
   vote.votes.serialize(votes_data);
-  std::string votes_str = chvec2str(votes_data);
 
   std::vector<unsigned char> zkps_data;
   vote.zkps.serialize(zkps_data);
-  std::string zkps_str = chvec2str(zkps_data);
-
-  std::vector<unsigned char> vote_count_data;
-  vote.vote_count.serialize(vote_count_data);
-  std::string vote_count_str = chvec2str(vote_count_data);
 
   std::vector<unsigned char> count_zkps_data;
   vote.count_zkps.serialize(count_zkps_data);
-  std::string count_zkps_str = chvec2str(count_zkps_data);
 
-  std::string sign_str = vote.tallyer_signature;
+  const std::string &sign_str = vote.tallyer_signature;
 
   // Prepare statement.
   sqlite3_stmt *stmt;
   sqlite3_prepare_v2(this->db, insert_query.c_str(), insert_query.length(),
                      &stmt, nullptr);
-  sqlite3_bind_blob(stmt, 1, votes_str.c_str(), votes_str.length(), SQLITE_STATIC);
-  sqlite3_bind_blob(stmt, 2, zkps_str.c_str(), zkps_str.length(), SQLITE_STATIC);
-  sqlite3_bind_blob(stmt, 3, vote_count_str.c_str(), vote_count_str.length(), SQLITE_STATIC);
-  sqlite3_bind_blob(stmt, 4, count_zkps_str.c_str(), count_zkps_str.length(), SQLITE_STATIC);
-  sqlite3_bind_blob(stmt, 5, sign_str.c_str(), sign_str.length(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 1, votes_data.data(), votes_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 2, zkps_data.data(), zkps_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 3, count_zkps_data.data(), count_zkps_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 4, sign_str.c_str(), sign_str.length(), SQLITE_STATIC);
 
-  // Run and return.
+  // Run.
   sqlite3_step(stmt);
   int exit = sqlite3_finalize(stmt);
   if (exit != SQLITE_OK) {
     std::cerr << "Error inserting vote " << std::endl;
   }
-  return vote;
+}
+
+// ================================================
+// AGGREGATE
+// ================================================
+
+namespace {
+/**
+ * Replace the aggregate row with the given aggregate. Returns the sqlite
+ * result of the statement.
+ */
+int replace_aggregate(sqlite3 *db, const AggregateRow &aggregate) {
+  std::string insert_aggregate_query =
+      "INSERT OR REPLACE INTO aggregate(id, votes, ballot_count, "
+      "last_row_id, signature) VALUES(0, ?, ?, ?, ?);";
+
+  // Serialize aggregate fields.
+  std::vector<unsigned char> aggregate_votes_data;
+  aggregate.votes.serialize(aggregate_votes_data);
+  std::string ballot_count_str = CryptoPP::IntToString(aggregate.ballot_count);
+  std::string last_row_id_str = CryptoPP::IntToString(aggregate.last_row_id);
+
+  // Replace the aggregate.
+  sqlite3_stmt *stmt;
+  sqlite3_prepare_v2(db, insert_aggregate_query.c_str(),
+                     insert_aggregate_query.length(), &stmt, nullptr);
+  sqlite3_bind_blob(stmt, 1, aggregate_votes_data.data(), aggregate_votes_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 2, ballot_count_str.c_str(), ballot_count_str.length(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 3, last_row_id_str.c_str(), last_row_id_str.length(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 4, aggregate.tallyer_signature.c_str(),
+                    aggregate.tallyer_signature.length(), SQLITE_STATIC);
+  int rc = sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+  return rc;
+}
+} // namespace
+
+/**
+ * Return the running aggregate. Returns an empty aggregate with a ballot
+ * count of zero if no ballot has been folded in yet. If last_vote_row_id is
+ * given, it is set to the rowid of the last vote on the board, or zero, read
+ * in the same transaction: the aggregate covers every vote only if its
+ * last_row_id equals it.
+ */
+AggregateRow DBDriver::find_aggregate(CryptoPP::Integer *last_vote_row_id) {
+  // Lock db driver.
+  std::unique_lock<std::mutex> lck(this->mtx);
+
+  std::string find_query = "SELECT votes, ballot_count, last_row_id, signature "
+                           "FROM aggregate WHERE id = 0";
+  std::string find_last_query = "SELECT IFNULL(MAX(rowid), 0) FROM vote";
+
+  char *err;
+  sqlite3_exec(this->db, "BEGIN TRANSACTION;", NULL, 0, &err);
+
+  // Prepare statement.
+  sqlite3_stmt *stmt;
+  sqlite3_prepare_v2(this->db, find_query.c_str(), find_query.length(), &stmt, nullptr);
+
+  // Retreive aggregate.
+  AggregateRow aggregate;
+  aggregate.ballot_count = CryptoPP::Integer::Zero();
+  aggregate.last_row_id = CryptoPP::Integer::Zero();
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    for (int colIndex = 0; colIndex < sqlite3_column_count(stmt); colIndex++) {
+      const void *raw_result = sqlite3_column_blob(stmt, colIndex);
+      int num_bytes = sqlite3_column_bytes(stmt, colIndex);
+      std::span<const unsigned char> data((const unsigned char *)raw_result,
+                                          num_bytes);
+      switch (colIndex) {
+      case 0:
+        aggregate.votes.deserialize(data);
+        break;
+      case 1:
+        aggregate.ballot_count = CryptoPP::Integer(
+            std::string((const char *)raw_result, num_bytes).c_str());
+        break;
+      case 2:
+        aggregate.last_row_id = CryptoPP::Integer(
+            std::string((const char *)raw_result, num_bytes).c_str());
+        break;
+      case 3:
+        aggregate.tallyer_signature = std::string((const char *)raw_result, num_bytes);
+        break;
+      }
+    }
+  }
+  int exit = sqlite3_finalize(stmt);
+  if (exit != SQLITE_OK) {
+    std::cerr << "Error finding aggregate " << std::endl;
+  }
+
+  // Retreive the last vote's rowid.
+  if (last_vote_row_id != nullptr) {
+    sqlite3_prepare_v2(this->db, find_last_query.c_str(), find_last_query.length(), &stmt, nullptr);
+    *last_vote_row_id = CryptoPP::Integer::Zero();
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      *last_vote_row_id = CryptoPP::Integer((long)sqlite3_column_int64(stmt, 0));
+    }
+    exit = sqlite3_finalize(stmt);
+    if (exit != SQLITE_OK) {
+      std::cerr << "Error finding vote " << std::endl;
+    }
+  }
+
+  // End the read and return.
+  sqlite3_exec(this->db, "COMMIT;", NULL, 0, &err);
+  return aggregate;
+}
+
+/**
+ * Replace the aggregate, such as one rebuilt from the votes.
+ */
+void DBDriver::insert_aggregate(const AggregateRow &aggregate) {
+  // Lock db driver.
+  std::unique_lock<std::mutex> lck(this->mtx);
+
+  // Run.
+  if (replace_aggregate(this->db, aggregate) != SQLITE_DONE) {
+    std::cerr << "Error inserting aggregate " << std::endl;
+  }
+}
+
+/**
+ * Insert the given vote, replace the aggregate and mark the voter as having
+ * voted in one transaction, so the aggregate always covers exactly the votes
+ * up to its last_row_id and a voter's ballot is stored at most once. The
+ * vote is stored under that rowid, which the caller picks, one past the last
+ * vote, so it can be signed with the aggregate. Writes nothing and returns
+ * false if the voter has already voted or any statement fails. The vote's
+ * lists are stored as the bytes it was read from, and its signature with
+ * them.
+ */
+bool DBDriver::insert_vote_and_aggregate(const std::string &voter_id,
+                                         const BallotView &vote,
+                                         const AggregateRow &aggregate) {
+  // Lock db driver.
+  std::unique_lock<std::mutex> lck(this->mtx);
+
+  std::string find_voted_query = "SELECT 1 FROM voted WHERE id = ?";
+  std::string insert_vote_query =
+      "INSERT INTO vote(rowid, votes, zkps, count_zkps, signature) "
+      "VALUES(?, ?, ?, ?, ?);";
+  std::string insert_voted_query = "INSERT INTO voted(id) VALUES(?);";
+
+  char *err;
+  sqlite3_exec(this->db, "BEGIN TRANSACTION;", NULL, 0, &err);
+
+  // Check the voter has not voted.
+  sqlite3_stmt *stmt;
+  sqlite3_prepare_v2(this->db, find_voted_query.c_str(), find_voted_query.length(),
+                     &stmt, nullptr);
+  sqlite3_bind_blob(stmt, 1, voter_id.c_str(), voter_id.length(), SQLITE_STATIC);
+  int rc = sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+  if (rc != SQLITE_DONE) {
+    sqlite3_exec(this->db, "ROLLBACK;", NULL, 0, &err);
+    return false;
+  }
+
+  // Insert the vote.
+  sqlite3_prepare_v2(this->db, insert_vote_query.c_str(), insert_vote_query.length(),
+                     &stmt, nullptr);
+  sqlite3_bind_int64(stmt, 1, aggregate.last_row_id.ConvertToLong());
+  sqlite3_bind_blob(stmt, 2, vote.votes_data.data(), vote.votes_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 3, vote.zkps_data.data(), vote.zkps_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 4, vote.count_zkps_data.data(), vote.count_zkps_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 5, vote.tallyer_signature.data(), vote.tallyer_signature.size(), SQLITE_STATIC);
+  rc = sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+  if (rc != SQLITE_DONE) {
+    sqlite3_exec(this->db, "ROLLBACK;", NULL, 0, &err);
+    std::cerr << "Error inserting vote " << std::endl;
+    return false;
+  }
+
+  // Replace the aggregate.
+  if (replace_aggregate(this->db, aggregate) != SQLITE_DONE) {
+    sqlite3_exec(this->db, "ROLLBACK;", NULL, 0, &err);
+    std::cerr << "Error inserting aggregate " << std::endl;
+    return false;
+  }
+
+  // Mark the voter as having voted.
+  sqlite3_prepare_v2(this->db, insert_voted_query.c_str(), insert_voted_query.length(),
+                     &stmt, nullptr);
+  sqlite3_bind_blob(stmt, 1, voter_id.c_str(), voter_id.length(), SQLITE_STATIC);
+  rc = sqlite3_step(stmt);
+  sqlite3_finalize(stmt);
+  if (rc != SQLITE_DONE) {
+    sqlite3_exec(this->db, "ROLLBACK;", NULL, 0, &err);
+    std::cerr << "Error inserting voted status " << std::endl;
+    return false;
+  }
+
+  // Commit.
+  int exit = sqlite3_exec(this->db, "COMMIT;", NULL, 0, &err);
+  if (exit != SQLITE_OK) {
+    std::cerr << "Error committing vote: " << err << std::endl;
+    sqlite3_exec(this->db, "ROLLBACK;", NULL, 0, &err);
+    return false;
+  }
+  return true;
 }
 
 // ================================================
@@ -402,7 +651,8 @@ DBDriver::DBDriver::all_partial_decryptions() {
     for (int colIndex = 0; colIndex < sqlite3_column_count(stmt); colIndex++) {
       const void *raw_result = sqlite3_column_blob(stmt, colIndex);
       int num_bytes = sqlite3_column_bytes(stmt, colIndex);
-      std::vector<unsigned char> data;
+      std::span<const unsigned char> data((const unsigned char *)raw_result,
+                                          num_bytes);
       switch (colIndex) {
       case 0:
         partial_decryption.arbiter_id = std::string((const char *)raw_result, num_bytes);
@@ -411,16 +661,14 @@ DBDriver::DBDriver::all_partial_decryptions() {
         partial_decryption.arbiter_vk_path = std::string((const char *)raw_result, num_bytes);
         break;
       case 2:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         partial_decryption.decs.deserialize(data);
         break;
       case 3:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         partial_decryption.zkps.deserialize(data);
         break;
       }
     }
-    res.push_back(partial_decryption);
+    res.push_back(std::move(partial_decryption));
   }
 
   // Finalize and return.
@@ -435,7 +683,8 @@ DBDriver::DBDriver::all_partial_decryptions() {
  * Find the given partial_decryption. Returns an empty partial_decryption if
  * none was found.
  */
-PartialDecryptionRow DBDriver::find_partial_decryption(std::string arbiter_id) {
+PartialDecryptionRow
+DBDriver::find_partial_decryption(const std::string &arbiter_id) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
@@ -456,7 +705,8 @@ PartialDecryptionRow DBDriver::find_partial_decryption(std::string arbiter_id) {
     for (int colIndex = 0; colIndex < sqlite3_column_count(stmt); colIndex++) {
       const void *raw_result = sqlite3_column_blob(stmt, colIndex);
       int num_bytes = sqlite3_column_bytes(stmt, colIndex);
-      std::vector<unsigned char> data;
+      std::span<const unsigned char> data((const unsigned char *)raw_result,
+                                          num_bytes);
       switch (colIndex) {
       case 0:
         partial_decryption.arbiter_id = std::string((const char *)raw_result, num_bytes);
@@ -465,11 +715,9 @@ PartialDecryptionRow DBDriver::find_partial_decryption(std::string arbiter_id) {
         partial_decryption.arbiter_vk_path = std::string((const char *)raw_result, num_bytes);
         break;
       case 2:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         partial_decryption.decs.deserialize(data);
         break;
       case 3:
-        data = str2chvec(std::string((const char *)raw_result, num_bytes));
         partial_decryption.zkps.deserialize(data);
         break;
       }
@@ -488,8 +736,8 @@ PartialDecryptionRow DBDriver::find_partial_decryption(std::string arbiter_id) {
  * Insert the given partial_decryption; prints an error if violated a primary
  * key constraint.
  */
-PartialDecryptionRow
-DBDriver::insert_partial_decryption(PartialDecryptionRow partial_decryption) {
+void DBDriver::insert_partial_decryption(
+    const PartialDecryptionRow &partial_decryption) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
@@ -501,11 +749,9 @@ DBDriver::insert_partial_decryption(PartialDecryptionRow partial_decryption) {
   // Serialize pd fields.
   std::vector<unsigned char> partial_decryption_data;
   partial_decryption.decs.serialize(partial_decryption_data);
-  std::string decs_str = chvec2str(partial_decryption_data);
 
   std::vector<unsigned char> zkp_data;
   partial_decryption.zkps.serialize(zkp_data);
-  std::string zkps_str = chvec2str(zkp_data);
 
   // Prepare statement.
   sqlite3_stmt *stmt;
@@ -515,23 +761,23 @@ DBDriver::insert_partial_decryption(PartialDecryptionRow partial_decryption) {
                     partial_decryption.arbiter_id.length(), SQLITE_STATIC);
   sqlite3_bind_blob(stmt, 2, partial_decryption.arbiter_vk_path.c_str(),
                     partial_decryption.arbiter_vk_path.length(), SQLITE_STATIC);
-  sqlite3_bind_blob(stmt, 3, decs_str.c_str(), decs_str.length(), SQLITE_STATIC);
-  sqlite3_bind_blob(stmt, 4, zkps_str.c_str(), zkps_str.length(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 3, partial_decryption_data.data(),
+                    partial_decryption_data.size(), SQLITE_STATIC);
+  sqlite3_bind_blob(stmt, 4, zkp_data.data(), zkp_data.size(), SQLITE_STATIC);
 
-  // Run and return.
+  // Run.
   sqlite3_step(stmt);
   int exit = sqlite3_finalize(stmt);
   if (exit != SQLITE_OK) {
     std::cerr << "Error inserting partial_decryption " << std::endl;
   }
-  return partial_decryption;
 }
 
 // ================================================
 // VOTED
 // ================================================
 
-bool DBDriver::voter_voted(std::string id) {
+bool DBDriver::voter_voted(const std::string &id) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
@@ -561,7 +807,7 @@ bool DBDriver::voter_voted(std::string id) {
   return result;
 }
 
-std::string DBDriver::insert_voted(std::string id) {
+void DBDriver::insert_voted(const std::string &id) {
   // Lock db driver.
   std::unique_lock<std::mutex> lck(this->mtx);
   
@@ -573,11 +819,10 @@ std::string DBDriver::insert_voted(std::string id) {
                      &stmt, nullptr);
   sqlite3_bind_blob(stmt, 1, id.c_str(), id.length(), SQLITE_STATIC);
 
-  // Run and return.
+  // Run.
   sqlite3_step(stmt);
   int exit = sqlite3_finalize(stmt);
   if (exit != SQLITE_OK) {
     std::cerr << "Error inserting voted status " << std::endl;
   }
-  return id;
 }
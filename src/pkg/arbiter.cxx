@@ -23,6 +23,7 @@ ArbiterClient::ArbiterClient(ArbiterConfig arbiter_config,
   this->common_config = common_config;
   this->num_candidates = std::stoi(common_config.num_candidates);
   this->k = std::stoi(common_config.k);
+  this->group = &ElectionGroup(common_config.group);
   this->cli_driver = std::make_shared<CLIDriver>();
   this->crypto_driver = std::make_shared<CryptoDriver>();
   this->db_driver = std::make_shared<DBDriver>();
@@ -36,8 +37,21 @@ ArbiterClient::ArbiterClient(ArbiterConfig arbiter_config,
                 &this->EG_arbiter_secret_key);
     LoadInteger(arbiter_config.arbiter_public_key_path,
                 &this->EG_arbiter_public_key_i);
-    LoadElectionPublicKey(common_config.arbiter_public_key_paths,
-                          &this->EG_arbiter_public_key);
+    // Keys generated before exponents were sampled mod the group order are
+    // reduced in place; g^sk is unchanged, so the public key still matches.
+    if (this->EG_arbiter_secret_key >= this->group->Order()) {
+      this->EG_arbiter_secret_key %= this->group->Order();
+      SaveInteger(arbiter_config.arbiter_secret_key_path,
+                  this->EG_arbiter_secret_key);
+      this->cli_driver->print_info("Reduced arbiter secret key mod the group order.");
+    }
+    std::vector<CryptoPP::Integer> arbiter_public_keys;
+    LoadElectionPublicKeys(common_config.arbiter_public_key_paths,
+                           &arbiter_public_keys);
+    this->EG_arbiter_public_key =
+        this->group->CombinePublicKeys(arbiter_public_keys);
+    this->EG_arbiter_public_key_table = std::make_shared<FixedBaseTable>(
+        *this->group, this->EG_arbiter_public_key);
   } catch (CryptoPP::FileStore::OpenErr) {
     this->cli_driver->print_warning(
         "Could not find arbiter keys; you might consider generating some!");
@@ -66,7 +80,7 @@ void ArbiterClient::run() {
   // Start REPL
   REPLDriver<ArbiterClient> repl = REPLDriver<ArbiterClient>(this);
   repl.add_action("keygen", "keygen", &ArbiterClient::HandleKeygen);
-  repl.add_action("adjudicate", "adjudicate", &ArbiterClient::HandleAdjudicate);
+  repl.add_action("adjudicate", "adjudicate [audit]", &ArbiterClient::HandleAdjudicate);
   repl.run();
 }
 
@@ -77,7 +91,7 @@ void ArbiterClient::HandleKeygen(std::string _) {
   // Generate keys
   this->cli_driver->print_info("Generating keys, this may take some time...");
   std::pair<CryptoPP::Integer, CryptoPP::Integer> keys =
-      this->crypto_driver->EG_generate();
+      this->crypto_driver->EG_generate(*this->group);
 
   // Save keys
   SaveInteger(this->arbiter_config.arbiter_secret_key_path, keys.first);
@@ -86,55 +100,106 @@ void ArbiterClient::HandleKeygen(std::string _) {
               &this->EG_arbiter_secret_key);
   LoadInteger(arbiter_config.arbiter_public_key_path,
               &this->EG_arbiter_public_key_i);
-  LoadElectionPublicKey(common_config.arbiter_public_key_paths,
-                        &this->EG_arbiter_public_key);
+  std::vector<CryptoPP::Integer> arbiter_public_keys;
+  LoadElectionPublicKeys(common_config.arbiter_public_key_paths,
+                         &arbiter_public_keys);
+  this->EG_arbiter_public_key =
+      this->group->CombinePublicKeys(arbiter_public_keys);
+  this->EG_arbiter_public_key_table = std::make_shared<FixedBaseTable>(
+      *this->group, this->EG_arbiter_public_key);
   this->cli_driver->print_success("Keys succesfully generated and saved!");
 }
 
 /**
  * Handle partial decryption. This function:
  * 1) Update the ElectionPublicKey to the most up to date.
- * 2) Gets all of the votes from the database
- * 3) Verifies all of the vote ZKPs and signatures
- * 4) Combines all valid votes into one vote
- * 5) Partially decrypts the combined vote
- * 6) Publishes the decryption and zkp to the database
+ * 2) Reads the tallyer's running aggregate and verifies its signature and
+ *    that it covers every vote
+ * 3) With `audit`, instead gets all of the votes from the database, verifies
+ *    all of the vote ZKPs and signatures, combines all valid votes into one
+ *    vote, and checks that the aggregate matches it
+ * 4) Partially decrypts the combined vote
+ * 5) Publishes the decryption and zkp to the database
  */
-void ArbiterClient::HandleAdjudicate(std::string _) {
+void ArbiterClient::HandleAdjudicate(std::string input) {
   // TODO: implement me!
+  std::vector<std::string> args = string_split(input, ' ');
+  bool audit = args.size() > 1 && args[1] == "audit";
+
+  // update the ElectionPublicKey, rebuilding its table only if it changed
+  std::vector<CryptoPP::Integer> arbiter_public_keys;
+  LoadElectionPublicKeys(common_config.arbiter_public_key_paths, &arbiter_public_keys);
+  this->EG_arbiter_public_key = this->group->CombinePublicKeys(arbiter_public_keys);
+  if (!this->EG_arbiter_public_key_table ||
+      this->EG_arbiter_public_key_table->GetBase() != this->EG_arbiter_public_key) {
+    this->EG_arbiter_public_key_table = std::make_shared<FixedBaseTable>(
+        *this->group, this->EG_arbiter_public_key);
+  }
 
-  // update the ElectionPublicKey
-  LoadElectionPublicKey(common_config.arbiter_public_key_paths, &this->EG_arbiter_public_key);
-
-  std::vector<VoteRow> votes = this->db_driver->all_votes();
-  std::vector<VoteRow> valid_votes;
-
-  for (int i=0; i<votes.size(); i++) {
-    std::pair<Votes_Struct, VoteZKPs_Struct> votes_pair = std::make_pair(votes[i].votes, votes[i].zkps);
-    if (!(ElectionClient::VerifyVoteZKPs(votes_pair, this->EG_arbiter_public_key))) {
-      continue;
+  // read the tallyer's running aggregate, which must cover every vote on
+  // the board; an empty board has none
+  CryptoPP::Integer last_vote_row_id;
+  AggregateRow aggregate = this->db_driver->find_aggregate(&last_vote_row_id);
+  if (last_vote_row_id.IsZero()) {
+    aggregate.votes = ElectionClient::CombineVotes(*this->group, std::vector<VoteRow>(), this->num_candidates);
+    aggregate.ballot_count = CryptoPP::Integer::Zero();
+  } else {
+    std::vector<unsigned char> aggregate_str =
+      concat_votes_and_count(aggregate.votes, aggregate.ballot_count, aggregate.last_row_id);
+    if (aggregate.last_row_id != last_vote_row_id ||
+        !(this->crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, aggregate_str, aggregate.tallyer_signature)) ||
+        aggregate.votes.votes.size() != this->num_candidates) {
+      if (!audit) {
+        this->cli_driver->print_warning("Missing, invalid or out of date aggregate; rerun with audit to rescan the votes");
+        return;
+      }
+      aggregate.votes = Votes_Struct();
     }
+  }
 
-    std::vector<unsigned char> vote_info_str = 
-      concat_votes_and_zkps(votes[i].votes, votes[i].zkps, votes[i].vote_count, votes[i].count_zkps);
-    if (!(this->crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, vote_info_str, votes[i].tallyer_signature))) {
-      continue;
+  Votes_Struct combined_votes = aggregate.votes;
+  if (audit) {
+    BallotBatch votes;
+    this->db_driver->all_votes(votes);
+    std::vector<int> valid_votes;
+    std::vector<bool> zkps_valid = ElectionClient::BatchVerifyBallots(
+        *this->group, votes, this->num_candidates, this->k, *this->EG_arbiter_public_key_table);
+
+    for (int i=0; i<votes.Size(); i++) {
+      if (!zkps_valid[i]) {
+        continue;
+      }
+
+      Vote_Struct vote_count = ElectionClient::CountVotes(*this->group, votes[i]);
+      std::vector<unsigned char> vote_info_str = concat_votes_and_zkps(votes[i], vote_count);
+      if (!(this->crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, vote_info_str,
+                                            votes[i].tallyer_signature))) {
+        continue;
+      }
+
+      valid_votes.push_back(i);
     }
 
-    valid_votes.push_back(votes[i]);
+    combined_votes = ElectionClient::CombineVotes(*this->group, votes, valid_votes, this->num_candidates);
+    std::vector<unsigned char> combined_data;
+    combined_votes.serialize(combined_data);
+    std::vector<unsigned char> aggregate_data;
+    aggregate.votes.serialize(aggregate_data);
+    if (combined_data != aggregate_data ||
+        aggregate.ballot_count != CryptoPP::Integer((long)valid_votes.size())) {
+      this->cli_driver->print_warning("Aggregate does not match the votes; using the votes");
+    }
   }
 
-  Votes_Struct combined_votes = ElectionClient::CombineVotes(valid_votes, this->num_candidates);
-
   PartialDecryptionRow partial_dec_row;
   partial_dec_row.arbiter_id = this->arbiter_config.arbiter_id;
   partial_dec_row.arbiter_vk_path = this->arbiter_config.arbiter_public_key_path;
   
   std::pair<PartialDecryptions_Struct, DecryptionZKPs_Struct> p = 
-    ElectionClient::PartialDecryptions(combined_votes, this->EG_arbiter_public_key_i, this->EG_arbiter_secret_key);
-  partial_dec_row.decs = p.first;
+    ElectionClient::PartialDecryptions(*this->group, combined_votes, this->EG_arbiter_public_key_i, this->EG_arbiter_secret_key);
+  partial_dec_row.decs = std::move(p.first);
 
-  partial_dec_row.zkps = p.second;
+  partial_dec_row.zkps = std::move(p.second);
 
   this->db_driver->insert_partial_decryption(partial_dec_row);
 }
@@ -0,0 +1,68 @@
+#include "../../include/pkg/ballot_pool.hpp"
+
+/**
+ * Starts the background thread.
+ */
+BallotPool::BallotPool(const GroupContext &group,
+                       std::shared_ptr<FixedBaseTable> pk, int num_candidates,
+                       int k, int size)
+    : group(group) {
+  this->pk = pk;
+  this->num_candidates = num_candidates;
+  this->k = k;
+  this->size = size;
+  this->stopping = false;
+  this->worker = std::thread(&BallotPool::Fill, this);
+}
+
+/**
+ * Stops the background thread, waiting for the ballot it is working on.
+ */
+BallotPool::~BallotPool() {
+  {
+    std::unique_lock<std::mutex> lck(this->mtx);
+    this->stopping = true;
+  }
+  this->cv.notify_all();
+  this->worker.join();
+}
+
+/**
+ * Removes a ready ballot from the pool, waiting for one if none is ready.
+ */
+PrecomputedBallot BallotPool::Take() {
+  std::unique_lock<std::mutex> lck(this->mtx);
+  this->cv.wait(lck, [this] { return !this->ballots.empty(); });
+  PrecomputedBallot ballot = std::move(this->ballots.front());
+  this->ballots.pop_front();
+  lck.unlock();
+
+  // wake the worker to replace it
+  this->cv.notify_all();
+  return ballot;
+}
+
+/**
+ * Background thread: precomputes ballots until the pool is full, then
+ * sleeps until one is taken.
+ */
+void BallotPool::Fill() {
+  std::unique_lock<std::mutex> lck(this->mtx);
+  while (true) {
+    this->cv.wait(lck, [this] {
+      return this->stopping || this->ballots.size() < this->size;
+    });
+    if (this->stopping) {
+      return;
+    }
+
+    // precompute without holding the lock
+    lck.unlock();
+    PrecomputedBallot ballot = ElectionClient::PrecomputeBallot(
+        this->group, this->num_candidates, this->k, *this->pk);
+    lck.lock();
+
+    this->ballots.push_back(std::move(ballot));
+    this->cv.notify_all();
+  }
+}
@@ -1,5 +1,9 @@
+#include <algorithm>
+
 #include "../../include/pkg/election.hpp"
+#include "../../include/pkg/thread_pool.hpp"
 #include "../../include-shared/logger.hpp"
+#include "../../include-shared/rng.hpp"
 
 /*
 Syntax to use logger: 
@@ -10,23 +14,219 @@ namespace {
   src::severity_logger<logging::trivial::severity_level> lg;
 }
 
+namespace {
 /**
- * Generate Vote and ZKP.
+ * Whether a proof in the given format version hashed its challenge from
+ * decimal strings, as proofs made before transcripts did. Only version 1
+ * proofs did, and those were all made in the RFC 5114 group.
  */
-std::tuple<Vote_Struct, VoteZKP_Struct, CryptoPP::Integer>
-ElectionClient::GenerateVote(CryptoPP::Integer vote, CryptoPP::Integer pk) {
-  // TODO: implement me!
-  CryptoPP::AutoSeededRandomPool a_seed;
-  CryptoPP::Integer r(a_seed, 1, DL_P-1);
+bool LegacyChallenge(const GroupContext &group, int version) {
+  return version == 1 && &group == &DLGroup();
+}
+
+/**
+ * The challenge of a vote proof, c_0 + c_1.
+ */
+Scalar VoteChallenge(const GroupContext &group, const FixedBaseTable &pk,
+                     const Vote_Struct &vote, const VoteZKP_Struct &zkp) {
+  Transcript transcript("vote", group.Name());
+  transcript.Absorb(pk.GetBase());
+  for (const GroupElement *x :
+       {&vote.a, &vote.b, &zkp.a0, &zkp.b0, &zkp.a1, &zkp.b1}) {
+    transcript.Absorb(*x);
+  }
+  return transcript.Challenge(group.ScalarOrder());
+}
+
+/**
+ * Whether c is the challenge of a vote proof, hashed from a transcript or,
+ * for a proof made before transcripts, from decimal strings; the proof's
+ * format version says which.
+ */
+bool VoteChallengeMatches(const GroupContext &group, const FixedBaseTable &pk,
+                          const Vote_Struct &vote, const VoteZKP_Struct &zkp,
+                          const Scalar &c) {
+  if (!LegacyChallenge(group, zkp.format_version)) {
+    return c == VoteChallenge(group, pk, vote, zkp);
+  }
+  return c == group.ReduceScalar(hash_vote_zkp(pk.GetBase(), vote.a.ToInteger(), vote.b.ToInteger(),
+                                               zkp.a0.ToInteger(), zkp.b0.ToInteger(), zkp.a1.ToInteger(),
+                                               zkp.b1.ToInteger()));
+}
+
+/**
+ * The challenge of a count proof, the sum of the c_i.
+ */
+Scalar CountChallenge(const GroupContext &group, const FixedBaseTable &pk,
+                      const Vote_Struct &vote_count,
+                      std::span<const Count_ZKP_Struct> count_zkps) {
+  Transcript transcript("count", group.Name());
+  transcript.Absorb(pk.GetBase());
+  transcript.Absorb(vote_count.a);
+  transcript.Absorb(vote_count.b);
+  for (auto &count_zkp : count_zkps) {
+    transcript.Absorb(count_zkp.a_i);
+    transcript.Absorb(count_zkp.b_i);
+  }
+  return transcript.Challenge(group.ScalarOrder());
+}
+
+/**
+ * VoteChallengeMatches for a count proof, whose list is in the given format
+ * version.
+ */
+bool CountChallengeMatches(const GroupContext &group, const FixedBaseTable &pk,
+                           const Vote_Struct &vote_count,
+                           std::span<const Count_ZKP_Struct> count_zkps,
+                           int version, const Scalar &c) {
+  if (!LegacyChallenge(group, version)) {
+    return c == CountChallenge(group, pk, vote_count, count_zkps);
+  }
+  std::vector<CryptoPP::Integer> a_vec;
+  std::vector<CryptoPP::Integer> b_vec;
+  for (auto &count_zkp : count_zkps) {
+    a_vec.push_back(count_zkp.a_i.ToInteger());
+    b_vec.push_back(count_zkp.b_i.ToInteger());
+  }
+  return c == group.ReduceScalar(hash_count_zkp(pk.GetBase(), vote_count.a.ToInteger(),
+                                                vote_count.b.ToInteger(), a_vec, b_vec));
+}
+
+/**
+ * The challenge sigma of a partial decryption proof with commitments u and
+ * v, under the arbiter's key pk.
+ */
+Scalar DecryptionChallenge(const GroupContext &group,
+                           const CryptoPP::Integer &pk,
+                           const Vote_Struct &ciphertext,
+                           const GroupElement &u, const GroupElement &v) {
+  Transcript transcript("decryption", group.Name());
+  transcript.Absorb(pk);
+  for (const GroupElement *x : {&ciphertext.a, &ciphertext.b, &u, &v}) {
+    transcript.Absorb(*x);
+  }
+  return transcript.Challenge(group.ScalarOrder());
+}
+
+/**
+ * Checks g^s * pk^{-sigma} = v and c1^s * d^{-sigma} = u for a partial
+ * decryption d of a ciphertext with first component c1.
+ */
+bool DecryptionEquationsHold(const GroupContext &group,
+                             const GroupElement &pk_inv,
+                             const GroupElement &c1, const GroupElement &d,
+                             const DecryptionZKP_Struct &zkp,
+                             const Scalar &sigma) {
+  MultiExponentiation g_s(group);
+  g_s.Add(group.Generator(), zkp.s);
+  g_s.Add(pk_inv, sigma);
+
+  MultiExponentiation c1_s(group);
+  c1_s.Add(c1, zkp.s);
+  c1_s.Add(group.Inverse(d), sigma);
+
+  return g_s.Evaluate() == zkp.v && c1_s.Evaluate() == zkp.u;
+}
+
+/**
+ * Checks a compact partial decryption proof, which carries sigma in place of
+ * u and v: recomputes them as g^s * pk^{-sigma} and c1^s * d^{-sigma}, and
+ * checks that sigma is their challenge.
+ */
+bool CompactDecryptionProofHolds(const GroupContext &group,
+                                 const CryptoPP::Integer &pk,
+                                 const GroupElement &pk_inv,
+                                 const Vote_Struct &ciphertext,
+                                 const GroupElement &d,
+                                 const DecryptionZKP_Struct &zkp) {
+  MultiExponentiation v(group);
+  v.Add(group.Generator(), zkp.s);
+  v.Add(pk_inv, zkp.sigma);
+
+  MultiExponentiation u(group);
+  u.Add(ciphertext.a, zkp.s);
+  u.Add(group.Inverse(d), zkp.sigma);
+
+  return zkp.sigma == DecryptionChallenge(group, pk, ciphertext, u.Evaluate(), v.Evaluate());
+}
+
+/**
+ * Samples the nonce w of a real proof branch and its commitments.
+ */
+ProofCommitment PrecomputeCommitment(const GroupContext &group,
+                                     const FixedBaseTable &pk) {
+  ProofCommitment commitment;
+  commitment.w = group.RandomScalar();
+  commitment.g_w = group.Generator().Exponentiate(commitment.w);
+  commitment.pk_w = pk.Exponentiate(commitment.w);
+  return commitment;
+}
+
+/**
+ * Samples a simulated proof branch. Its response will be t + r * c for the
+ * ciphertext's randomness r, which makes g^t and pk^t (times a power of g)
+ * its commitments whatever the ciphertext turns out to be.
+ */
+ProofSimulation PrecomputeSimulation(const GroupContext &group,
+                                     const FixedBaseTable &pk) {
+  ProofSimulation simulation;
+  simulation.c = group.RandomScalar();
+  simulation.t = group.RandomScalar();
+  simulation.g_t = group.Generator().Exponentiate(simulation.t);
+  simulation.pk_t = pk.Exponentiate(simulation.t);
+  simulation.g_c = group.Generator().Exponentiate(simulation.c);
+  simulation.g_neg_c = group.Generator().Exponentiate(group.ScalarSubtract(Scalar(), simulation.c));
+  return simulation;
+}
+
+/**
+ * Samples everything about one vote that does not depend on the vote.
+ */
+PrecomputedVote PrecomputeVote(const GroupContext &group,
+                               const FixedBaseTable &pk) {
+  PrecomputedVote pre;
+  pre.r = group.RandomScalar();
+  pre.a = group.Generator().Exponentiate(pre.r);
+  pre.pk_r = pk.Exponentiate(pre.r);
+  pre.real = PrecomputeCommitment(group, pk);
+  pre.simulated = PrecomputeSimulation(group, pk);
+  return pre;
+}
+
+/**
+ * Finishes a simulated branch claiming that a ciphertext with randomness r
+ * encrypts `claimed` when it encrypts `actual`:
+ * a' = g^t, b' = pk^t * g^{(claimed - actual) * c}, response = t + r * c.
+ */
+void SimulateBranch(const GroupContext &group,
+                    const ProofSimulation &simulation, int claimed, int actual,
+                    const Scalar &r, GroupElement *a, GroupElement *b,
+                    Scalar *response) {
+  GroupProduct b_product(group);
+  b_product.Multiply(simulation.pk_t);
+  for (int i = std::min(claimed, actual); i < std::max(claimed, actual); i++) {
+    b_product.Multiply(claimed > actual ? simulation.g_c : simulation.g_neg_c);
+  }
+
+  *a = simulation.g_t;
+  *b = b_product.Value();
+  *response = group.ScalarAdd(simulation.t, group.ScalarMultiply(r, simulation.c));
+}
+
+/**
+ * Generates a vote and its zkp from a precomputation; only multiplications
+ * and the hash remain.
+ */
+std::tuple<Vote_Struct, VoteZKP_Struct, Scalar>
+FinishVote(const GroupContext &group, const PrecomputedVote &pre,
+           const CryptoPP::Integer &vote, const FixedBaseTable &pk) {
+  Scalar r = pre.r;
 
   // g^r
-  CryptoPP::Integer a = CryptoPP::ModularExponentiation(DL_G, r, DL_P);
-  
-  CryptoPP::Integer pk_r = CryptoPP::ModularExponentiation(pk, r, DL_P);
-  CryptoPP::Integer g_v = CryptoPP::ModularExponentiation(DL_G, vote, DL_P);
+  GroupElement a = pre.a;
 
   // g^v * pk^r
-  CryptoPP::Integer b = (pk_r * g_v) % DL_P;
+  GroupElement b = group.Multiply(pre.pk_r, group.Generator().Exponentiate(group.ReduceScalar(vote)));
 
   Vote_Struct vote_struct;
   vote_struct.a = a;
@@ -36,159 +236,284 @@ ElectionClient::GenerateVote(CryptoPP::Integer vote, CryptoPP::Integer pk) {
   // handle zero in the default case
   if (vote == CryptoPP::Integer::Zero()) {
 
-    // c1
-    CryptoPP::AutoSeededRandomPool a_c1;
-    CryptoPP::Integer c1(a_c1, 1, DL_Q-1);
-    zkp.c1 = c1;
+    // simulate the proof that v = 1: a_1', b_1', r_1''
+    SimulateBranch(group, pre.simulated, 1, 0, r, &zkp.a1, &zkp.b1, &zkp.r1);
+    zkp.c1 = pre.simulated.c;
+
+    // a_0', b_0'
+    zkp.a0 = pre.real.g_w;
+    zkp.b0 = pre.real.pk_w;
+
+    // c
+    Scalar c = VoteChallenge(group, pk, vote_struct, zkp);
+    zkp.c0 = group.ScalarSubtract(c, zkp.c1);
+
+    // r_0''
+    zkp.r0 = group.ScalarAdd(pre.real.w, group.ScalarMultiply(zkp.c0, r));
+  } else {
+
+    // simulate the proof that v = 0: a_0', b_0', r_0''
+    SimulateBranch(group, pre.simulated, 0, 1, r, &zkp.a0, &zkp.b0, &zkp.r0);
+    zkp.c0 = pre.simulated.c;
+
+    // a_1', b_1'
+    zkp.a1 = pre.real.g_w;
+    zkp.b1 = pre.real.pk_w;
+
+    //c_1
+    Scalar c = VoteChallenge(group, pk, vote_struct, zkp);
+    zkp.c1 = group.ScalarSubtract(c, zkp.c0);
 
     // r_1''
-    CryptoPP::AutoSeededRandomPool a_r1_p;
-    CryptoPP::Integer r1_p(a_r1_p, 1, DL_Q-1);
-    zkp.r1 = r1_p;
+    zkp.r1 = group.ScalarAdd(pre.real.w, group.ScalarMultiply(zkp.c1, r));
+  }
 
-    // b'
-    CryptoPP::Integer b_p = (b * CryptoPP::EuclideanMultiplicativeInverse(DL_G, DL_P)) % DL_P;
+  return std::make_tuple(vote_struct, zkp, r);
+}
 
-    // a_1'
-    CryptoPP::Integer a_c1_inv = CryptoPP::EuclideanMultiplicativeInverse(CryptoPP::ModularExponentiation(a, zkp.c1, DL_P), DL_P);
-    zkp.a1 = (CryptoPP::ModularExponentiation(DL_G, zkp.r1, DL_P) * a_c1_inv) % DL_P;
+/**
+ * The product of the given ciphertexts, in the given format version.
+ */
+Vote_Struct ProductOfVotes(const GroupContext &group,
+                           std::span<const Vote_Struct> votes, int version) {
+  GroupProduct a_product(group);
+  GroupProduct b_product(group);
+  for (auto &vote : votes) {
+    a_product.Multiply(vote.a);
+    b_product.Multiply(vote.b);
+  }
 
-    // b_1'
-    CryptoPP::Integer b_p_c1_inv = CryptoPP::EuclideanMultiplicativeInverse(CryptoPP::ModularExponentiation(b_p, zkp.c1, DL_P), DL_P);
-    zkp.b1 = (CryptoPP::ModularExponentiation(pk, zkp.r1, DL_P) * b_p_c1_inv) % DL_P;
-    
-    CryptoPP::AutoSeededRandomPool a_r0;
-    CryptoPP::Integer r0(a_r0, 1, DL_Q-1);
+  Vote_Struct vote_count;
+  vote_count.a = a_product.Value();
+  vote_count.b = b_product.Value();
+  vote_count.format_version = version;
+  return vote_count;
+}
 
-    // a_0'
-    zkp.a0 = CryptoPP::ModularExponentiation(DL_G, r0, DL_P);
+/**
+ * Generates the vote count and its zkps from a precomputed real branch and
+ * one simulated branch per count.
+ */
+std::pair<Vote_Struct, Count_ZKPs_Struct>
+FinishCountZKPs(const GroupContext &group, std::span<const Vote_Struct> votes,
+                int num_votes, int k, const Scalar &r,
+                const FixedBaseTable &pk, const ProofCommitment &real,
+                const std::vector<ProofSimulation> &simulated) {
+  // the vote count, as CountVotes gives it for a ballot of these votes
+  Vote_Struct collective_vote = ProductOfVotes(group, votes, MESSAGE_FORMAT_VERSION);
 
-    // b_0'
-    zkp.b0 = CryptoPP::ModularExponentiation(pk, r0, DL_P);
+  // simulate zkp for every i not equal to `num_votes`
+  std::vector<Count_ZKP_Struct> count_zkps;
+  count_zkps.reserve(k + 1);
+  Scalar c_sum;
+  for (int i=0; i<=k; i++) { // max number of votes that could have been casted
+    Count_ZKP_Struct count_zkp;
+    if (i != num_votes) {
+      SimulateBranch(group, simulated[i], i, num_votes, r, &count_zkp.a_i,
+                     &count_zkp.b_i, &count_zkp.r_i);
+      count_zkp.c_i = simulated[i].c;
+      c_sum = group.ScalarAdd(c_sum, count_zkp.c_i);
+    }
+    count_zkps.push_back(count_zkp);
+  }
 
-    // c
-    CryptoPP::Integer c = hash_vote_zkp(pk, a, b, zkp.a0, zkp.b0, zkp.a1, zkp.b1);
-    zkp.c0 = (c - zkp.c1) % DL_Q;
+  if (num_votes <= k) {
+    // zkp for `num_votes`
+    Count_ZKP_Struct &num_votes_zkp = count_zkps[num_votes];
+    num_votes_zkp.a_i = real.g_w;
+    num_votes_zkp.b_i = real.pk_w;
 
-    // r_0''
-    zkp.r0 = (r0 + ((zkp.c0 * r) % DL_Q)) % DL_Q;
-  } else {
-    
-    // c_0
-    CryptoPP::AutoSeededRandomPool a_c0;
-    CryptoPP::Integer c0(a_c0, 1, DL_Q-1);
-    zkp.c0 = c0;
+    Scalar c = CountChallenge(group, pk, collective_vote, count_zkps);
+    Scalar c_i = group.ScalarSubtract(c, c_sum);
 
-    // r_0''
-    CryptoPP::AutoSeededRandomPool a_r0_p;
-    CryptoPP::Integer r0_p(a_r0_p, 1, DL_Q-1);
-    zkp.r0 = r0_p;
+    num_votes_zkp.c_i = c_i;
+    num_votes_zkp.r_i = group.ScalarAdd(real.w, group.ScalarMultiply(c_i, r));
+  }
+
+  Count_ZKPs_Struct count_zkps_struct;
+  count_zkps_struct.count_zkps = std::move(count_zkps);
+
+  return std::make_pair(collective_vote, std::move(count_zkps_struct));
+}
+
+/**
+ * Checks that a precomputed ballot was made for this key and ballot shape.
+ */
+void CheckPrecomputedBallot(const PrecomputedBallot &pre, int num_candidates,
+                            int k, const FixedBaseTable &pk) {
+  if (pre.pk != pk.GetBase() || pre.votes.size() != num_candidates ||
+      pre.count_simulated.size() != k + 1) {
+    throw std::runtime_error("precomputed ballot does not match the election");
+  }
+}
 
-    // a_0'
-    CryptoPP::Integer a_c0_inv = CryptoPP::EuclideanMultiplicativeInverse(CryptoPP::ModularExponentiation(a, zkp.c0, DL_P), DL_P);
-    zkp.a0 = (CryptoPP::ModularExponentiation(DL_G, zkp.r0, DL_P) * a_c0_inv) % DL_P;
+/**
+ * Verifies one vote zkp per vote.
+ */
+bool VoteProofsHold(const GroupContext &group,
+                    std::span<const Vote_Struct> votes,
+                    std::span<const VoteZKP_Struct> zkps,
+                    const FixedBaseTable &pk) {
+  if (votes.size() != zkps.size()) {
+    return false;
+  }
+  for (int i=0; i<votes.size(); i++) { // iterate over each vote casted by a voter
+    if (!(ElectionClient::VerifyVoteZKP(group, votes[i], zkps[i], pk))) {
+      return false;
+    }
+  }
+  return true;
+}
 
-    // b_0'
-    CryptoPP::Integer b_c0_inv = CryptoPP::EuclideanMultiplicativeInverse(CryptoPP::ModularExponentiation(b, zkp.c0, DL_P), DL_P);
-    zkp.b0 = (CryptoPP::ModularExponentiation(pk, zkp.r0, DL_P) * b_c0_inv) % DL_P;
+/**
+ * Verifies the count zkps of a ballot, in the given format version, against
+ * its vote count, recomputed by the caller.
+ */
+bool CountProofsHold(const GroupContext &group, const Vote_Struct &vote_count,
+                     std::span<const Count_ZKP_Struct> proofs, int version,
+                     const FixedBaseTable &pk) {
+  GroupElement a = vote_count.a;
+  GroupElement b = vote_count.b;
 
-    CryptoPP::AutoSeededRandomPool a_r1;
-    CryptoPP::Integer r1(a_r1, 1, DL_Q-1);
+  Scalar c_sum;
+  std::vector<Count_ZKP_Struct> count_zkps(proofs.begin(), proofs.end());
 
-    // a_1'
-    zkp.a1 = CryptoPP::ModularExponentiation(DL_G, r1, DL_P);
+  if (!group.IsElement(a) || !group.IsElement(b)) {
+    return false;
+  }
+  GroupElement a_inv = group.Inverse(a);
+  GroupElement b_inv = group.Inverse(b);
 
-    // b_1'
-    zkp.b1 = CryptoPP::ModularExponentiation(pk, r1, DL_P);
+  // Recomputes the commitments, as VerifyVoteZKP does.
+  for (int i=0; i<count_zkps.size(); i++) {
+    Count_ZKP_Struct &count_zkp = count_zkps[i];
 
-    //c_1
-    CryptoPP::Integer c = hash_vote_zkp(pk, a, b, zkp.a0, zkp.b0, zkp.a1, zkp.b1);
-    zkp.c1 = (c - zkp.c0) % DL_Q;
+    // g^{r_i} * a^{-c_i} = a_i
+    MultiExponentiation a_i(group);
+    a_i.Add(group.Generator(), count_zkp.r_i);
+    a_i.Add(a_inv, count_zkp.c_i);
 
-    // r_1''
-    zkp.r1 = (r1 + ((zkp.c1 * r) % DL_Q)) % DL_Q;
+    // pk^{r_i} * (b/g^i)^{-c_i} = pk^{r_i} * g^{i*c_i} * b^{-c_i} = b_i
+    MultiExponentiation b_i(group);
+    b_i.Add(pk, count_zkp.r_i);
+    b_i.Add(group.Generator(), group.ScalarMultiply(Scalar::FromWord(i), count_zkp.c_i));
+    b_i.Add(b_inv, count_zkp.c_i);
+
+    count_zkp.a_i = a_i.Evaluate();
+    count_zkp.b_i = b_i.Evaluate();
+
+    c_sum = group.ScalarAdd(c_sum, count_zkp.c_i);
   }
 
-  return std::make_tuple(vote_struct, zkp, r);
+  return CountChallengeMatches(group, pk, vote_count, count_zkps, version, c_sum);
+}
+} // namespace
+
+/**
+ * Generate Vote and ZKP.
+ */
+std::tuple<Vote_Struct, VoteZKP_Struct, Scalar>
+ElectionClient::GenerateVote(const GroupContext &group, const CryptoPP::Integer &vote, const FixedBaseTable &pk) {
+  // TODO: implement me!
+  return FinishVote(group, PrecomputeVote(group, pk), vote, pk);
 }
 
 /**
  * Generates votes and zkps
 */
-std::tuple<Votes_Struct, VoteZKPs_Struct, CryptoPP::Integer>
-ElectionClient::GenerateVotes(std::vector<CryptoPP::Integer> votes, CryptoPP::Integer pk) {
-
-  std::vector<Vote_Struct> votes_vec;
-  std::vector<VoteZKP_Struct> zkps_vec;
-  CryptoPP::Integer r = CryptoPP::Integer::Zero();
+std::tuple<Votes_Struct, VoteZKPs_Struct, Scalar>
+ElectionClient::GenerateVotes(const GroupContext &group, const std::vector<CryptoPP::Integer> &votes, const FixedBaseTable &pk) {
+  PrecomputedBallot pre;
+  pre.pk = pk.GetBase();
+  for (int i=0; i<votes.size(); i++) {
+    pre.votes.push_back(PrecomputeVote(group, pk));
+  }
+  return ElectionClient::GenerateVotes(group, votes, pk, pre);
+}
 
-  for (auto &vote : votes) {
-    std::tuple<Vote_Struct, VoteZKP_Struct, CryptoPP::Integer> vote_and_zkp = ElectionClient::GenerateVote(vote, pk);
-    votes_vec.push_back(std::get<0>(vote_and_zkp));
-    zkps_vec.push_back(std::get<1>(vote_and_zkp));
-    r += std::get<2>(vote_and_zkp);
+/**
+ * Generates votes and zkps from a precomputed ballot.
+*/
+std::tuple<Votes_Struct, VoteZKPs_Struct, Scalar>
+ElectionClient::GenerateVotes(const GroupContext &group, const std::vector<CryptoPP::Integer> &votes, const FixedBaseTable &pk,
+                              const PrecomputedBallot &pre) {
+  if (pre.pk != pk.GetBase() || pre.votes.size() != votes.size()) {
+    throw std::runtime_error("precomputed ballot does not match the election");
   }
+
   Votes_Struct votes_struct;
-  votes_struct.votes = votes_vec;
+  votes_struct.votes.reserve(votes.size());
   VoteZKPs_Struct zkps_struct;
-  zkps_struct.zkps = zkps_vec;
+  zkps_struct.zkps.reserve(votes.size());
+  Scalar r;
+
+  for (int i=0; i<votes.size(); i++) {
+    std::tuple<Vote_Struct, VoteZKP_Struct, Scalar> vote_and_zkp = FinishVote(group, pre.votes[i], votes[i], pk);
+    votes_struct.votes.push_back(std::get<0>(vote_and_zkp));
+    zkps_struct.zkps.push_back(std::get<1>(vote_and_zkp));
+    r = group.ScalarAdd(r, std::get<2>(vote_and_zkp));
+  }
 
-  return std::make_tuple(votes_struct, zkps_struct, r);
+  return std::make_tuple(std::move(votes_struct), std::move(zkps_struct), r);
 }
 
 /**
  * Verify vote zkp.
  */
-bool ElectionClient::VerifyVoteZKP(std::pair<Vote_Struct, VoteZKP_Struct> vote,
-                                   CryptoPP::Integer pk) {
+bool ElectionClient::VerifyVoteZKP(const GroupContext &group,
+                                   const Vote_Struct &vote_info,
+                                   const VoteZKP_Struct &proof,
+                                   const FixedBaseTable &pk) {
   // TODO: implement me!
-  Vote_Struct vote_info = vote.first;
-  VoteZKP_Struct zkp = vote.second;
-
-  // g^{r_0''} = a_0' * a^{c_0}
-  CryptoPP::Integer g_r0 = CryptoPP::ModularExponentiation(DL_G, zkp.r0, DL_P);
-  CryptoPP::Integer g_r0_check = 
-    (zkp.a0 * CryptoPP::ModularExponentiation(vote_info.a, zkp.c0, DL_P)) % DL_P;
-
-  // g^{r_1''} = a_1' * a^{c_1}
-  CryptoPP::Integer g_r1 = CryptoPP::ModularExponentiation(DL_G, zkp.r1, DL_P);
-  CryptoPP::Integer g_r1_check = 
-    (zkp.a1 * CryptoPP::ModularExponentiation(vote_info.a, zkp.c1, DL_P)) % DL_P;
-
-  // pk^{r_0''} = b_0' * b^{c_0}
-  CryptoPP::Integer pk_r0 = CryptoPP::ModularExponentiation(pk, zkp.r0, DL_P);
-  CryptoPP::Integer pk_r0_check = 
-    (zkp.b0 * CryptoPP::ModularExponentiation(vote_info.b, zkp.c0, DL_P)) % DL_P;
-
-  // pk^{r_1''} = b_1' * (b/g)^{c_1}
-  CryptoPP::Integer pk_r1 = CryptoPP::ModularExponentiation(pk, zkp.r1, DL_P);
-  CryptoPP::Integer b_p = 
-    (vote_info.b * CryptoPP::EuclideanMultiplicativeInverse(DL_G, DL_P)) % DL_P;
-  CryptoPP::Integer pk_r1_check = 
-    (zkp.b1 * CryptoPP::ModularExponentiation(b_p, zkp.c1, DL_P)) % DL_P;
+  // a copy to recompute the commitments into
+  VoteZKP_Struct zkp = proof;
 
-  // c_0 + c_1 = H(...)
-  CryptoPP::Integer c0_plus_c1 = (zkp.c0 + zkp.c1) % DL_Q;
-  CryptoPP::Integer c = hash_vote_zkp(pk, vote_info.a, vote_info.b, zkp.a0, zkp.b0, zkp.a1, zkp.b1) % DL_Q;
+  if (!group.IsElement(vote_info.a) || !group.IsElement(vote_info.b)) {
+    return false;
+  }
+
+  // The commitments follow from the challenges and responses, so they are
+  // recomputed rather than read: a compact proof does not carry them.
+  GroupElement a_inv = group.Inverse(vote_info.a);
+  GroupElement b_inv = group.Inverse(vote_info.b);
+
+  // g^{r_0''} * a^{-c_0} = a_0'
+  MultiExponentiation a0(group);
+  a0.Add(group.Generator(), zkp.r0);
+  a0.Add(a_inv, zkp.c0);
+
+  // g^{r_1''} * a^{-c_1} = a_1'
+  MultiExponentiation a1(group);
+  a1.Add(group.Generator(), zkp.r1);
+  a1.Add(a_inv, zkp.c1);
+
+  // pk^{r_0''} * b^{-c_0} = b_0'
+  MultiExponentiation b0(group);
+  b0.Add(pk, zkp.r0);
+  b0.Add(b_inv, zkp.c0);
+
+  // pk^{r_1''} * (b/g)^{-c_1} = pk^{r_1''} * g^{c_1} * b^{-c_1} = b_1'
+  MultiExponentiation b1(group);
+  b1.Add(pk, zkp.r1);
+  b1.Add(group.Generator(), zkp.c1);
+  b1.Add(b_inv, zkp.c1);
+
+  zkp.a0 = a0.Evaluate();
+  zkp.a1 = a1.Evaluate();
+  zkp.b0 = b0.Evaluate();
+  zkp.b1 = b1.Evaluate();
 
-  return (g_r0 == g_r0_check) && (g_r1 == g_r1_check) && (pk_r0 == pk_r0_check) && (pk_r1 == pk_r1_check) && (c0_plus_c1 == c);
+  // c_0 + c_1 = H(...)
+  Scalar c0_plus_c1 = group.ScalarAdd(zkp.c0, zkp.c1);
+  return VoteChallengeMatches(group, pk, vote_info, zkp, c0_plus_c1);
 }
 
 /**
  * Verifies vote zkps
 */
-bool ElectionClient::VerifyVoteZKPs(std::pair<Votes_Struct, VoteZKPs_Struct> votes, CryptoPP::Integer pk) {
-  std::vector<Vote_Struct> vote_structs = votes.first.votes;
-  std::vector<VoteZKP_Struct> zkps_structs = votes.second.zkps;
-
-  for (int i=0; i<vote_structs.size(); i++) { // iterate over each vote casted by a voter
-    std::pair<Vote_Struct, VoteZKP_Struct> vote = std::make_pair(vote_structs[i], zkps_structs[i]);
-    if (!(ElectionClient::VerifyVoteZKP(vote, pk))) {
-      return false;
-    }
-  }
-
-  return true;
+bool ElectionClient::VerifyVoteZKPs(const GroupContext &group, const Votes_Struct &votes, const VoteZKPs_Struct &zkps,
+                                    const FixedBaseTable &pk) {
+  return VoteProofsHold(group, votes.votes, zkps.zkps, pk);
 }
 
 /**
@@ -197,208 +522,673 @@ bool ElectionClient::VerifyVoteZKPs(std::pair<Votes_Struct, VoteZKPs_Struct> vot
  * Count_ZKPs_Struct: OR ZKP for each number of allowable votes
 */
 std::pair<Vote_Struct, Count_ZKPs_Struct> 
-ElectionClient::GenerateCountZKPs(std::vector<Vote_Struct> votes, int num_votes, int k,
-                                  CryptoPP::Integer r, CryptoPP::Integer pk) {
-  
+ElectionClient::GenerateCountZKPs(const GroupContext &group, std::span<const Vote_Struct> votes, int num_votes, int k,
+                                  const Scalar &r, const FixedBaseTable &pk) {
+  std::vector<ProofSimulation> simulated;
+  for (int i=0; i<=k; i++) {
+    simulated.push_back(PrecomputeSimulation(group, pk));
+  }
+  return FinishCountZKPs(group, votes, num_votes, k, r, pk,
+                         PrecomputeCommitment(group, pk), simulated);
+}
 
-  // Create Vote_Struct
-  CryptoPP::Integer c1 = CryptoPP::Integer::One();
-  CryptoPP::Integer c2 = CryptoPP::Integer::One();
+/**
+ * Generates vote count zkp from a precomputed ballot.
+*/
+std::pair<Vote_Struct, Count_ZKPs_Struct>
+ElectionClient::GenerateCountZKPs(const GroupContext &group, std::span<const Vote_Struct> votes, int num_votes, int k,
+                                  const Scalar &r, const FixedBaseTable &pk,
+                                  const PrecomputedBallot &pre) {
+  CheckPrecomputedBallot(pre, votes.size(), k, pk);
+  return FinishCountZKPs(group, votes, num_votes, k, r, pk, pre.count_real,
+                         pre.count_simulated);
+}
 
-  for (int i=0; i<votes.size(); i++) {
-    c1 = (c1 * votes[i].a) % DL_P;
-    c2 = (c2 * votes[i].b) % DL_P;
+/**
+ * Samples everything about a ballot that does not depend on its votes, so
+ * it can be prepared before the voter chooses them.
+ */
+PrecomputedBallot ElectionClient::PrecomputeBallot(const GroupContext &group, int num_candidates, int k,
+                                                   const FixedBaseTable &pk) {
+  PrecomputedBallot pre;
+  pre.pk = pk.GetBase();
+  for (int i=0; i<num_candidates; i++) {
+    pre.votes.push_back(PrecomputeVote(group, pk));
+  }
+  pre.count_real = PrecomputeCommitment(group, pk);
+  for (int i=0; i<=k; i++) {
+    pre.count_simulated.push_back(PrecomputeSimulation(group, pk));
   }
+  return pre;
+}
 
-  Vote_Struct collective_vote;
-  collective_vote.a = c1;
-  collective_vote.b = c2;
+/**
+ * Multiplies the per-candidate ciphertexts of a ballot into the encryption
+ * of its vote count. It is in the format version of votes, so it signs the
+ * same as the count stored with ballots of that version.
+ */
+Vote_Struct ElectionClient::CountVotes(const GroupContext &group, const Votes_Struct &votes) {
+  return ProductOfVotes(group, votes.votes, votes.format_version);
+}
 
-  // simulate zkp for every i not equal to `num_votes`
-  std::vector<Count_ZKP_Struct> count_zkps;
-  CryptoPP::Integer c_sum = CryptoPP::Integer::Zero();
-  for (int i=0; i<=k; i++) { // max number of votes that could have been casted
-    if (i == num_votes) {
-      Count_ZKP_Struct count_zkp;
-      count_zkps.push_back(count_zkp);
-      continue;
-    }
+/**
+ * CountVotes for a ballot of a BallotBatch.
+ */
+Vote_Struct ElectionClient::CountVotes(const GroupContext &group, const BallotView &ballot) {
+  return ProductOfVotes(group, ballot.votes, ballot.votes_version);
+}
 
-    // update c_sum
-    CryptoPP::AutoSeededRandomPool seed1;
-    CryptoPP::Integer c(seed1, 1, DL_Q-1);
-    c_sum = (c_sum + c) % DL_Q;
+/**
+ * Verifies vote count zkp. The vote count must be CountVotes of the ballot,
+ * recomputed by the caller, never one the ballot came with.
+*/
+bool ElectionClient::VerifyCountZKPs(const GroupContext &group, const Vote_Struct &vote_count,
+                                     const Count_ZKPs_Struct &count_zkps, const FixedBaseTable &pk) {
+  return CountProofsHold(group, vote_count, count_zkps.count_zkps, count_zkps.format_version, pk);
+}
 
-    CryptoPP::AutoSeededRandomPool seed2;
-    CryptoPP::Integer r_pp(seed2, 1, DL_Q-1);
 
-    CryptoPP::Integer pow(i);
+namespace {
+// Ballots per batch equation; a failing batch is bisected.
+const int BATCH_SIZE = 256;
+// Bit length of the random weight on each equation in a batch.
+const int BATCH_WEIGHT_BITS = 64;
+// Ballots transposed into columns at a time when combining; a chunk's
+// column stays in cache while it is multiplied. Chunks shrink to give every
+// thread one, down to the minimum.
+const int COLUMN_CHUNK = 1024;
+const int MIN_COLUMN_CHUNK = 64;
 
-    CryptoPP::Integer g_pow = CryptoPP::ModularExponentiation(DL_G, pow, DL_P);
-    CryptoPP::Integer b_p = (c2 * CryptoPP::EuclideanMultiplicativeInverse(g_pow, DL_P)) % DL_P;
+/**
+ * Whether a ballot has one vote and vote proof per candidate and k + 1
+ * count proofs.
+ */
+bool BallotShapeMatches(const BallotView &ballot, int num_candidates, int k) {
+  return ballot.votes.size() == num_candidates &&
+         ballot.zkps.size() == num_candidates &&
+         ballot.count_zkps.size() == k + 1;
+}
 
-    CryptoPP::Integer g_r_pp = CryptoPP::ModularExponentiation(DL_G, r_pp, DL_P);
-    CryptoPP::Integer a_c_i = CryptoPP::ModularExponentiation(c1, c, DL_P);
+/**
+ * Whether a ballot's proofs were read with their commitments, which the
+ * batch equation needs. Compact proofs, from version 3 on, do not carry
+ * them.
+ */
+bool BallotCarriesCommitments(const BallotView &ballot) {
+  return ballot.zkps_version < 3 && ballot.count_zkps_version < 3;
+}
 
-    CryptoPP::Integer pk_r_pp = CryptoPP::ModularExponentiation(pk, r_pp, DL_P);
-    CryptoPP::Integer b_p_c_i = CryptoPP::ModularExponentiation(b_p, c, DL_P);
+/**
+ * Checks everything about a ballot that is not one of the exponentiation
+ * equations: its shape, that every element is in range, and its
+ * Fiat-Shamir challenges. Sets vote_count to the ballot's, recomputed from
+ * its votes.
+ */
+bool BallotWellFormed(const GroupContext &group, const BallotView &ballot,
+                      int num_candidates, int k, const FixedBaseTable &pk,
+                      Vote_Struct *vote_count) {
+  std::span<const Vote_Struct> votes = ballot.votes;
+  std::span<const VoteZKP_Struct> zkps = ballot.zkps;
+  std::span<const Count_ZKP_Struct> count_zkps = ballot.count_zkps;
+  if (!BallotShapeMatches(ballot, num_candidates, k)) {
+    return false;
+  }
 
-    Count_ZKP_Struct count_zkp;
-    count_zkp.a_i = (g_r_pp * CryptoPP::EuclideanMultiplicativeInverse(a_c_i, DL_P)) % DL_P;
-    count_zkp.b_i = (pk_r_pp * CryptoPP::EuclideanMultiplicativeInverse(b_p_c_i, DL_P)) % DL_P;
-    count_zkp.c_i = c;
-    count_zkp.r_i = r_pp;
-    count_zkps.push_back(count_zkp);
+  for (int i = 0; i < votes.size(); i++) {
+    const Vote_Struct &vote = votes[i];
+    const VoteZKP_Struct &zkp = zkps[i];
+    for (const GroupElement *x :
+         {&vote.a, &vote.b, &zkp.a0, &zkp.b0, &zkp.a1, &zkp.b1}) {
+      if (!group.IsElement(*x)) {
+        return false;
+      }
+    }
+    if (!VoteChallengeMatches(group, pk, vote, zkp, group.ScalarAdd(zkp.c0, zkp.c1))) {
+      return false;
+    }
   }
 
-  if (num_votes <= k) {
-    // zkp for `num_votes`
-    Count_ZKP_Struct &num_votes_zkp = count_zkps[num_votes];
+  *vote_count = ElectionClient::CountVotes(group, ballot);
+  Scalar c_sum;
+  for (auto &count_zkp : count_zkps) {
+    if (!group.IsElement(count_zkp.a_i) || !group.IsElement(count_zkp.b_i)) {
+      return false;
+    }
+    c_sum = group.ScalarAdd(c_sum, count_zkp.c_i);
+  }
+  return CountChallengeMatches(group, pk, *vote_count, count_zkps, ballot.count_zkps_version, c_sum);
+}
 
-    CryptoPP::AutoSeededRandomPool seed;
-    CryptoPP::Integer r_i(seed, 1, DL_Q-1);
-    num_votes_zkp.a_i = CryptoPP::ModularExponentiation(DL_G, r_i, DL_P);
-    num_votes_zkp.b_i = CryptoPP::ModularExponentiation(pk, r_i, DL_P);
+/**
+ * Returns a random weight in [1, 2^BATCH_WEIGHT_BITS).
+ */
+Scalar RandomWeight(CryptoPP::RandomNumberGenerator &rng) {
+  std::uint64_t weight = 0;
+  while (weight == 0) {
+    rng.GenerateBlock((CryptoPP::byte *)&weight, sizeof(weight));
+    weight >>= 64 - BATCH_WEIGHT_BITS;
+  }
+  return Scalar::FromWord(weight);
+}
+
+/**
+ * Checks every proof equation of the given ballots at once. Each equation
+ * x == y is raised to a random weight and all of them are multiplied
+ * together, so the generator and key terms collapse into one fixed-base
+ * exponentiation each and every other element is one term of a single
+ * multi-exponentiation. A set with a false equation passes with probability
+ * about 2^-BATCH_WEIGHT_BITS, for errors in the prime-order subgroup; every
+ * element in the equation must be in it (VerifyCommittedRange), as an error
+ * in a small-order component would pass with probability 1/order.
+ */
+bool BatchEquationHolds(const GroupContext &group,
+                        const std::vector<BallotView> &ballots,
+                        const std::vector<Vote_Struct> &vote_counts,
+                        const std::vector<int> &indices,
+                        const FixedBaseTable &pk) {
+  CryptoPP::RandomNumberGenerator &rng = ThreadRNG();
+
+  // g^{sum(...)} * pk^{sum(...)} on one side, everything else on the other
+  MultiExponentiation lhs(group);
+  MultiExponentiation rhs(group);
+  for (int index : indices) {
+    const BallotView &ballot = ballots[index];
+
+    for (int i = 0; i < ballot.votes.size(); i++) {
+      const Vote_Struct &vote = ballot.votes[i];
+      const VoteZKP_Struct &zkp = ballot.zkps[i];
+      Scalar d0 = RandomWeight(rng);
+      Scalar d1 = RandomWeight(rng);
+      Scalar d2 = RandomWeight(rng);
+      Scalar d3 = RandomWeight(rng);
+
+      // g^{r_0''} = a_0' * a^{c_0}
+      lhs.Add(group.Generator(), group.ScalarMultiply(d0, zkp.r0));
+      rhs.Add(zkp.a0, d0);
+      // g^{r_1''} = a_1' * a^{c_1}
+      lhs.Add(group.Generator(), group.ScalarMultiply(d1, zkp.r1));
+      rhs.Add(zkp.a1, d1);
+      rhs.Add(vote.a, group.ScalarAdd(group.ScalarMultiply(d0, zkp.c0), group.ScalarMultiply(d1, zkp.c1)));
+      // pk^{r_0''} = b_0' * b^{c_0}
+      lhs.Add(pk, group.ScalarMultiply(d2, zkp.r0));
+      rhs.Add(zkp.b0, d2);
+      // pk^{r_1''} * g^{c_1} = b_1' * b^{c_1}
+      lhs.Add(pk, group.ScalarMultiply(d3, zkp.r1));
+      lhs.Add(group.Generator(), group.ScalarMultiply(d3, zkp.c1));
+      rhs.Add(zkp.b1, d3);
+      rhs.Add(vote.b, group.ScalarAdd(group.ScalarMultiply(d2, zkp.c0), group.ScalarMultiply(d3, zkp.c1)));
+    }
 
-    std::vector<CryptoPP::Integer> a_vec;
-    std::vector<CryptoPP::Integer> b_vec;
-    for (int i=0; i<count_zkps.size(); i++) {
-      a_vec.push_back(count_zkps[i].a_i);
-      b_vec.push_back(count_zkps[i].b_i);
+    Scalar a_exponent;
+    Scalar b_exponent;
+    for (int i = 0; i < ballot.count_zkps.size(); i++) {
+      const Count_ZKP_Struct &count_zkp = ballot.count_zkps[i];
+      Scalar d0 = RandomWeight(rng);
+      Scalar d1 = RandomWeight(rng);
+
+      // g^{r_i} = a_i * a^{c_i}
+      lhs.Add(group.Generator(), group.ScalarMultiply(d0, count_zkp.r_i));
+      rhs.Add(count_zkp.a_i, d0);
+      a_exponent = group.ScalarAdd(a_exponent, group.ScalarMultiply(d0, count_zkp.c_i));
+      // pk^{r_i} * g^{i*c_i} = b_i * b^{c_i}
+      Scalar d1_c_i = group.ScalarMultiply(d1, count_zkp.c_i);
+      lhs.Add(pk, group.ScalarMultiply(d1, count_zkp.r_i));
+      lhs.Add(group.Generator(), group.ScalarMultiply(Scalar::FromWord(i), d1_c_i));
+      rhs.Add(count_zkp.b_i, d1);
+      b_exponent = group.ScalarAdd(b_exponent, d1_c_i);
     }
+    rhs.Add(vote_counts[index].a, a_exponent);
+    rhs.Add(vote_counts[index].b, b_exponent);
+  }
 
-    CryptoPP::Integer c = hash_count_zkp(pk, c1, c2, a_vec, b_vec);
-    CryptoPP::Integer c_i = (c - c_sum) % DL_Q;
+  return lhs.Evaluate() == rhs.Evaluate();
+}
 
-    num_votes_zkp.c_i = c_i;
-    num_votes_zkp.r_i = r_i + ((c_i * r) % DL_Q) % DL_Q;
+/**
+ * Batch verifies the given ballots, bisecting on failure until every bad
+ * ballot is isolated. Single ballots are checked exactly.
+ */
+void BatchVerifyRange(const GroupContext &group,
+                      const std::vector<BallotView> &ballots,
+                      const std::vector<Vote_Struct> &vote_counts,
+                      const std::vector<int> &indices,
+                      const FixedBaseTable &pk, std::vector<bool> &valid) {
+  if (indices.empty()) {
+    return;
+  }
+  if (indices.size() == 1) {
+    const BallotView &ballot = ballots[indices[0]];
+    valid[indices[0]] =
+        VoteProofsHold(group, ballot.votes, ballot.zkps, pk) &&
+        CountProofsHold(group, vote_counts[indices[0]], ballot.count_zkps, ballot.count_zkps_version, pk);
+    return;
+  }
+  if (BatchEquationHolds(group, ballots, vote_counts, indices, pk)) {
+    for (int index : indices) {
+      valid[index] = true;
+    }
+    return;
   }
 
-  Count_ZKPs_Struct count_zkps_struct;
-  count_zkps_struct.count_zkps = count_zkps;
+  std::vector<int> left(indices.begin(), indices.begin() + indices.size() / 2);
+  std::vector<int> right(indices.begin() + indices.size() / 2, indices.end());
+  BatchVerifyRange(group, ballots, vote_counts, left, pk, valid);
+  BatchVerifyRange(group, ballots, vote_counts, right, pk, valid);
+}
 
-  return std::make_pair(collective_vote, count_zkps_struct);
+/**
+ * Verifies ballots whose proofs carry their commitments. The random weights
+ * of the batch equation only catch errors in the prime-order subgroup, so a
+ * ballot joins the batch only once every commitment is checked to be in it,
+ * all of the ballots' checks being handed to the group at once; any other
+ * ballot is checked exactly on its own, which rejects it, and so every
+ * verifier reaches the same verdict on it.
+ */
+void VerifyCommittedRange(const GroupContext &group,
+                          const std::vector<BallotView> &ballots,
+                          const std::vector<Vote_Struct> &vote_counts,
+                          const std::vector<int> &indices,
+                          const FixedBaseTable &pk, std::vector<bool> &valid) {
+  std::vector<GroupElement> elements;
+  std::vector<int> owners;
+  for (int index : indices) {
+    const BallotView &ballot = ballots[index];
+    for (auto &zkp : ballot.zkps) {
+      elements.insert(elements.end(), {zkp.a0, zkp.b0, zkp.a1, zkp.b1});
+      owners.insert(owners.end(), 4, index);
+    }
+    for (auto &count_zkp : ballot.count_zkps) {
+      elements.insert(elements.end(), {count_zkp.a_i, count_zkp.b_i});
+      owners.insert(owners.end(), 2, index);
+    }
+  }
+
+  std::vector<bool> in_subgroup = group.BatchIsSubgroupElement(elements);
+  std::vector<int> outside;
+  for (int i = 0; i < elements.size(); i++) {
+    if (!in_subgroup[i] && (outside.empty() || outside.back() != owners[i])) {
+      outside.push_back(owners[i]);
+    }
+  }
+
+  std::vector<int> batch;
+  for (int index : indices) {
+    if (std::find(outside.begin(), outside.end(), index) == outside.end()) {
+      batch.push_back(index);
+    } else {
+      BatchVerifyRange(group, ballots, vote_counts, {index}, pk, valid);
+    }
+  }
+  BatchVerifyRange(group, ballots, vote_counts, batch, pk, valid);
 }
 
 /**
- * Verifies vote count zkp
-*/
-bool ElectionClient::VerifyCountZKPs(std::pair<Vote_Struct, Count_ZKPs_Struct> vote_count, CryptoPP::Integer pk) {
-  CryptoPP::Integer a = vote_count.first.a;
-  CryptoPP::Integer b = vote_count.first.b;
+ * Verifies ballots with compact proofs, which carry only their challenges
+ * and responses. Every commitment is a product of fixed-base powers of g and
+ * pk, which are table lookups, and one power x^{-c} of a vote or vote count
+ * x; those powers are independent exponentiations, so the ones of all the
+ * ballots are handed to the group at once. The challenges are then hashed
+ * from the recomputed commitments. The votes must be in the prime-order
+ * subgroup, where x^{-c} = x^{q-c}, and the ballots of the right shape.
+ */
+void VerifyCompactRange(const GroupContext &group,
+                        const std::vector<BallotView> &ballots,
+                        const std::vector<Vote_Struct> &vote_counts,
+                        const std::vector<int> &indices,
+                        const FixedBaseTable &pk, std::vector<bool> &valid) {
+  if (indices.empty()) {
+    return;
+  }
+  const FixedBaseTable &g = group.Generator();
+
+  // x^{-c} for each vote commitment, then each count commitment, in order
+  std::vector<GroupElement> bases;
+  std::vector<Scalar> exponents;
+  for (int index : indices) {
+    const BallotView &ballot = ballots[index];
+    for (int i = 0; i < ballot.votes.size(); i++) {
+      const Vote_Struct &vote = ballot.votes[i];
+      Scalar minus_c0 = group.ScalarSubtract(Scalar(), ballot.zkps[i].c0);
+      Scalar minus_c1 = group.ScalarSubtract(Scalar(), ballot.zkps[i].c1);
+      bases.insert(bases.end(), {vote.a, vote.a, vote.b, vote.b});
+      exponents.insert(exponents.end(), {minus_c0, minus_c1, minus_c0, minus_c1});
+    }
+    for (auto &count_zkp : ballot.count_zkps) {
+      Scalar minus_c_i = group.ScalarSubtract(Scalar(), count_zkp.c_i);
+      bases.insert(bases.end(), {vote_counts[index].a, vote_counts[index].b});
+      exponents.insert(exponents.end(), {minus_c_i, minus_c_i});
+    }
+  }
+  std::vector<GroupElement> powers = group.BatchExponentiate(bases, exponents);
+
+  // each commitment is its fixed-base terms times its power, in one pass
+  auto commitment = [&](std::initializer_list<std::pair<const FixedBaseTable *, Scalar>> fixed_terms,
+                        const GroupElement &power) {
+    MultiExponentiation product(group);
+    for (auto &term : fixed_terms) {
+      product.Add(*term.first, term.second);
+    }
+    product.Add(power, Scalar::FromWord(1));
+    return product.Evaluate();
+  };
+
+  int n = 0;
+  for (int index : indices) {
+    const BallotView &ballot = ballots[index];
+    bool holds = true;
+
+    for (int i = 0; holds && i < ballot.votes.size(); i++) {
+      VoteZKP_Struct zkp = ballot.zkps[i];
+      // a_0' = g^{r_0''} * a^{-c_0}, a_1' = g^{r_1''} * a^{-c_1}
+      zkp.a0 = commitment({{&g, zkp.r0}}, powers[n + 4 * i]);
+      zkp.a1 = commitment({{&g, zkp.r1}}, powers[n + 4 * i + 1]);
+      // b_0' = pk^{r_0''} * b^{-c_0}, b_1' = pk^{r_1''} * g^{c_1} * b^{-c_1}
+      zkp.b0 = commitment({{&pk, zkp.r0}}, powers[n + 4 * i + 2]);
+      zkp.b1 = commitment({{&pk, zkp.r1}, {&g, zkp.c1}}, powers[n + 4 * i + 3]);
+      holds = VoteChallengeMatches(group, pk, ballot.votes[i], zkp, group.ScalarAdd(zkp.c0, zkp.c1));
+    }
+    n += 4 * ballot.votes.size();
+
+    std::vector<Count_ZKP_Struct> count_zkps(ballot.count_zkps.begin(), ballot.count_zkps.end());
+    Scalar c_sum;
+    for (int i = 0; i < count_zkps.size(); i++) {
+      Count_ZKP_Struct &count_zkp = count_zkps[i];
+      // a_i = g^{r_i} * a^{-c_i}, b_i = pk^{r_i} * g^{i*c_i} * b^{-c_i}
+      Scalar i_c_i = group.ScalarMultiply(Scalar::FromWord(i), count_zkp.c_i);
+      count_zkp.a_i = commitment({{&g, count_zkp.r_i}}, powers[n + 2 * i]);
+      count_zkp.b_i = commitment({{&pk, count_zkp.r_i}, {&g, i_c_i}}, powers[n + 2 * i + 1]);
+      c_sum = group.ScalarAdd(c_sum, count_zkp.c_i);
+    }
+    n += 2 * count_zkps.size();
 
-  CryptoPP::Integer c_sum = CryptoPP::Integer::Zero();
-  std::vector<CryptoPP::Integer> a_vec;
-  std::vector<CryptoPP::Integer> b_vec;
-  std::vector<Count_ZKP_Struct> count_zkps = vote_count.second.count_zkps;
+    valid[index] = holds && CountChallengeMatches(group, pk, vote_counts[index], count_zkps,
+                                                  ballot.count_zkps_version, c_sum);
+  }
+}
 
-  for (int i=0; i<count_zkps.size(); i++) {
-    Count_ZKP_Struct count_zkp = count_zkps[i];
-    CryptoPP::Integer g_r_pp = CryptoPP::ModularExponentiation(DL_G, count_zkp.r_i, DL_P);
-    CryptoPP::Integer a_i_check = (count_zkp.a_i * (CryptoPP::ModularExponentiation(a, count_zkp.c_i, DL_P))) % DL_P;
-
-    CryptoPP::Integer pk_r_pp = CryptoPP::ModularExponentiation(pk, count_zkp.r_i, DL_P);
-    CryptoPP::Integer pow(i);
-    CryptoPP::Integer g_k_inv = 
-      CryptoPP::EuclideanMultiplicativeInverse(CryptoPP::ModularExponentiation(DL_G, pow, DL_P), DL_P);
-    CryptoPP::Integer b_g_k_inv_c_i = CryptoPP::ModularExponentiation(((b * g_k_inv) % DL_P), count_zkp.c_i, DL_P);
-    CryptoPP::Integer b_i_check = (count_zkp.b_i * b_g_k_inv_c_i) % DL_P;
-
-    if (!(g_r_pp == a_i_check) || !(pk_r_pp == b_i_check)) {
-      return false;
+/**
+ * Checks that every vote ciphertext of the given ballots is in the
+ * prime-order subgroup, and with it their product, the vote count. The
+ * checks are independent exponentiations to the group order, so they are all
+ * handed to the group at once. Returns whether each ballot passes.
+ */
+std::vector<bool> VerifyCiphertexts(const GroupContext &group,
+                                    const std::vector<BallotView> &ballots) {
+  std::vector<GroupElement> elements;
+  std::vector<int> owners;
+  for (int i = 0; i < ballots.size(); i++) {
+    for (auto &vote : ballots[i].votes) {
+      elements.push_back(vote.a);
+      elements.push_back(vote.b);
+      owners.push_back(i);
+      owners.push_back(i);
+    }
+  }
+
+  std::vector<bool> valid(ballots.size(), true);
+  std::vector<bool> in_subgroup = group.BatchIsSubgroupElement(elements);
+  for (int i = 0; i < elements.size(); i++) {
+    if (!in_subgroup[i]) {
+      valid[owners[i]] = false;
+    }
+  }
+  return valid;
+}
+
+/**
+ * Verifies the vote and count zkps of many ballots by batching their
+ * equations. Returns whether each ballot is valid; a ballot must also have
+ * one vote per candidate and k + 1 count proofs, and ciphertexts in the
+ * prime-order subgroup. A ballot with a commitment outside the subgroup is
+ * checked on its own instead of in the batch equation. Ballots with compact
+ * proofs cannot join the batch equation, as their challenges hash
+ * commitments they do not carry; their commitments are recomputed in
+ * batches instead.
+ */
+std::vector<bool> VerifyBallots(const GroupContext &group,
+                                const std::vector<BallotView> &ballots,
+                                int num_candidates, int k,
+                                const FixedBaseTable &pk) {
+  std::vector<bool> valid(ballots.size(), false);
+
+  std::vector<bool> in_subgroup = VerifyCiphertexts(group, ballots);
+
+  std::vector<Vote_Struct> vote_counts(ballots.size());
+  std::vector<int> batch;
+  std::vector<int> compact;
+  for (int i = 0; i < ballots.size(); i++) {
+    if (!in_subgroup[i]) {
+      continue;
     }
+    if (!BallotCarriesCommitments(ballots[i])) {
+      if (!BallotShapeMatches(ballots[i], num_candidates, k)) {
+        continue;
+      }
+      vote_counts[i] = ElectionClient::CountVotes(group, ballots[i]);
+      compact.push_back(i);
+      if (compact.size() == BATCH_SIZE) {
+        VerifyCompactRange(group, ballots, vote_counts, compact, pk, valid);
+        compact.clear();
+      }
+      continue;
+    }
+    if (!BallotWellFormed(group, ballots[i], num_candidates, k, pk, &vote_counts[i])) {
+      continue;
+    }
+    batch.push_back(i);
+    if (batch.size() == BATCH_SIZE) {
+      VerifyCommittedRange(group, ballots, vote_counts, batch, pk, valid);
+      batch.clear();
+    }
+  }
+  VerifyCompactRange(group, ballots, vote_counts, compact, pk, valid);
+  VerifyCommittedRange(group, ballots, vote_counts, batch, pk, valid);
 
-    c_sum = (c_sum + count_zkp.c_i) % DL_Q;
-    a_vec.push_back(count_zkp.a_i);
-    b_vec.push_back(count_zkp.b_i);
+  return valid;
+}
+
+/**
+ * Views of ballots held as messages, for the functions above.
+ */
+std::vector<BallotView> ViewBallots(const std::vector<VoteRow> &ballots) {
+  std::vector<BallotView> views(ballots.size());
+  for (int i = 0; i < ballots.size(); i++) {
+    views[i].votes = ballots[i].votes.votes;
+    views[i].zkps = ballots[i].zkps.zkps;
+    views[i].count_zkps = ballots[i].count_zkps.count_zkps;
+    views[i].votes_version = ballots[i].votes.format_version;
+    views[i].zkps_version = ballots[i].zkps.format_version;
+    views[i].count_zkps_version = ballots[i].count_zkps.format_version;
+  }
+  return views;
+}
+
+/**
+ * Combines the given ballots in chunks on the shared thread pool: each
+ * chunk is transposed into columns and its columns are multiplied, and the
+ * chunks' products are then merged pairwise in a tree.
+ */
+Votes_Struct CombineBallots(const GroupContext &group,
+                            const std::vector<BallotView> &ballots,
+                            const std::vector<int> &indices,
+                            int num_candidates) {
+  if (indices.empty()) {
+    VoteColumns columns;
+    columns.num_candidates = num_candidates;
+    return ElectionClient::CombineVotes(group, columns);
   }
 
-  CryptoPP::Integer c = hash_count_zkp(pk, a, b, a_vec, b_vec);
-  return (c_sum == c);
+  ThreadPool &pool = ThreadPool::Shared();
+  int threads = pool.Size() + 1;
+  int chunk = std::clamp<int>((indices.size() + threads - 1) / threads,
+                              MIN_COLUMN_CHUNK, COLUMN_CHUNK);
+  int num_chunks = (indices.size() + chunk - 1) / chunk;
+  return ParallelReduce<Votes_Struct>(
+      pool, num_chunks,
+      [&](int c) {
+        int begin = c * chunk;
+        int end = std::min<int>(begin + chunk, indices.size());
+        VoteColumns columns;
+        columns.num_candidates = num_candidates;
+        columns.num_ballots = end - begin;
+        columns.a.resize(num_candidates * columns.num_ballots);
+        columns.b.resize(num_candidates * columns.num_ballots);
+        for (int j = begin; j < end; j++) {
+          std::span<const Vote_Struct> votes = ballots[indices[j]].votes;
+          for (int i = 0; i < num_candidates; i++) {
+            columns.a[i * columns.num_ballots + j - begin] = votes[i].a;
+            columns.b[i * columns.num_ballots + j - begin] = votes[i].b;
+          }
+        }
+        return ElectionClient::CombineVotes(group, columns);
+      },
+      [&](Votes_Struct x, const Votes_Struct &y) {
+        return ElectionClient::FoldVotes(group, std::move(x), y);
+      });
+}
+} // namespace
+
+/**
+ * Checks that every vote ciphertext of the given ballots, and with it their
+ * vote count, is in the prime-order subgroup. Returns whether each ballot
+ * passes.
+ */
+std::vector<bool>
+ElectionClient::BatchVerifyCiphertexts(const GroupContext &group,
+                                       const std::vector<VoteRow> &ballots) {
+  return VerifyCiphertexts(group, ViewBallots(ballots));
 }
 
+/**
+ * Verifies the vote and count zkps of many ballots by batching their
+ * equations. Returns whether each ballot is valid.
+ */
+std::vector<bool>
+ElectionClient::BatchVerifyBallots(const GroupContext &group,
+                                   const std::vector<VoteRow> &ballots,
+                                   int num_candidates, int k,
+                                   const FixedBaseTable &pk) {
+  return VerifyBallots(group, ViewBallots(ballots), num_candidates, k, pk);
+}
 
 /**
- * Generate partial decryption and zkp.
+ * BatchVerifyBallots for ballots read into a BallotBatch.
+ */
+std::vector<bool>
+ElectionClient::BatchVerifyBallots(const GroupContext &group,
+                                   const BallotBatch &ballots,
+                                   int num_candidates, int k,
+                                   const FixedBaseTable &pk) {
+  return VerifyBallots(group, ballots.Ballots(), num_candidates, k, pk);
+}
+
+/**
+ * Generate partial decryption and zkp. Throws if the ciphertext is not in the
+ * prime-order subgroup.
  */
 std::pair<PartialDecryption_Struct, DecryptionZKP_Struct>
-ElectionClient::PartialDecrypt(Vote_Struct combined_vote, CryptoPP::Integer pk, CryptoPP::Integer sk) {
+ElectionClient::PartialDecrypt(const GroupContext &group, const Vote_Struct &combined_vote, const CryptoPP::Integer &pk,
+                               const CryptoPP::Integer &sk) {
   // TODO: implement me!
 
+  // raising anything outside the subgroup to sk would leak sk modulo the
+  // order of its component
+  if (!group.BatchIsSubgroupElement({combined_vote.a})[0]) {
+    throw std::runtime_error("ciphertext is not in the subgroup");
+  }
+
+  Scalar sk_scalar = group.ReduceScalar(sk);
+
   // generate the partial decryption
   PartialDecryption_Struct decryption_struct;
-  decryption_struct.d = CryptoPP::ModularExponentiation(combined_vote.a, sk, DL_P);
+  decryption_struct.d = group.Exponentiate(combined_vote.a, sk_scalar);
   decryption_struct.aggregate_ciphertext = combined_vote;
 
   // generate zkp for partial decryption
-  CryptoPP::AutoSeededRandomPool r_seed;
-  CryptoPP::Integer r(r_seed, 1, DL_Q-1);
+  Scalar r = group.RandomScalar();
 
   DecryptionZKP_Struct zkp;
-  zkp.v = CryptoPP::ModularExponentiation(DL_G, r, DL_P);
-  zkp.u = CryptoPP::ModularExponentiation(combined_vote.a, r, DL_P);
+  zkp.v = group.Generator().Exponentiate(r);
+  zkp.u = group.Exponentiate(combined_vote.a, r);
 
-  CryptoPP::Integer sigma = hash_dec_zkp(pk, combined_vote.a, combined_vote.b, zkp.u, zkp.v);
-  CryptoPP::Integer s = (r + ((sigma * sk) % DL_Q)) % DL_Q;
+  Scalar sigma = DecryptionChallenge(group, pk, combined_vote, zkp.u, zkp.v);
+  Scalar s = group.ScalarAdd(r, group.ScalarMultiply(sigma, sk_scalar));
 
   zkp.s = s;
+  zkp.sigma = sigma;
 
   return std::make_pair(decryption_struct, zkp);
 }
 
 std::pair<PartialDecryptions_Struct, DecryptionZKPs_Struct>
-ElectionClient::PartialDecryptions(Votes_Struct combined_votes, CryptoPP::Integer pk, CryptoPP::Integer sk) {
-  std::vector<Vote_Struct> votes = combined_votes.votes;
-
-  std::vector<PartialDecryption_Struct> decs;
-  std::vector<DecryptionZKP_Struct> zkps;
+ElectionClient::PartialDecryptions(const GroupContext &group, const Votes_Struct &combined_votes,
+                                   const CryptoPP::Integer &pk, const CryptoPP::Integer &sk) {
+  PartialDecryptions_Struct decs_struct;
+  decs_struct.decs.reserve(combined_votes.votes.size());
+  DecryptionZKPs_Struct zkps_struct;
+  zkps_struct.zkps.reserve(combined_votes.votes.size());
 
-  for (auto &combined_vote : votes) {
+  for (auto &combined_vote : combined_votes.votes) {
     std::pair<PartialDecryption_Struct, DecryptionZKP_Struct> dec = 
-      ElectionClient::PartialDecrypt(combined_vote, pk, sk);
+      ElectionClient::PartialDecrypt(group, combined_vote, pk, sk);
     
-    decs.push_back(dec.first);
-    zkps.push_back(dec.second);
+    decs_struct.decs.push_back(dec.first);
+    zkps_struct.zkps.push_back(dec.second);
   }
 
-  PartialDecryptions_Struct decs_struct;
-  decs_struct.decs = decs;
-
-  DecryptionZKPs_Struct zkps_struct;
-  zkps_struct.zkps = zkps;
-
-  return std::make_pair(decs_struct, zkps_struct);
+  return std::make_pair(std::move(decs_struct), std::move(zkps_struct));
 }
 
 /**
  * Verify partial decryption zkp.
  */
 bool ElectionClient::VerifyPartialDecryptZKPs(
-    ArbiterToWorld_PartialDecryption_Message a2w_dec_s, CryptoPP::Integer pki) {
+    const GroupContext &group, const ArbiterToWorld_PartialDecryption_Message &a2w_dec_s,
+    const CryptoPP::Integer &pki) {
   // TODO: implement me!
 
-  std::vector<PartialDecryption_Struct> decs = a2w_dec_s.decs.decs;
-  std::vector<DecryptionZKP_Struct> zkps = a2w_dec_s.zkps.zkps;
-
-  for (int i=0; i<decs.size(); i++) {
-    CryptoPP::Integer A = zkps[i].v;
-    CryptoPP::Integer B = zkps[i].u;
-    CryptoPP::Integer s = zkps[i].s;
-
-    // sigma
-    CryptoPP::Integer sigma = hash_dec_zkp(pki, decs[i].aggregate_ciphertext.a, decs[i].aggregate_ciphertext.b, B, A);
-
-    // g^s
-    CryptoPP::Integer g_s = CryptoPP::ModularExponentiation(DL_G, s, DL_P);
+  const std::vector<PartialDecryption_Struct> &decs = a2w_dec_s.decs.decs;
+  const std::vector<DecryptionZKP_Struct> &zkps = a2w_dec_s.zkps.zkps;
 
-    CryptoPP::Integer g_s_check = (A * CryptoPP::ModularExponentiation(pki, sigma, DL_P)) % DL_P;
+  GroupElement pki_element;
+  if (!GroupElement::FromInteger(pki, &pki_element) || decs.size() != zkps.size()) {
+    return false;
+  }
+  // the key and every partial decryption must be in the subgroup
+  std::vector<GroupElement> elements = {pki_element};
+  for (auto &dec : decs) {
+    elements.push_back(dec.d);
+  }
+  for (bool in_subgroup : group.BatchIsSubgroupElement(elements)) {
+    if (!in_subgroup) {
+      return false;
+    }
+  }
+  GroupElement pki_inv = group.Inverse(pki_element);
 
-    // c1^s
-    CryptoPP::Integer c1_s = CryptoPP::ModularExponentiation(decs[i].aggregate_ciphertext.a, s, DL_P);
+  for (int i=0; i<decs.size(); i++) {
+    const Vote_Struct &ciphertext = decs[i].aggregate_ciphertext;
+    if (!group.IsElement(ciphertext.a)) {
+      return false;
+    }
 
-    CryptoPP::Integer c1_s_check = (B * CryptoPP::ModularExponentiation(decs[i].d, sigma, DL_P)) % DL_P;
+    if (zkps[i].format_version >= 3) {
+      if (!CompactDecryptionProofHolds(group, pki, pki_inv, ciphertext, decs[i].d, zkps[i])) {
+        return false;
+      }
+      continue;
+    }
 
-    if (!(g_s == g_s_check) or !(c1_s == c1_s_check)) {
+    // g^s * pki^{-sigma} = A and c1^s * d^{-sigma} = B, with sigma hashed
+    // from decimal strings for a proof made before transcripts
+    Scalar sigma;
+    if (LegacyChallenge(group, zkps[i].format_version)) {
+      sigma = group.ReduceScalar(hash_dec_zkp(pki, ciphertext.a.ToInteger(), ciphertext.b.ToInteger(),
+                                              zkps[i].u.ToInteger(), zkps[i].v.ToInteger()));
+    } else {
+      sigma = DecryptionChallenge(group, pki, ciphertext, zkps[i].u, zkps[i].v);
+    }
+    if (!DecryptionEquationsHold(group, pki_inv, ciphertext.a, decs[i].d, zkps[i], sigma)) {
       return false;
     }
   }
@@ -410,67 +1200,105 @@ bool ElectionClient::VerifyPartialDecryptZKPs(
 /**
  * Combine votes into one using homomorphic encryption.
  */
-Votes_Struct ElectionClient::CombineVotes(std::vector<VoteRow> all_votes, int num_candidates) {
-  // TODO: implement me!
+Votes_Struct ElectionClient::CombineVotes(const GroupContext &group, const std::vector<VoteRow> &all_votes,
+                                          int num_candidates) {
+  std::vector<int> indices(all_votes.size());
+  for (int j=0; j<all_votes.size(); j++) {
+    indices[j] = j;
+  }
+  return CombineBallots(group, ViewBallots(all_votes), indices, num_candidates);
+}
 
-  std::vector<Vote_Struct> vote_structs;
-  for (int i=0; i<num_candidates; i++) { // iterate over each candidate
-    CryptoPP::Integer c1 = CryptoPP::Integer::One();
-    CryptoPP::Integer c2 = CryptoPP::Integer::One();
+/**
+ * Combines the given ballots of a batch into one vote per candidate, as
+ * CombineVotes does.
+ */
+Votes_Struct ElectionClient::CombineVotes(const GroupContext &group, const BallotBatch &ballots,
+                                          const std::vector<int> &indices, int num_candidates) {
+  return CombineBallots(group, ballots.Ballots(), indices, num_candidates);
+}
 
-    for (int j=0; j<all_votes.size(); j++) { // combines for each candidate
-      VoteRow row = all_votes[j];
-      c1 = (c1 * row.votes.votes[i].a) % DL_P;
-      c2 = (c2 * row.votes.votes[i].b) % DL_P;
+/**
+ * Combines ballots laid out by candidate: each candidate's a and b columns
+ * are multiplied down in one pass, every column on the shared thread pool.
+ */
+Votes_Struct ElectionClient::CombineVotes(const GroupContext &group, const VoteColumns &columns) {
+  Votes_Struct collective_votes;
+  collective_votes.votes.resize(columns.num_candidates);
+  ThreadPool::Shared().ParallelFor(2 * columns.num_candidates, [&](int column) {
+    int i = column / 2; // the candidate
+    const std::vector<GroupElement> &values = column % 2 == 0 ? columns.a : columns.b;
+    GroupElement total = group.BatchMultiply(
+        std::span<const GroupElement>(values).subspan(i * columns.num_ballots, columns.num_ballots));
+    if (column % 2 == 0) {
+      collective_votes.votes[i].a = total;
+    } else {
+      collective_votes.votes[i].b = total;
     }
+  });
+  return collective_votes;
+}
 
-    Vote_Struct total_vote;
-    total_vote.a = c1;
-
-    total_vote.b = c2;
-
-    vote_structs.push_back(total_vote);
+/**
+ * Folds one ballot's votes into a running per-candidate aggregate. An empty
+ * aggregate starts from the ballot itself. The aggregate is updated in place,
+ * so callers move theirs in.
+ */
+Votes_Struct ElectionClient::FoldVotes(const GroupContext &group, Votes_Struct aggregate, const Votes_Struct &votes) {
+  if (aggregate.votes.empty()) {
+    return votes;
   }
 
-  Votes_Struct collective_votes;
-  collective_votes.votes = vote_structs;
+  for (int i=0; i<aggregate.votes.size(); i++) { // iterate over each candidate
+    aggregate.votes[i].a = group.Multiply(aggregate.votes[i].a, votes.votes[i].a);
+    aggregate.votes[i].b = group.Multiply(aggregate.votes[i].b, votes.votes[i].b);
+  }
 
-  return collective_votes;
+  return aggregate;
 }
 
 /**
- * Combine partial decryptions into final result.
+ * Combine partial decryptions into final result. Each candidate is
+ * unblinded and its tally recovered with `dlog` on the shared thread pool;
+ * throws if a decryption does not cover every candidate or a tally exceeds
+ * its bound.
  */
 std::vector<CryptoPP::Integer> ElectionClient::CombineResults(
-    Votes_Struct combined_votes,
-    std::vector<PartialDecryptionRow> all_partial_decryptions) {
+    const GroupContext &group, const Votes_Struct &combined_votes,
+    const std::vector<PartialDecryptionRow> &all_partial_decryptions,
+    const DiscreteLogTable &dlog) {
   // TODO: implement me!
 
-  std::vector<CryptoPP::Integer> combined_results;
-  std::vector<Vote_Struct> combined_votes_vecs = combined_votes.votes;
-
-  for (int i=0; i<combined_votes_vecs.size(); i++) { // iterate over each candidate
-    Vote_Struct combined_vote = combined_votes_vecs[i];
-
-    CryptoPP::Integer result_exp = combined_vote.b;
+  const std::vector<Vote_Struct> &combined_votes_vecs = combined_votes.votes;
+  for (auto &row : all_partial_decryptions) {
+    if (row.decs.decs.size() != combined_votes_vecs.size()) {
+      throw std::runtime_error("partial decryption by " + row.arbiter_id +
+                               " does not cover every candidate");
+    }
+  }
 
+  // unblind and solve every candidate in parallel
+  std::vector<long> votes(combined_votes_vecs.size());
+  std::vector<char> found(combined_votes_vecs.size());
+  ThreadPool::Shared().ParallelFor(combined_votes_vecs.size(), [&](int i) {
+    // g^m = b / (d_1 * d_2 * ...), with a single inversion
+    GroupProduct d_product(group);
     for (auto &row : all_partial_decryptions) { // iterate over each arbiter
-      CryptoPP::Integer d = row.decs.decs[i].d;
-      CryptoPP::Integer d_inv = CryptoPP::EuclideanMultiplicativeInverse(d, DL_P);
-      result_exp = (result_exp * d_inv) % DL_P;
+      d_product.Multiply(row.decs.decs[i].d);
     }
+    GroupElement result_exp = group.Divide(combined_votes_vecs[i].b, d_product.Value());
+    found[i] = dlog.Solve(result_exp, &votes[i]);
+  });
 
-    CryptoPP::Integer votes = CryptoPP::Integer::Zero();
-    while (true) {
-      CryptoPP::Integer g_votes = CryptoPP::ModularExponentiation(DL_G, votes, DL_P);
-      if (g_votes == result_exp) {
-        break;
-      }
-      votes += CryptoPP::Integer::One();
+  std::vector<CryptoPP::Integer> combined_results;
+  for (int i=0; i<combined_votes_vecs.size(); i++) {
+    if (!found[i]) {
+      throw std::runtime_error("could not recover tally for candidate " +
+                               std::to_string(i) + ": more than " +
+                               std::to_string(dlog.GetBound()) + " votes");
     }
-
-    combined_results.push_back(votes);
+    combined_results.push_back(CryptoPP::Integer(votes[i]));
   }
 
   return combined_results;
-}
\ No newline at end of file
+}
@@ -0,0 +1,1086 @@
+#include "../../include/pkg/election_math.hpp"
+#include "../../include/pkg/group_traits.hpp"
+#include "../../include/pkg/multi_buffer.hpp"
+#include "../../include-shared/rng.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <crypto++/ecp.h>
+
+namespace {
+/**
+ * Returns x, which must be non-negative and fit in N limbs.
+ */
+template <std::size_t N> FixedUInt<N> ToFixed(const CryptoPP::Integer &x) {
+  FixedUInt<N> result;
+  if (!FixedUInt<N>::FromInteger(x, &result)) {
+    throw std::runtime_error("integer does not fit in " +
+                             std::to_string(64 * N) + " bits");
+  }
+  return result;
+}
+
+/**
+ * Arithmetic mod Traits::MODULUS on stack-allocated limbs, in Montgomery
+ * form. The limb count and constants are compile-time, so the kernel is
+ * instantiated once per modulus at a fixed width.
+ */
+template <typename Traits> struct MontgomeryField {
+  static constexpr std::size_t N = Traits::LIMBS;
+  using Element = FixedUInt<N>;
+
+  static const CryptoPP::Integer &Modulus() {
+    static const CryptoPP::Integer modulus = Traits::MODULUS.ToInteger();
+    return modulus;
+  }
+
+  static Element One() { return Traits::MONTGOMERY_R; }
+
+  static bool IsZero(const Element &x) { return x.IsZero(); }
+
+  static Element Add(const Element &x, const Element &y) {
+    Element sum;
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < N; i++) {
+      std::uint64_t partial = x[i] + carry;
+      carry = partial < carry;
+      sum[i] = partial + y[i];
+      carry += sum[i] < partial;
+    }
+    ReduceOnce(sum, carry, Traits::MODULUS);
+    return sum;
+  }
+
+  static Element Subtract(const Element &x, const Element &y) {
+    Element difference;
+    std::uint64_t borrow = 0;
+    for (std::size_t i = 0; i < N; i++) {
+      std::uint64_t partial = x[i] - y[i];
+      std::uint64_t next = x[i] < y[i];
+      difference[i] = partial - borrow;
+      borrow = next | (partial < borrow);
+    }
+    if (borrow) {
+      std::uint64_t carry = 0;
+      for (std::size_t i = 0; i < N; i++) {
+        std::uint64_t partial = difference[i] + carry;
+        carry = partial < carry;
+        difference[i] = partial + Traits::MODULUS[i];
+        carry += difference[i] < partial;
+      }
+    }
+    return difference;
+  }
+
+  static Element Multiply(const Element &x, const Element &y) {
+    return MontgomeryMultiply(x, y, Traits::MODULUS,
+                              Traits::MONTGOMERY_INVERSE);
+  }
+
+  static Element Square(const Element &x) {
+    return MontgomerySquare(x, Traits::MODULUS, Traits::MONTGOMERY_INVERSE);
+  }
+
+  // x * R mod p for any x below 2^(64N)
+  static Element ConvertIn(const Element &x) {
+    return Multiply(x, Traits::MONTGOMERY_R_SQUARED);
+  }
+
+  static Element ConvertOut(const Element &x) {
+    return Multiply(x, Element::FromWord(1));
+  }
+
+  /**
+   * Inverts x in Montgomery form; 0 if it is not invertible. Extended Euclid
+   * on Integers beats a Fermat exponentiation at these sizes.
+   */
+  static Element Inverse(const Element &x) {
+    CryptoPP::Integer plain = ConvertOut(x).ToInteger();
+    return ConvertIn(ToFixed<N>(
+        CryptoPP::EuclideanMultiplicativeInverse(plain, Modulus())));
+  }
+};
+
+/**
+ * Z_p^* for the modulus in Traits, generated by an element of prime order.
+ * Elements are Montgomery-form residues.
+ */
+template <typename Traits> struct ModPArithmetic {
+  using Field = MontgomeryField<Traits>;
+  using Element = typename Field::Element;
+  static constexpr bool PRIME_ORDER = false;
+  static_assert(Traits::LIMBS == GroupElement::LIMBS,
+                "residues are sent as they are");
+
+  static CryptoPP::Integer GeneratorValue() {
+    return Traits::GENERATOR.ToInteger();
+  }
+
+  /**
+   * Reduces x into [0, p) if it is not already.
+   */
+  static CryptoPP::Integer Reduced(const CryptoPP::Integer &x) {
+    if (x.NotNegative() && x < Field::Modulus()) {
+      return x;
+    }
+    return x % Field::Modulus();
+  }
+
+  static bool IsElement(const GroupElement &x) {
+    return !x.IsZero() && Compare(x, Traits::MODULUS) < 0;
+  }
+
+  static GroupElement FromInteger(const CryptoPP::Integer &x) {
+    return ToFixed<Traits::LIMBS>(Reduced(x));
+  }
+
+  // Any value below 2^2048 is taken mod p.
+  static Element ConvertIn(const GroupElement &x) {
+    return Field::ConvertIn(x);
+  }
+
+  static GroupElement ConvertOut(const Element &x) {
+    return Field::ConvertOut(x);
+  }
+
+  static Element Identity() { return Field::One(); }
+
+  static Element Multiply(const Element &x, const Element &y) {
+    return Field::Multiply(x, y);
+  }
+
+  static Element Square(const Element &x) { return Field::Square(x); }
+
+  static Element Inverse(const Element &x) { return Field::Inverse(x); }
+
+  // Montgomery form is unique, so its low limb will do.
+  static std::uint64_t Key(const Element &x) { return x[0]; }
+};
+
+/**
+ * The points of y^2 = x^3 - 3x + b over the field in Traits, a group of
+ * prime order. Elements are Jacobian coordinates (x / z^2, y / z^3) in
+ * Montgomery form, with z = 0 for the identity, so adding points needs no
+ * field inversions; one is paid when a point is encoded.
+ */
+template <typename Traits> struct CurveArithmetic {
+  using Field = MontgomeryField<Traits>;
+  using Coordinate = typename Field::Element;
+  struct Element {
+    Coordinate x;
+    Coordinate y;
+    Coordinate z;
+  };
+  static constexpr bool PRIME_ORDER = true;
+  // Compressed encoding: a parity byte and x
+  static constexpr std::size_t ELEMENT_SIZE = 1 + 8 * Traits::LIMBS;
+  static_assert(Traits::LIMBS < GroupElement::LIMBS,
+                "points are sent in an element");
+
+  /**
+   * Workspace for decoding points; Crypto++ writes results into buffers
+   * owned by the curve, so each thread needs its own.
+   */
+  static const CryptoPP::ECP &Curve() {
+    thread_local CryptoPP::ECP curve(
+        Field::Modulus(), Field::Modulus() - CryptoPP::Integer(3),
+        Traits::B.ToInteger());
+    return curve;
+  }
+
+  /**
+   * Returns the compressed encoding of the affine point (x, y): x in the
+   * low limbs and the parity byte above it.
+   */
+  static GroupElement Encode(const Coordinate &x, const Coordinate &y) {
+    GroupElement encoded;
+    for (std::size_t i = 0; i < Traits::LIMBS; i++) {
+      encoded[i] = x[i];
+    }
+    encoded[Traits::LIMBS] = 0x02 | (y[0] & 1);
+    return encoded;
+  }
+
+  static CryptoPP::Integer GeneratorValue() {
+    return Encode(Traits::GENERATOR_X, Traits::GENERATOR_Y).ToInteger();
+  }
+
+  /**
+   * Decodes x into a point on the curve. Returns false if x is not the
+   * encoding of one.
+   */
+  static bool Decode(const GroupElement &x, CryptoPP::ECPPoint *point) {
+    if (x.IsZero()) {
+      *point = CryptoPP::ECPPoint();
+      return true;
+    }
+    for (std::size_t i = Traits::LIMBS + 1; i < GroupElement::LIMBS; i++) {
+      if (x[i] != 0) {
+        return false;
+      }
+    }
+    if (x[Traits::LIMBS] != 0x02 && x[Traits::LIMBS] != 0x03) {
+      return false;
+    }
+    CryptoPP::byte encoded[ELEMENT_SIZE];
+    encoded[0] = CryptoPP::byte(x[Traits::LIMBS]);
+    Coordinate x_coordinate;
+    for (std::size_t i = 0; i < Traits::LIMBS; i++) {
+      x_coordinate[i] = x[i];
+    }
+    x_coordinate.Encode(encoded + 1);
+    const CryptoPP::ECP &curve = Curve();
+    return curve.DecodePoint(*point, encoded, ELEMENT_SIZE) &&
+           curve.VerifyPoint(*point);
+  }
+
+  static bool IsElement(const GroupElement &x) {
+    CryptoPP::ECPPoint point;
+    return Decode(x, &point);
+  }
+
+  static GroupElement FromInteger(const CryptoPP::Integer &x) {
+    GroupElement element;
+    if (!GroupElement::FromInteger(x, &element)) {
+      throw std::runtime_error("not a curve point");
+    }
+    return element;
+  }
+
+  static Element ConvertIn(const GroupElement &x) {
+    CryptoPP::ECPPoint point;
+    if (!Decode(x, &point)) {
+      throw std::runtime_error("not a curve point");
+    }
+    if (point.identity) {
+      return Identity();
+    }
+    Element result;
+    result.x = Field::ConvertIn(ToFixed<Traits::LIMBS>(point.x));
+    result.y = Field::ConvertIn(ToFixed<Traits::LIMBS>(point.y));
+    result.z = Field::One();
+    return result;
+  }
+
+  /**
+   * Returns the affine coordinates of p, which is not the identity, out of
+   * Montgomery form.
+   */
+  static std::pair<Coordinate, Coordinate> ToAffine(const Element &p) {
+    Coordinate z_inv = Field::Inverse(p.z);
+    Coordinate z_inv_sq = Field::Square(z_inv);
+    Coordinate x = Field::Multiply(p.x, z_inv_sq);
+    Coordinate y = Field::Multiply(Field::Multiply(p.y, z_inv_sq), z_inv);
+    return std::make_pair(Field::ConvertOut(x), Field::ConvertOut(y));
+  }
+
+  static GroupElement ConvertOut(const Element &x) {
+    if (Field::IsZero(x.z)) {
+      return GroupElement();
+    }
+    auto affine = ToAffine(x);
+    return Encode(affine.first, affine.second);
+  }
+
+  static Element Identity() { return Element{}; }
+
+  /**
+   * 2P, by dbl-2001-b for a = -3 from the Explicit-Formulas Database.
+   */
+  static Element Square(const Element &p) {
+    if (Field::IsZero(p.z) || Field::IsZero(p.y)) {
+      return Identity();
+    }
+    Coordinate delta = Field::Square(p.z);
+    Coordinate gamma = Field::Square(p.y);
+    Coordinate beta = Field::Multiply(p.x, gamma);
+    Coordinate t = Field::Multiply(Field::Subtract(p.x, delta),
+                                   Field::Add(p.x, delta));
+    Coordinate alpha = Field::Add(Field::Add(t, t), t);
+    Coordinate beta4 = Field::Add(beta, beta);
+    beta4 = Field::Add(beta4, beta4);
+
+    Element r;
+    r.x = Field::Subtract(Field::Square(alpha), Field::Add(beta4, beta4));
+    r.z = Field::Subtract(
+        Field::Subtract(Field::Square(Field::Add(p.y, p.z)), gamma), delta);
+    Coordinate gamma_sq8 = Field::Square(gamma);
+    gamma_sq8 = Field::Add(gamma_sq8, gamma_sq8);
+    gamma_sq8 = Field::Add(gamma_sq8, gamma_sq8);
+    gamma_sq8 = Field::Add(gamma_sq8, gamma_sq8);
+    r.y = Field::Subtract(
+        Field::Multiply(alpha, Field::Subtract(beta4, r.x)), gamma_sq8);
+    return r;
+  }
+
+  /**
+   * P + Q, by add-2007-bl from the Explicit-Formulas Database.
+   */
+  static Element Multiply(const Element &p, const Element &q) {
+    if (Field::IsZero(p.z)) {
+      return q;
+    }
+    if (Field::IsZero(q.z)) {
+      return p;
+    }
+    Coordinate z1z1 = Field::Square(p.z);
+    Coordinate z2z2 = Field::Square(q.z);
+    Coordinate u1 = Field::Multiply(p.x, z2z2);
+    Coordinate u2 = Field::Multiply(q.x, z1z1);
+    Coordinate s1 = Field::Multiply(p.y, Field::Multiply(q.z, z2z2));
+    Coordinate s2 = Field::Multiply(q.y, Field::Multiply(p.z, z1z1));
+    Coordinate h = Field::Subtract(u2, u1);
+    Coordinate s_diff = Field::Subtract(s2, s1);
+    if (Field::IsZero(h)) {
+      // same x: either the same point or inverses
+      return Field::IsZero(s_diff) ? Square(p) : Identity();
+    }
+    Coordinate i = Field::Square(Field::Add(h, h));
+    Coordinate j = Field::Multiply(h, i);
+    Coordinate r = Field::Add(s_diff, s_diff);
+    Coordinate v = Field::Multiply(u1, i);
+
+    Element sum;
+    sum.x = Field::Subtract(Field::Subtract(Field::Square(r), j),
+                            Field::Add(v, v));
+    Coordinate s1_j = Field::Multiply(s1, j);
+    sum.y = Field::Subtract(Field::Multiply(r, Field::Subtract(v, sum.x)),
+                            Field::Add(s1_j, s1_j));
+    sum.z = Field::Multiply(
+        Field::Subtract(
+            Field::Subtract(Field::Square(Field::Add(p.z, q.z)), z1z1), z2z2),
+        h);
+    return sum;
+  }
+
+  static Element Inverse(const Element &p) {
+    Element inverse = p;
+    inverse.y = Field::Subtract(Coordinate{}, p.y);
+    return inverse;
+  }
+
+  // Jacobian coordinates are not unique, so key on the affine x-coordinate.
+  static std::uint64_t Key(const Element &p) {
+    if (Field::IsZero(p.z)) {
+      return 0;
+    }
+    return ToAffine(p).first[0];
+  }
+};
+
+/**
+ * The arithmetic each set of group parameters is instantiated with.
+ */
+template <typename Traits> struct GroupArithmetic;
+template <>
+struct GroupArithmetic<ModP2048Traits> : ModPArithmetic<ModP2048Traits> {};
+template <>
+struct GroupArithmetic<P256Traits> : CurveArithmetic<P256Traits> {};
+
+/**
+ * A GroupContext over the arithmetic for Traits. Everything below the
+ * virtual entry points is resolved at compile time.
+ */
+template <typename Traits> class GroupBackend : public GroupContext {
+public:
+  using Arithmetic = GroupArithmetic<Traits>;
+  using Element = typename Arithmetic::Element;
+  using ScalarField = MontgomeryField<ScalarTraits<Traits>>;
+  static_assert(Traits::ORDER_LIMBS == Scalar::LIMBS,
+                "scalars are sent as they are");
+
+  GroupBackend() {
+    this->generator =
+        std::make_unique<FixedBaseTable>(*this, Arithmetic::GeneratorValue());
+  }
+
+  std::string Name() const override { return Traits::NAME; }
+
+  const CryptoPP::Integer &Order() const override {
+    return ScalarField::Modulus();
+  }
+
+  const Scalar &ScalarOrder() const override { return Traits::ORDER; }
+
+  bool IsElement(const GroupElement &x) const override {
+    return Arithmetic::IsElement(x);
+  }
+
+  /**
+   * Every element is in the subgroup of a prime-order group; otherwise x is
+   * reduced and raised to the order.
+   */
+  bool IsSubgroupElement(const CryptoPP::Integer &x) const override {
+    GroupElement element;
+    if constexpr (Arithmetic::PRIME_ORDER) {
+      return GroupElement::FromInteger(x, &element) &&
+             Arithmetic::IsElement(element);
+    } else {
+      element = Arithmetic::FromInteger(x);
+      return this->Power(Arithmetic::ConvertIn(element), Traits::ORDER) ==
+             Arithmetic::Identity();
+    }
+  }
+
+  /**
+   * Checks IsElement and, if the group is not of prime order, raises every
+   * x to the order in one batch.
+   */
+  std::vector<bool>
+  BatchIsSubgroupElement(const std::vector<GroupElement> &xs) const override {
+    std::vector<bool> result(xs.size());
+    for (int i = 0; i < xs.size(); i++) {
+      result[i] = Arithmetic::IsElement(xs[i]);
+    }
+    if constexpr (!Arithmetic::PRIME_ORDER) {
+      std::vector<GroupElement> powers = this->BatchExponentiate(
+          xs, std::vector<Scalar>(xs.size(), Traits::ORDER));
+      for (int i = 0; i < xs.size(); i++) {
+        result[i] = result[i] && powers[i] == GroupElement::FromWord(1);
+      }
+    }
+    return result;
+  }
+
+  GroupElement Multiply(const GroupElement &x,
+                        const GroupElement &y) const override {
+    return Arithmetic::ConvertOut(Arithmetic::Multiply(
+        Arithmetic::ConvertIn(x), Arithmetic::ConvertIn(y)));
+  }
+
+  GroupElement Divide(const GroupElement &x,
+                      const GroupElement &y) const override {
+    return Arithmetic::ConvertOut(
+        Arithmetic::Multiply(Arithmetic::ConvertIn(x),
+                             Arithmetic::Inverse(Arithmetic::ConvertIn(y))));
+  }
+
+  GroupElement Inverse(const GroupElement &x) const override {
+    return Arithmetic::ConvertOut(
+        Arithmetic::Inverse(Arithmetic::ConvertIn(x)));
+  }
+
+  /**
+   * Samples by rejection; the order fills its top limb, so at least half of
+   * the draws are kept.
+   */
+  Scalar RandomScalar() const override {
+    CryptoPP::RandomNumberGenerator &rng = ThreadRNG();
+    CryptoPP::byte bytes[Scalar::BYTES];
+    while (true) {
+      rng.GenerateBlock(bytes, sizeof(bytes));
+      Scalar x = Scalar::Decode(bytes);
+      if (!x.IsZero() && Compare(x, Traits::ORDER) < 0) {
+        return x;
+      }
+    }
+  }
+
+  Scalar ReduceScalar(const CryptoPP::Integer &x) const override {
+    return ToFixed<Scalar::LIMBS>(x % ScalarField::Modulus());
+  }
+
+  Scalar ScalarAdd(const Scalar &x, const Scalar &y) const override {
+    return ScalarField::Add(Canonical(x), Canonical(y));
+  }
+
+  Scalar ScalarSubtract(const Scalar &x, const Scalar &y) const override {
+    return ScalarField::Subtract(Canonical(x), Canonical(y));
+  }
+
+  /**
+   * x * y with two Montgomery multiplications, as in ModPGroup::Multiply.
+   */
+  Scalar ScalarMultiply(const Scalar &x, const Scalar &y) const override {
+    return ScalarField::Multiply(ScalarField::ConvertIn(x), y);
+  }
+
+protected:
+  struct FixedBaseState : public GroupState {
+    int window_bits;
+    int num_windows;
+    std::vector<Element> table;
+  };
+
+  struct ProductState : public GroupState {
+    Element accumulator;
+    long count = 0;
+  };
+
+  struct DiscreteLogState : public GroupState {
+    Element giant_step; // g^-step
+    std::unordered_map<std::uint64_t, long> baby_steps; // key of g^j -> j
+  };
+
+  /**
+   * Builds the table, with a window for every bit a scalar can have.
+   */
+  std::unique_ptr<GroupState> BuildFixedBase(const CryptoPP::Integer &base,
+                                             int window_bits) const override {
+    auto state = std::make_unique<FixedBaseState>();
+    state->window_bits = window_bits;
+    int exponent_bits = 64 * Scalar::LIMBS;
+    state->num_windows = (exponent_bits + window_bits - 1) / window_bits;
+
+    int digits = (1 << window_bits) - 1;
+    state->table.reserve(state->num_windows * digits);
+
+    // start = base^(2^(w * i))
+    Element start = Arithmetic::ConvertIn(Arithmetic::FromInteger(base));
+    for (int i = 0; i < state->num_windows; i++) {
+      Element entry = start;
+      state->table.push_back(entry);
+      for (int d = 2; d <= digits; d++) {
+        entry = Arithmetic::Multiply(entry, start);
+        state->table.push_back(entry);
+      }
+      start = Arithmetic::Multiply(entry, start);
+    }
+    return state;
+  }
+
+  GroupElement FixedBaseExponentiate(const GroupState &table,
+                                     const Scalar &exponent) const override {
+    return Arithmetic::ConvertOut(
+        this->TableExponentiate(static_cast<const FixedBaseState &>(table),
+                                exponent));
+  }
+
+  /**
+   * Evaluates the product of the fixed-base and variable-base terms.
+   */
+  GroupElement
+  EvaluateProduct(const FixedTerms &fixed_terms,
+                  const std::vector<GroupElement> &bases,
+                  const std::vector<Scalar> &exponents) const override {
+    Element result = Arithmetic::Identity();
+    for (auto &term : fixed_terms) {
+      const auto &table =
+          static_cast<const FixedBaseState &>(TableState(*term.first));
+      result = Arithmetic::Multiply(
+          result, this->TableExponentiate(table, term.second));
+    }
+
+    std::vector<Element> internal_bases;
+    std::vector<Scalar> internal_exponents;
+    unsigned int max_bits = 0;
+    for (int i = 0; i < bases.size(); i++) {
+      if (exponents[i].IsZero()) {
+        continue;
+      }
+      internal_bases.push_back(Arithmetic::ConvertIn(bases[i]));
+      internal_exponents.push_back(exponents[i]);
+      max_bits = std::max(max_bits, exponents[i].BitCount());
+    }
+
+    if (!internal_bases.empty()) {
+      Element variable =
+          internal_bases.size() <= 32
+              ? this->Straus(internal_bases, internal_exponents, max_bits)
+              : this->Pippenger(internal_bases, internal_exponents, max_bits);
+      result = Arithmetic::Multiply(result, variable);
+    }
+    return Arithmetic::ConvertOut(result);
+  }
+
+  std::unique_ptr<GroupState> StartProduct() const override {
+    return std::make_unique<ProductState>();
+  }
+
+  /**
+   * Multiplies x into a running product.
+   */
+  void ProductStep(GroupState &product,
+                   const GroupElement &x) const override {
+    auto &state = static_cast<ProductState &>(product);
+    Element element = Arithmetic::ConvertIn(x);
+    state.accumulator = state.count == 0
+                            ? element
+                            : Arithmetic::Multiply(state.accumulator, element);
+    state.count++;
+  }
+
+  GroupElement ProductValue(const GroupState &product) const override {
+    auto &state = static_cast<const ProductState &>(product);
+    return Arithmetic::ConvertOut(state.count == 0 ? Arithmetic::Identity()
+                                                   : state.accumulator);
+  }
+
+  /**
+   * Builds the baby steps g^j for j < step.
+   */
+  std::unique_ptr<GroupState> BuildDiscreteLog(long step) const override {
+    auto state = std::make_unique<DiscreteLogState>();
+    Element g = Arithmetic::ConvertIn(
+        Arithmetic::FromInteger(this->Generator().GetBase()));
+    Element entry = Arithmetic::Identity();
+    state->baby_steps.reserve(step);
+    for (long j = 0; j < step; j++) {
+      state->baby_steps.emplace(Arithmetic::Key(entry), j);
+      entry = Arithmetic::Multiply(entry, g);
+    }
+
+    // entry = g^step
+    state->giant_step = Arithmetic::Inverse(entry);
+    return state;
+  }
+
+  /**
+   * Finds m with g^m = h and 0 <= m <= bound. Returns false if there is
+   * none.
+   */
+  bool SolveDiscreteLog(const GroupState &table, long step, long bound,
+                        const GroupElement &h, long *m) const override {
+    auto &state = static_cast<const DiscreteLogState &>(table);
+    Element target = Arithmetic::ConvertIn(h);
+    // gamma = h * g^(-i * step)
+    Element gamma = target;
+    for (long i = 0; i * step <= bound; i++) {
+      auto match = state.baby_steps.find(Arithmetic::Key(gamma));
+      if (match != state.baby_steps.end()) {
+        // the key is only one word, so confirm the hit
+        long candidate = i * step + match->second;
+        if (candidate <= bound &&
+            this->Generator().Exponentiate(Scalar::FromWord(candidate)) ==
+                Arithmetic::ConvertOut(target)) {
+          *m = candidate;
+          return true;
+        }
+      }
+      gamma = Arithmetic::Multiply(gamma, state.giant_step);
+    }
+    return false;
+  }
+
+  /**
+   * Computes base^exponent.
+   */
+  Element Power(const Element &base, const Scalar &exponent) const {
+    return this->Straus(std::vector<Element>{base},
+                        std::vector<Scalar>{exponent}, exponent.BitCount());
+  }
+
+private:
+  /**
+   * Reduces a scalar below the order; one subtraction will do, as the order
+   * fills its top limb.
+   */
+  static Scalar Canonical(Scalar x) {
+    ReduceOnce(x, 0, Traits::ORDER);
+    return x;
+  }
+
+  /**
+   * Computes base^exponent from the table.
+   */
+  Element TableExponentiate(const FixedBaseState &table,
+                            const Scalar &exponent) const {
+    int digits = (1 << table.window_bits) - 1;
+
+    Element result = Arithmetic::Identity();
+    for (int i = 0; i < table.num_windows; i++) {
+      unsigned int d =
+          exponent.GetBits(i * table.window_bits, table.window_bits);
+      if (d != 0) {
+        result = Arithmetic::Multiply(result, table.table[i * digits + d - 1]);
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Interleaved fixed-window exponentiation: one shared chain of squarings,
+   * with each base contributing a lookup per window.
+   */
+  Element Straus(const std::vector<Element> &bases,
+                 const std::vector<Scalar> &exponents,
+                 unsigned int max_bits) const {
+    int w = max_bits <= 64 ? 3 : (max_bits <= 512 ? 4 : 5);
+    int digits = (1 << w) - 1;
+
+    // powers[j * digits + d - 1] = bases[j]^d
+    std::vector<Element> powers;
+    powers.reserve(bases.size() * digits);
+    for (auto &base : bases) {
+      powers.push_back(base);
+      for (int d = 2; d <= digits; d++) {
+        powers.push_back(Arithmetic::Multiply(powers.back(), base));
+      }
+    }
+
+    Element result = Arithmetic::Identity();
+    int num_windows = (max_bits + w - 1) / w;
+    for (int i = num_windows - 1; i >= 0; i--) {
+      if (i != num_windows - 1) {
+        for (int s = 0; s < w; s++) {
+          result = Arithmetic::Square(result);
+        }
+      }
+      for (int j = 0; j < bases.size(); j++) {
+        unsigned int d = exponents[j].GetBits(i * w, w);
+        if (d != 0) {
+          result = Arithmetic::Multiply(result, powers[j * digits + d - 1]);
+        }
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Pippenger's bucket method: per window, bases are dropped into a bucket
+   * by digit and the buckets are summed with a running product, so the cost
+   * per base is one multiplication per window.
+   */
+  Element Pippenger(const std::vector<Element> &bases,
+                    const std::vector<Scalar> &exponents,
+                    unsigned int max_bits) const {
+    int log_n = 0;
+    while ((size_t(1) << (log_n + 1)) <= bases.size()) {
+      log_n++;
+    }
+    int c = std::min(16, std::max(2, log_n - 3));
+    int num_buckets = (1 << c) - 1;
+
+    std::vector<Element> buckets(num_buckets);
+    std::vector<bool> filled(num_buckets);
+
+    Element result = Arithmetic::Identity();
+    int num_windows = (max_bits + c - 1) / c;
+    for (int i = num_windows - 1; i >= 0; i--) {
+      if (i != num_windows - 1) {
+        for (int s = 0; s < c; s++) {
+          result = Arithmetic::Square(result);
+        }
+      }
+
+      std::fill(filled.begin(), filled.end(), false);
+      for (int j = 0; j < bases.size(); j++) {
+        unsigned int d = exponents[j].GetBits(i * c, c);
+        if (d == 0) {
+          continue;
+        }
+        if (filled[d - 1]) {
+          buckets[d - 1] = Arithmetic::Multiply(buckets[d - 1], bases[j]);
+        } else {
+          buckets[d - 1] = bases[j];
+          filled[d - 1] = true;
+        }
+      }
+
+      // prod_d bucket_d^d as a running product from the top bucket down
+      Element running;
+      Element window;
+      bool running_set = false;
+      bool window_set = false;
+      for (int d = num_buckets - 1; d >= 0; d--) {
+        if (filled[d]) {
+          running = running_set ? Arithmetic::Multiply(running, buckets[d])
+                                : buckets[d];
+          running_set = true;
+        }
+        if (running_set) {
+          window =
+              window_set ? Arithmetic::Multiply(window, running) : running;
+          window_set = true;
+        }
+      }
+      if (window_set) {
+        result = Arithmetic::Multiply(result, window);
+      }
+    }
+    return result;
+  }
+};
+
+/**
+ * The RFC 5114 group, keeping the conventions the election has always used
+ * for it: inputs need not be reduced, and the election key is the plain
+ * product of the arbiter keys.
+ */
+class ModPGroup : public GroupBackend<ModP2048Traits> {
+public:
+  using Field = MontgomeryField<ModP2048Traits>;
+
+  /**
+   * Computes x * y mod p with two Montgomery multiplications.
+   */
+  GroupElement Multiply(const GroupElement &x,
+                        const GroupElement &y) const override {
+    // (x * R^2 * R^-1) * y * R^-1 = x * y
+    return Field::Multiply(Arithmetic::ConvertIn(x), y);
+  }
+
+  /**
+   * Runs the exponentiations side by side in vector lanes.
+   */
+  std::vector<GroupElement>
+  BatchExponentiate(const std::vector<GroupElement> &bases,
+                    const std::vector<Scalar> &exponents) const override {
+    return this->engine.Exponentiate(bases, exponents);
+  }
+
+  /**
+   * Multiplies the elements in vector lanes, without converting them to
+   * Montgomery form; as with Multiply, they need not be reduced.
+   */
+  GroupElement BatchMultiply(std::span<const GroupElement> xs) const override {
+    return this->engine.Multiply(xs);
+  }
+
+  /**
+   * The plain product of the keys, unreduced, as the election key has
+   * always been loaded; it is hashed into every proof as is.
+   */
+  CryptoPP::Integer
+  CombinePublicKeys(const std::vector<CryptoPP::Integer> &keys) const override {
+    CryptoPP::Integer product = CryptoPP::Integer::One();
+    for (auto &key : keys) {
+      product *= key;
+    }
+    return product;
+  }
+
+protected:
+  /**
+   * Multiplies factors in without converting them to Montgomery form, so
+   * each costs a single Montgomery multiplication; the accumulator holds
+   * product * R^-(count - 1).
+   */
+  void ProductStep(GroupState &product,
+                   const GroupElement &x) const override {
+    auto &state = static_cast<ProductState &>(product);
+    state.accumulator =
+        state.count == 0 ? x : Field::Multiply(state.accumulator, x);
+    state.count++;
+  }
+
+  /**
+   * Cancels the factor of R^-(count - 1) left by ProductStep.
+   */
+  GroupElement ProductValue(const GroupState &product) const override {
+    auto &state = static_cast<const ProductState &>(product);
+    if (state.count == 0) {
+      return GroupElement::FromWord(1);
+    }
+    // R^2 is R in Montgomery form, so this is R^count out of it
+    Element correction = this->Power(ModP2048Traits::MONTGOMERY_R_SQUARED,
+                                     Scalar::FromWord(state.count - 1));
+    // accumulator * R^count * R^-1 = product
+    return Field::Multiply(state.accumulator, correction);
+  }
+
+private:
+  MultiBufferModExp engine{ModP2048Traits::MODULUS};
+};
+} // namespace
+
+/**
+ * Builds the table through the group.
+ */
+FixedBaseTable::FixedBaseTable(const GroupContext &group,
+                               CryptoPP::Integer base, int window_bits)
+    : group(group) {
+  this->base = base;
+  this->in_subgroup = group.IsSubgroupElement(base);
+  this->state = group.BuildFixedBase(base, window_bits);
+}
+
+/**
+ * Computes base^exponent.
+ */
+GroupElement FixedBaseTable::Exponentiate(const Scalar &exponent) const {
+  return this->group.FixedBaseExponentiate(*this->state, exponent);
+}
+
+/**
+ * Returns the base the table was built for, exactly as it was passed in.
+ */
+const CryptoPP::Integer &FixedBaseTable::GetBase() const { return this->base; }
+
+/**
+ * Starts an empty product.
+ */
+MultiExponentiation::MultiExponentiation(const GroupContext &group)
+    : group(group) {}
+
+/**
+ * Adds table.base^exponent to the product. Exponents over the same table
+ * are summed mod the order so the table is walked once, when its base is in
+ * the prime-order subgroup.
+ */
+void MultiExponentiation::Add(const FixedBaseTable &table,
+                              const Scalar &exponent) {
+  if (table.in_subgroup) {
+    for (auto &term : this->fixed_terms) {
+      if (term.first == &table) {
+        term.second = this->group.ScalarAdd(term.second, exponent);
+        return;
+      }
+    }
+  }
+  this->fixed_terms.push_back(std::make_pair(&table, exponent));
+}
+
+/**
+ * Adds base^exponent to the product.
+ */
+void MultiExponentiation::Add(const GroupElement &base,
+                              const Scalar &exponent) {
+  this->bases.push_back(base);
+  this->exponents.push_back(exponent);
+}
+
+/**
+ * Evaluates the product of every term added so far.
+ */
+GroupElement MultiExponentiation::Evaluate() const {
+  return this->group.EvaluateProduct(this->fixed_terms, this->bases,
+                                     this->exponents);
+}
+
+/**
+ * Returns the fixed-base table for the generator.
+ */
+const FixedBaseTable &GroupContext::Generator() const {
+  return *this->generator;
+}
+
+/**
+ * Computes base^exponent for a base with no table.
+ */
+GroupElement GroupContext::Exponentiate(const GroupElement &base,
+                                        const Scalar &exponent) const {
+  MultiExponentiation power(*this);
+  power.Add(base, exponent);
+  return power.Evaluate();
+}
+
+/**
+ * Computes each power on its own.
+ */
+std::vector<GroupElement>
+GroupContext::BatchExponentiate(const std::vector<GroupElement> &bases,
+                                const std::vector<Scalar> &exponents) const {
+  if (bases.size() != exponents.size()) {
+    throw std::runtime_error("every base needs an exponent");
+  }
+  std::vector<GroupElement> powers;
+  for (int i = 0; i < bases.size(); i++) {
+    powers.push_back(this->Exponentiate(bases[i], exponents[i]));
+  }
+  return powers;
+}
+
+/**
+ * Multiplies the elements into one running product.
+ */
+GroupElement GroupContext::BatchMultiply(std::span<const GroupElement> xs) const {
+  GroupProduct product(*this);
+  for (auto &x : xs) {
+    product.Multiply(x);
+  }
+  return product.Value();
+}
+
+/**
+ * Combines the arbiters' keys into the key whose secret is the sum of
+ * theirs. Throws if a key is too wide to be an element.
+ */
+CryptoPP::Integer GroupContext::CombinePublicKeys(
+    const std::vector<CryptoPP::Integer> &keys) const {
+  GroupProduct product(*this);
+  for (auto &key : keys) {
+    GroupElement element;
+    if (!GroupElement::FromInteger(key, &element)) {
+      throw std::runtime_error("public key is not a group element");
+    }
+    product.Multiply(element);
+  }
+  return product.Value().ToInteger();
+}
+
+/**
+ * Returns the backend state of a table built by this group.
+ */
+const GroupState &GroupContext::TableState(const FixedBaseTable &table) {
+  return *table.state;
+}
+
+/**
+ * Process-wide context for the RFC 5114 group.
+ */
+const GroupContext &DLGroup() {
+  static const ModPGroup group;
+  return group;
+}
+
+/**
+ * Process-wide context for P-256.
+ */
+const GroupContext &ECGroup() {
+  static const GroupBackend<P256Traits> group;
+  return group;
+}
+
+/**
+ * Returns the group named in the common config; the RFC 5114 group if none
+ * is named.
+ */
+const GroupContext &ElectionGroup(const std::string &name) {
+  if (name.empty() || name == DLGroup().Name()) {
+    return DLGroup();
+  }
+  if (name == ECGroup().Name()) {
+    return ECGroup();
+  }
+  throw std::runtime_error("unknown group: " + name);
+}
+
+/**
+ * Starts an empty product.
+ */
+GroupProduct::GroupProduct(const GroupContext &group) : group(group) {
+  this->state = group.StartProduct();
+}
+
+/**
+ * Multiplies x into the product.
+ */
+void GroupProduct::Multiply(const GroupElement &x) {
+  this->group.ProductStep(*this->state, x);
+}
+
+/**
+ * Returns the product.
+ */
+GroupElement GroupProduct::Value() const {
+  return this->group.ProductValue(*this->state);
+}
+
+/**
+ * Builds the baby steps for tallies of up to `bound`.
+ */
+DiscreteLogTable::DiscreteLogTable(const GroupContext &group, long bound)
+    : group(group) {
+  this->bound = std::max(bound, 0L);
+  this->step = 1;
+  while (this->step * this->step <= this->bound) {
+    this->step++;
+  }
+  this->state = group.BuildDiscreteLog(this->step);
+}
+
+/**
+ * Finds m with g^m = h and 0 <= m <= bound. Returns false if there is none.
+ */
+bool DiscreteLogTable::Solve(const GroupElement &h, long *m) const {
+  return this->group.SolveDiscreteLog(*this->state, this->step, this->bound, h,
+                                      m);
+}
+
+/**
+ * Returns the largest logarithm the table can find.
+ */
+long DiscreteLogTable::GetBound() const { return this->bound; }
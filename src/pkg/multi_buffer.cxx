@@ -0,0 +1,680 @@
+#include "../../include/pkg/multi_buffer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MULTI_BUFFER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+const unsigned int WINDOW_BITS = 4;
+const std::size_t WINDOW_SIZE = std::size_t(1) << WINDOW_BITS;
+
+// Limb sizes of the vector kernels. Both leave R = 2^(bits * limbs) above
+// four times any 2048-bit modulus, so a product of inputs below 2m is again
+// below 2m with no final subtraction, and leave enough headroom that a column
+// of partial products cannot overflow 64 bits before it is carried.
+const unsigned int IFMA_BITS = 52;
+const std::size_t IFMA_LIMBS = 40; // 2080 bits
+const std::size_t IFMA_LANES = 8;
+const unsigned int AVX2_BITS = 28;
+const std::size_t AVX2_LIMBS = 74; // 2072 bits
+const std::size_t AVX2_LANES = 4;
+
+/**
+ * Writes x as `limbs` limbs of `bits` bits, least significant first.
+ */
+void SplitLimbs(const UInt2048 &x, unsigned int bits, std::size_t limbs,
+                std::uint64_t *output) {
+  std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+  for (std::size_t i = 0; i < limbs; i++) {
+    std::size_t limb = i * bits / 64;
+    unsigned int shift = i * bits % 64;
+    std::uint64_t value = limb < UInt2048::LIMBS ? x[limb] >> shift : 0;
+    if (shift + bits > 64 && limb + 1 < UInt2048::LIMBS) {
+      value |= x[limb + 1] << (64 - shift);
+    }
+    output[i] = value & mask;
+  }
+}
+
+/**
+ * Reads a value below 2^2048 back from limbs of `bits` bits.
+ */
+UInt2048 JoinLimbs(const std::uint64_t *input, unsigned int bits,
+                   std::size_t limbs) {
+  UInt2048 x;
+  for (std::size_t i = 0; i < limbs; i++) {
+    std::size_t limb = i * bits / 64;
+    unsigned int shift = i * bits % 64;
+    if (limb < UInt2048::LIMBS) {
+      x[limb] |= input[i] << shift;
+    }
+    if (shift + bits > 64 && limb + 1 < UInt2048::LIMBS) {
+      x[limb + 1] |= input[i] >> (64 - shift);
+    }
+  }
+  return x;
+}
+
+/**
+ * The number of windows covering the longest of the exponents.
+ */
+unsigned int CountWindows(const UInt256 *exponents, std::size_t count) {
+  unsigned int bits = 0;
+  for (std::size_t i = 0; i < count; i++) {
+    bits = std::max(bits, exponents[i].BitCount());
+  }
+  return (bits + WINDOW_BITS - 1) / WINDOW_BITS;
+}
+
+/**
+ * base^exponent mod m on the scalar Montgomery kernel, one at a time.
+ */
+UInt2048 ScalarExponentiate(const UInt2048 &base, const UInt256 &exponent,
+                            const UInt2048 &m, std::uint64_t inverse,
+                            const UInt2048 &radix_squared) {
+  UInt2048 table[WINDOW_SIZE];
+  table[0] = MontgomeryRadix(m);
+  table[1] = MontgomeryMultiply(base, radix_squared, m, inverse);
+  for (std::size_t d = 2; d < WINDOW_SIZE; d++) {
+    table[d] = MontgomeryMultiply(table[d - 1], table[1], m, inverse);
+  }
+
+  unsigned int windows = CountWindows(&exponent, 1);
+  UInt2048 result = table[0];
+  for (unsigned int w = windows; w > 0; w--) {
+    for (unsigned int s = 0; s < WINDOW_BITS && w != windows; s++) {
+      result = MontgomerySquare(result, m, inverse);
+    }
+    unsigned int digit = exponent.GetBits((w - 1) * WINDOW_BITS, WINDOW_BITS);
+    result = w == windows ? table[digit]
+                          : MontgomeryMultiply(result, table[digit], m, inverse);
+  }
+  return MontgomeryMultiply(result, UInt2048::FromWord(1), m, inverse);
+}
+
+/**
+ * The product of count factors mod m on the scalar Montgomery kernel. The
+ * factors are not converted in: the accumulator starts at R and loses a
+ * factor of R with each one, and correction = R^count puts it back.
+ */
+UInt2048 ScalarProduct(const UInt2048 *factors, std::size_t count,
+                       const UInt2048 &m, std::uint64_t inverse,
+                       const UInt2048 &correction) {
+  UInt2048 result = MontgomeryRadix(m);
+  for (std::size_t i = 0; i < count; i++) {
+    result = MontgomeryMultiply(result, factors[i], m, inverse);
+  }
+  return MontgomeryMultiply(result, correction, m, inverse);
+}
+
+#ifdef MULTI_BUFFER_X86
+#define IFMA_TARGET __attribute__((target("avx512f,avx512ifma")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/**
+ * r = a * b * 2^-2080 mod m in each of 8 lanes of 52-bit limbs, by product
+ * scanning: column s sums the low halves of the 104-bit products a[j] *
+ * b[s - j] and q[j] * m[s - j] and the high halves of those one column down,
+ * and the Montgomery digit q[s] is picked to clear it. Each column is summed
+ * in a register, over four accumulators so consecutive VPMADD52s do not wait
+ * on each other, and only the digits and the result go to memory. r may
+ * alias a or b.
+ */
+IFMA_TARGET void IfmaMultiply(__m512i *r, const __m512i *a, const __m512i *b,
+                              const std::uint64_t *m, std::uint64_t inverse) {
+  const std::size_t N = IFMA_LIMBS;
+  const __m512i mask = _mm512_set1_epi64((std::uint64_t(1) << IFMA_BITS) - 1);
+  const __m512i k = _mm512_set1_epi64(inverse);
+  const __m512i zero = _mm512_setzero_si512();
+
+  __m512i q[N];
+  __m512i carry = zero;
+  for (std::size_t s = 0; s < 2 * N; s++) {
+    // pairs j, s - j for the low halves and j, s - 1 - j for the high ones;
+    // q[s] itself is not known yet
+    std::size_t begin = s < N ? 0 : s - N + 1;
+    std::size_t end = std::min(s, N);
+    __m512i low_ab = carry;
+    __m512i high_ab = zero;
+    __m512i low_qm = zero;
+    __m512i high_qm = zero;
+    for (std::size_t j = begin; j < end; j++) {
+      low_ab = _mm512_madd52lo_epu64(low_ab, a[j], b[s - j]);
+      high_ab = _mm512_madd52hi_epu64(high_ab, a[j], b[s - 1 - j]);
+      low_qm = _mm512_madd52lo_epu64(low_qm, q[j],
+                                     _mm512_set1_epi64(m[s - j]));
+      high_qm = _mm512_madd52hi_epu64(high_qm, q[j],
+                                      _mm512_set1_epi64(m[s - 1 - j]));
+    }
+    if (s < N) {
+      low_ab = _mm512_madd52lo_epu64(low_ab, a[s], b[0]);
+    } else {
+      high_ab = _mm512_madd52hi_epu64(high_ab, a[s - N], b[N - 1]);
+      high_qm = _mm512_madd52hi_epu64(high_qm, q[s - N],
+                                      _mm512_set1_epi64(m[N - 1]));
+    }
+    __m512i column = _mm512_add_epi64(_mm512_add_epi64(low_ab, high_ab),
+                                      _mm512_add_epi64(low_qm, high_qm));
+    if (s < N) {
+      // q[s] = column * -m^-1 mod 2^52 clears the column
+      q[s] = _mm512_madd52lo_epu64(zero, column, k);
+      column = _mm512_madd52lo_epu64(column, q[s], _mm512_set1_epi64(m[0]));
+    } else {
+      r[s - N] = _mm512_and_si512(column, mask);
+    }
+    carry = _mm512_srli_epi64(column, IFMA_BITS);
+  }
+}
+
+/**
+ * r = table[digits] in each lane, reading every entry.
+ */
+IFMA_TARGET void IfmaSelect(__m512i *r, const __m512i *table,
+                            __m512i digits) {
+  for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+    r[j] = _mm512_setzero_si512();
+  }
+  for (std::size_t d = 0; d < WINDOW_SIZE; d++) {
+    __mmask8 hit = _mm512_cmpeq_epi64_mask(digits, _mm512_set1_epi64(d));
+    for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+      r[j] = _mm512_mask_mov_epi64(r[j], hit, table[d * IFMA_LIMBS + j]);
+    }
+  }
+}
+
+/**
+ * results[l] = bases[l]^exponents[l] mod m for up to 8 lanes, left below
+ * 2m. m, radix_squared and inverse are in 52-bit limbs.
+ */
+IFMA_TARGET void IfmaExponentiate(const UInt2048 *bases,
+                                  const UInt256 *exponents, std::size_t count,
+                                  const std::uint64_t *m,
+                                  const std::uint64_t *radix_squared,
+                                  std::uint64_t inverse, UInt2048 *results) {
+  alignas(64) std::uint64_t lanes[IFMA_LIMBS][IFMA_LANES];
+  std::uint64_t limbs[IFMA_LIMBS];
+  for (std::size_t l = 0; l < IFMA_LANES; l++) {
+    SplitLimbs(l < count ? bases[l] : UInt2048::FromWord(1), IFMA_BITS,
+               IFMA_LIMBS, limbs);
+    for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+      lanes[j][l] = limbs[j];
+    }
+  }
+
+  __m512i x[IFMA_LIMBS];
+  __m512i rr[IFMA_LIMBS];
+  __m512i one[IFMA_LIMBS];
+  for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+    x[j] = _mm512_load_si512(lanes[j]);
+    rr[j] = _mm512_set1_epi64(radix_squared[j]);
+    one[j] = _mm512_set1_epi64(j == 0);
+  }
+
+  __m512i table[WINDOW_SIZE * IFMA_LIMBS];
+  IfmaMultiply(table, one, rr, m, inverse);
+  IfmaMultiply(table + IFMA_LIMBS, x, rr, m, inverse);
+  for (std::size_t d = 2; d < WINDOW_SIZE; d++) {
+    IfmaMultiply(table + d * IFMA_LIMBS, table + (d - 1) * IFMA_LIMBS,
+                 table + IFMA_LIMBS, m, inverse);
+  }
+
+  unsigned int windows = CountWindows(exponents, count);
+  __m512i result[IFMA_LIMBS];
+  __m512i factor[IFMA_LIMBS];
+  std::copy(table, table + IFMA_LIMBS, result);
+  alignas(64) std::uint64_t digits[IFMA_LANES];
+  for (unsigned int w = windows; w > 0; w--) {
+    for (std::size_t l = 0; l < IFMA_LANES; l++) {
+      digits[l] = l < count ? exponents[l].GetBits((w - 1) * WINDOW_BITS,
+                                                   WINDOW_BITS)
+                            : 0;
+    }
+    if (w == windows) {
+      IfmaSelect(result, table, _mm512_load_si512(digits));
+      continue;
+    }
+    for (unsigned int s = 0; s < WINDOW_BITS; s++) {
+      IfmaMultiply(result, result, result, m, inverse);
+    }
+    IfmaSelect(factor, table, _mm512_load_si512(digits));
+    IfmaMultiply(result, result, factor, m, inverse);
+  }
+  IfmaMultiply(result, result, one, m, inverse);
+
+  for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+    _mm512_store_si512(lanes[j], result[j]);
+  }
+  for (std::size_t l = 0; l < count; l++) {
+    for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+      limbs[j] = lanes[j][l];
+    }
+    results[l] = JoinLimbs(limbs, IFMA_BITS, IFMA_LIMBS);
+  }
+}
+
+/**
+ * results[l] = the product of factors l, l + 8, l + 16, ... mod m for each
+ * of 8 lanes, at most m. The lanes run for the same number of rounds, a
+ * short last one padded with 1s, so each accumulator is its product times
+ * R^(1 - rounds) whatever it holds; correction = R^(rounds + 1) makes that
+ * the product in Montgomery form, and a multiplication by 1 takes it out.
+ * Accumulators stay below 2m throughout, never reduced further.
+ */
+IFMA_TARGET void IfmaProduct(const UInt2048 *factors, std::size_t count,
+                             const std::uint64_t *m,
+                             const std::uint64_t *radix_squared,
+                             const std::uint64_t *correction,
+                             std::uint64_t inverse, UInt2048 *results) {
+  alignas(64) std::uint64_t lanes[IFMA_LIMBS][IFMA_LANES];
+  std::uint64_t limbs[IFMA_LIMBS];
+
+  __m512i x[IFMA_LIMBS];
+  __m512i one[IFMA_LIMBS];
+  __m512i result[IFMA_LIMBS];
+  for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+    one[j] = _mm512_set1_epi64(j == 0);
+    x[j] = _mm512_set1_epi64(radix_squared[j]);
+  }
+  IfmaMultiply(result, one, x, m, inverse);
+
+  for (std::size_t i = 0; i < count; i += IFMA_LANES) {
+    for (std::size_t l = 0; l < IFMA_LANES; l++) {
+      SplitLimbs(i + l < count ? factors[i + l] : UInt2048::FromWord(1),
+                 IFMA_BITS, IFMA_LIMBS, limbs);
+      for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+        lanes[j][l] = limbs[j];
+      }
+    }
+    for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+      x[j] = _mm512_load_si512(lanes[j]);
+    }
+    IfmaMultiply(result, result, x, m, inverse);
+  }
+
+  for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+    x[j] = _mm512_set1_epi64(correction[j]);
+  }
+  IfmaMultiply(result, result, x, m, inverse);
+  IfmaMultiply(result, result, one, m, inverse);
+
+  for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+    _mm512_store_si512(lanes[j], result[j]);
+  }
+  for (std::size_t l = 0; l < IFMA_LANES; l++) {
+    for (std::size_t j = 0; j < IFMA_LIMBS; j++) {
+      limbs[j] = lanes[j][l];
+    }
+    results[l] = JoinLimbs(limbs, IFMA_BITS, IFMA_LIMBS);
+  }
+}
+
+/**
+ * r = a * b * 2^-2072 mod m in each of 4 lanes of 28-bit limbs, by product
+ * scanning as in IfmaMultiply. VPMULUDQ gives the full 56-bit products, so
+ * column s only sums a[j] * b[s - j] and q[j] * m[s - j]. r may alias a or
+ * b.
+ */
+AVX2_TARGET void Avx2Multiply(__m256i *r, const __m256i *a, const __m256i *b,
+                              const std::uint64_t *m, std::uint64_t inverse) {
+  const std::size_t N = AVX2_LIMBS;
+  const __m256i mask =
+      _mm256_set1_epi64x((std::uint64_t(1) << AVX2_BITS) - 1);
+  const __m256i k = _mm256_set1_epi64x(inverse);
+  const __m256i zero = _mm256_setzero_si256();
+
+  __m256i q[N];
+  __m256i carry = zero;
+  for (std::size_t s = 0; s < 2 * N; s++) {
+    // pairs j, s - j; q[s] itself is not known yet
+    std::size_t begin = s < N ? 0 : s - N + 1;
+    std::size_t end = std::min(s, N);
+    __m256i ab = carry;
+    __m256i qm = zero;
+    for (std::size_t j = begin; j < end; j++) {
+      ab = _mm256_add_epi64(ab, _mm256_mul_epu32(a[j], b[s - j]));
+      qm = _mm256_add_epi64(
+          qm, _mm256_mul_epu32(q[j], _mm256_set1_epi64x(m[s - j])));
+    }
+    if (s < N) {
+      ab = _mm256_add_epi64(ab, _mm256_mul_epu32(a[s], b[0]));
+    }
+    __m256i column = _mm256_add_epi64(ab, qm);
+    if (s < N) {
+      // q[s] = column * -m^-1 mod 2^28 clears the column
+      q[s] = _mm256_and_si256(_mm256_mul_epu32(column, k), mask);
+      column = _mm256_add_epi64(
+          column, _mm256_mul_epu32(q[s], _mm256_set1_epi64x(m[0])));
+    } else {
+      r[s - N] = _mm256_and_si256(column, mask);
+    }
+    carry = _mm256_srli_epi64(column, AVX2_BITS);
+  }
+}
+
+/**
+ * r = table[digits] in each lane, reading every entry.
+ */
+AVX2_TARGET void Avx2Select(__m256i *r, const __m256i *table,
+                            __m256i digits) {
+  for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+    r[j] = _mm256_setzero_si256();
+  }
+  for (std::size_t d = 0; d < WINDOW_SIZE; d++) {
+    __m256i hit = _mm256_cmpeq_epi64(digits, _mm256_set1_epi64x(d));
+    for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+      r[j] = _mm256_blendv_epi8(r[j], table[d * AVX2_LIMBS + j], hit);
+    }
+  }
+}
+
+/**
+ * IfmaExponentiate for up to 4 lanes of 28-bit limbs.
+ */
+AVX2_TARGET void Avx2Exponentiate(const UInt2048 *bases,
+                                  const UInt256 *exponents, std::size_t count,
+                                  const std::uint64_t *m,
+                                  const std::uint64_t *radix_squared,
+                                  std::uint64_t inverse, UInt2048 *results) {
+  alignas(32) std::uint64_t lanes[AVX2_LIMBS][AVX2_LANES];
+  std::uint64_t limbs[AVX2_LIMBS];
+  for (std::size_t l = 0; l < AVX2_LANES; l++) {
+    SplitLimbs(l < count ? bases[l] : UInt2048::FromWord(1), AVX2_BITS,
+               AVX2_LIMBS, limbs);
+    for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+      lanes[j][l] = limbs[j];
+    }
+  }
+
+  __m256i x[AVX2_LIMBS];
+  __m256i rr[AVX2_LIMBS];
+  __m256i one[AVX2_LIMBS];
+  for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+    x[j] = _mm256_load_si256((const __m256i *)lanes[j]);
+    rr[j] = _mm256_set1_epi64x(radix_squared[j]);
+    one[j] = _mm256_set1_epi64x(j == 0);
+  }
+
+  __m256i table[WINDOW_SIZE * AVX2_LIMBS];
+  Avx2Multiply(table, one, rr, m, inverse);
+  Avx2Multiply(table + AVX2_LIMBS, x, rr, m, inverse);
+  for (std::size_t d = 2; d < WINDOW_SIZE; d++) {
+    Avx2Multiply(table + d * AVX2_LIMBS, table + (d - 1) * AVX2_LIMBS,
+                 table + AVX2_LIMBS, m, inverse);
+  }
+
+  unsigned int windows = CountWindows(exponents, count);
+  __m256i result[AVX2_LIMBS];
+  __m256i factor[AVX2_LIMBS];
+  std::copy(table, table + AVX2_LIMBS, result);
+  alignas(32) std::uint64_t digits[AVX2_LANES];
+  for (unsigned int w = windows; w > 0; w--) {
+    for (std::size_t l = 0; l < AVX2_LANES; l++) {
+      digits[l] = l < count ? exponents[l].GetBits((w - 1) * WINDOW_BITS,
+                                                   WINDOW_BITS)
+                            : 0;
+    }
+    __m256i digit_vector = _mm256_load_si256((const __m256i *)digits);
+    if (w == windows) {
+      Avx2Select(result, table, digit_vector);
+      continue;
+    }
+    for (unsigned int s = 0; s < WINDOW_BITS; s++) {
+      Avx2Multiply(result, result, result, m, inverse);
+    }
+    Avx2Select(factor, table, digit_vector);
+    Avx2Multiply(result, result, factor, m, inverse);
+  }
+  Avx2Multiply(result, result, one, m, inverse);
+
+  for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+    _mm256_store_si256((__m256i *)lanes[j], result[j]);
+  }
+  for (std::size_t l = 0; l < count; l++) {
+    for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+      limbs[j] = lanes[j][l];
+    }
+    results[l] = JoinLimbs(limbs, AVX2_BITS, AVX2_LIMBS);
+  }
+}
+/**
+ * IfmaProduct for 4 lanes of 28-bit limbs.
+ */
+AVX2_TARGET void Avx2Product(const UInt2048 *factors, std::size_t count,
+                             const std::uint64_t *m,
+                             const std::uint64_t *radix_squared,
+                             const std::uint64_t *correction,
+                             std::uint64_t inverse, UInt2048 *results) {
+  alignas(32) std::uint64_t lanes[AVX2_LIMBS][AVX2_LANES];
+  std::uint64_t limbs[AVX2_LIMBS];
+
+  __m256i x[AVX2_LIMBS];
+  __m256i one[AVX2_LIMBS];
+  __m256i result[AVX2_LIMBS];
+  for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+    one[j] = _mm256_set1_epi64x(j == 0);
+    x[j] = _mm256_set1_epi64x(radix_squared[j]);
+  }
+  Avx2Multiply(result, one, x, m, inverse);
+
+  for (std::size_t i = 0; i < count; i += AVX2_LANES) {
+    for (std::size_t l = 0; l < AVX2_LANES; l++) {
+      SplitLimbs(i + l < count ? factors[i + l] : UInt2048::FromWord(1),
+                 AVX2_BITS, AVX2_LIMBS, limbs);
+      for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+        lanes[j][l] = limbs[j];
+      }
+    }
+    for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+      x[j] = _mm256_load_si256((const __m256i *)lanes[j]);
+    }
+    Avx2Multiply(result, result, x, m, inverse);
+  }
+
+  for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+    x[j] = _mm256_set1_epi64x(correction[j]);
+  }
+  Avx2Multiply(result, result, x, m, inverse);
+  Avx2Multiply(result, result, one, m, inverse);
+
+  for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+    _mm256_store_si256((__m256i *)lanes[j], result[j]);
+  }
+  for (std::size_t l = 0; l < AVX2_LANES; l++) {
+    for (std::size_t j = 0; j < AVX2_LIMBS; j++) {
+      limbs[j] = lanes[j][l];
+    }
+    results[l] = JoinLimbs(limbs, AVX2_BITS, AVX2_LIMBS);
+  }
+}
+#endif
+
+/**
+ * Whether this build and CPU can run the kernel.
+ */
+bool KernelSupported(MultiBufferModExp::Kernel kernel) {
+  switch (kernel) {
+#ifdef MULTI_BUFFER_X86
+  case MultiBufferModExp::Kernel::AVX512_IFMA:
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512ifma");
+  case MultiBufferModExp::Kernel::AVX2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  case MultiBufferModExp::Kernel::SCALAR:
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace
+
+/**
+ * Builds an engine for the modulus on the best kernel for this CPU.
+ */
+MultiBufferModExp::MultiBufferModExp(const UInt2048 &modulus)
+    : MultiBufferModExp(modulus, DetectKernel()) {}
+
+/**
+ * Builds an engine for the modulus on the given kernel. The modulus must be
+ * odd with its top bit set; throws if the CPU cannot run the kernel.
+ */
+MultiBufferModExp::MultiBufferModExp(const UInt2048 &modulus, Kernel kernel)
+    : modulus(modulus), kernel(kernel) {
+  if (!KernelSupported(kernel)) {
+    throw std::runtime_error("multi-buffer kernel not supported on this CPU");
+  }
+  this->inverse = NegatedInverse(modulus[0]);
+  this->radix_squared = MontgomeryRadixSquared(modulus, this->inverse);
+
+  unsigned int bits = kernel == Kernel::AVX2 ? AVX2_BITS : IFMA_BITS;
+  std::size_t limbs = kernel == Kernel::AVX2 ? AVX2_LIMBS : IFMA_LIMBS;
+  CryptoPP::Integer radix_squared =
+      CryptoPP::Integer::Power2(2 * bits * limbs) % modulus.ToInteger();
+  UInt2048 radix_squared_fixed;
+  UInt2048::FromInteger(radix_squared, &radix_squared_fixed);
+  this->limb_modulus.resize(limbs);
+  this->limb_radix_squared.resize(limbs);
+  SplitLimbs(modulus, bits, limbs, this->limb_modulus.data());
+  SplitLimbs(radix_squared_fixed, bits, limbs,
+             this->limb_radix_squared.data());
+  this->limb_inverse = this->inverse & ((std::uint64_t(1) << bits) - 1);
+
+  CryptoPP::Integer radix =
+      CryptoPP::Integer::Power2(bits * limbs) % modulus.ToInteger();
+  UInt2048::FromInteger(radix, &this->limb_radix);
+}
+
+/**
+ * Computes every power, a batch of lanes at a time.
+ */
+std::vector<UInt2048>
+MultiBufferModExp::Exponentiate(const std::vector<UInt2048> &bases,
+                                const std::vector<UInt256> &exponents) const {
+  if (bases.size() != exponents.size()) {
+    throw std::runtime_error("every base needs an exponent");
+  }
+  std::vector<UInt2048> results(bases.size());
+
+  std::size_t lanes = 1;
+#ifdef MULTI_BUFFER_X86
+  if (this->kernel == Kernel::AVX512_IFMA) {
+    lanes = IFMA_LANES;
+  } else if (this->kernel == Kernel::AVX2) {
+    lanes = AVX2_LANES;
+  }
+#endif
+  for (std::size_t i = 0; i < bases.size(); i += lanes) {
+    std::size_t count = std::min(lanes, bases.size() - i);
+    switch (this->kernel) {
+#ifdef MULTI_BUFFER_X86
+    case Kernel::AVX512_IFMA:
+      IfmaExponentiate(&bases[i], &exponents[i], count,
+                       this->limb_modulus.data(),
+                       this->limb_radix_squared.data(), this->limb_inverse,
+                       &results[i]);
+      break;
+    case Kernel::AVX2:
+      Avx2Exponentiate(&bases[i], &exponents[i], count,
+                       this->limb_modulus.data(),
+                       this->limb_radix_squared.data(), this->limb_inverse,
+                       &results[i]);
+      break;
+#endif
+    default:
+      results[i] = ScalarExponentiate(bases[i], exponents[i], this->modulus,
+                                      this->inverse, this->radix_squared);
+      break;
+    }
+  }
+
+  // the vector kernels stop at or below m
+  for (auto &result : results) {
+    ReduceOnce(result, 0, this->modulus);
+  }
+  return results;
+}
+
+/**
+ * Multiplies the factors together, spread over the lanes, and then the
+ * lanes' products together on the scalar kernel.
+ */
+UInt2048 MultiBufferModExp::Multiply(std::span<const UInt2048> factors) const {
+  CryptoPP::Integer modulus = this->modulus.ToInteger();
+
+  std::vector<UInt2048> products;
+#ifdef MULTI_BUFFER_X86
+  if (factors.size() > 1 &&
+      (this->kernel == Kernel::AVX512_IFMA || this->kernel == Kernel::AVX2)) {
+    bool ifma = this->kernel == Kernel::AVX512_IFMA;
+    unsigned int bits = ifma ? IFMA_BITS : AVX2_BITS;
+    std::size_t lanes = ifma ? IFMA_LANES : AVX2_LANES;
+
+    // R^(rounds + 1), in the kernel's limbs
+    long rounds = (factors.size() + lanes - 1) / lanes;
+    UInt2048 correction;
+    UInt2048::FromInteger(
+        CryptoPP::a_exp_b_mod_c(this->limb_radix.ToInteger(),
+                                CryptoPP::Integer(rounds + 1), modulus),
+        &correction);
+    std::vector<std::uint64_t> limb_correction(this->limb_modulus.size());
+    SplitLimbs(correction, bits, limb_correction.size(),
+               limb_correction.data());
+
+    products.resize(lanes);
+    if (ifma) {
+      IfmaProduct(factors.data(), factors.size(), this->limb_modulus.data(),
+                  this->limb_radix_squared.data(), limb_correction.data(),
+                  this->limb_inverse, products.data());
+    } else {
+      Avx2Product(factors.data(), factors.size(), this->limb_modulus.data(),
+                  this->limb_radix_squared.data(), limb_correction.data(),
+                  this->limb_inverse, products.data());
+    }
+    // the vector kernels stop at or below m
+    for (auto &product : products) {
+      ReduceOnce(product, 0, this->modulus);
+    }
+    factors = products;
+  }
+#endif
+
+  // R^count for the scalar kernel
+  UInt2048 correction;
+  UInt2048::FromInteger(
+      CryptoPP::a_exp_b_mod_c(MontgomeryRadix(this->modulus).ToInteger(),
+                              CryptoPP::Integer((long)factors.size()),
+                              modulus),
+      &correction);
+  return ScalarProduct(factors.data(), factors.size(), this->modulus,
+                       this->inverse, correction);
+}
+
+/**
+ * Returns the kernel the engine runs on.
+ */
+MultiBufferModExp::Kernel MultiBufferModExp::GetKernel() const {
+  return this->kernel;
+}
+
+/**
+ * Picks a kernel for this CPU: IFMA when it is there, then the scalar MULX
+ * kernel, then AVX2, then the portable scalar kernel.
+ */
+MultiBufferModExp::Kernel MultiBufferModExp::DetectKernel() {
+  if (KernelSupported(Kernel::AVX512_IFMA)) {
+    return Kernel::AVX512_IFMA;
+  }
+#ifdef FIXED_UINT_MULX
+  if (HasMulxAdx()) {
+    return Kernel::SCALAR;
+  }
+#endif
+  if (KernelSupported(Kernel::AVX2)) {
+    return Kernel::AVX2;
+  }
+  return Kernel::SCALAR;
+}
@@ -21,6 +21,7 @@ RegistrarClient::RegistrarClient(RegistrarConfig registrar_config,
   this->common_config = common_config;
   this->num_candidates = std::stoi(common_config.num_candidates);
   this->k = std::stoi(common_config.k);
+  this->group = &ElectionGroup(common_config.group);
   this->cli_driver = std::make_shared<CLIDriver>();
   this->db_driver = std::make_shared<DBDriver>();
   this->db_driver->open(this->common_config.db_path);
@@ -48,8 +49,11 @@ RegistrarClient::RegistrarClient(RegistrarConfig registrar_config,
 
   // Load election public key
   try {
-    LoadElectionPublicKey(common_config.arbiter_public_key_paths,
-                          &this->EG_arbiter_public_key);
+    std::vector<CryptoPP::Integer> arbiter_public_keys;
+    LoadElectionPublicKeys(common_config.arbiter_public_key_paths,
+                           &arbiter_public_keys);
+    this->EG_arbiter_public_key =
+        this->group->CombinePublicKeys(arbiter_public_keys);
   } catch (CryptoPP::FileStore::OpenErr) {
     this->cli_driver->print_warning("Error loading arbiter public keys; "
                                     "application may be non-functional.");
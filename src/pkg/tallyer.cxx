@@ -24,6 +24,7 @@ TallyerClient::TallyerClient(TallyerConfig tallyer_config,
   this->common_config = common_config;
   this->num_candidates = std::stoi(common_config.num_candidates);
   this->k = std::stoi(common_config.k);
+  this->group = &ElectionGroup(common_config.group);
   this->cli_driver = std::make_shared<CLIDriver>();
   this->db_driver = std::make_shared<DBDriver>();
   this->db_driver->open(this->common_config.db_path);
@@ -51,8 +52,13 @@ TallyerClient::TallyerClient(TallyerConfig tallyer_config,
 
   // Load election public key
   try {
-    LoadElectionPublicKey(common_config.arbiter_public_key_paths,
-                          &this->EG_arbiter_public_key);
+    std::vector<CryptoPP::Integer> arbiter_public_keys;
+    LoadElectionPublicKeys(common_config.arbiter_public_key_paths,
+                           &arbiter_public_keys);
+    this->EG_arbiter_public_key =
+        this->group->CombinePublicKeys(arbiter_public_keys);
+    this->EG_arbiter_public_key_table = std::make_shared<FixedBaseTable>(
+        *this->group, this->EG_arbiter_public_key);
   } catch (CryptoPP::FileStore::OpenErr) {
     this->cli_driver->print_warning("Error loading arbiter public keys; "
                                     "application may be non-functional.");
@@ -66,6 +72,12 @@ TallyerClient::TallyerClient(TallyerConfig tallyer_config,
     this->cli_driver->print_warning("Error loading registrar public key; "
                                     "application may be non-functional.");
   }
+
+  // Bring the aggregate up to date with the votes already on the board.
+  if (this->EG_arbiter_public_key_table) {
+    std::unique_lock<std::mutex> lck(this->aggregate_mtx);
+    this->CurrentAggregate(std::make_shared<CryptoDriver>());
+  }
 }
 
 /**
@@ -149,8 +161,8 @@ TallyerClient::HandleKeyExchange(std::shared_ptr<NetworkDriver> network_driver,
  * 1) Handles key exchange.
  * 2) Receives a vote from the user, makes sure the user hasn't voted yet,
  *    verifies its certificate, the voter signature, and the zkp.
- * 3) Signs the vote and publishes it to the database if it is valid.
- * 4) Mark this user as having already voted.
+ * 3) Signs the vote and, if it is valid, publishes it to the database.
+ * 4) Mark this user as having already voted, in the same transaction.
  * Disconnect and throw an error if any MACs, certs, or zkps are invalid
  * or if the user has already voted.
  */
@@ -158,6 +170,12 @@ void TallyerClient::HandleTally(std::shared_ptr<NetworkDriver> network_driver,
                                 std::shared_ptr<CryptoDriver> crypto_driver) {
   // TODO: implement me!
 
+  if (!this->EG_arbiter_public_key_table) {
+    this->cli_driver->print_warning("No election public key loaded");
+    network_driver->disconnect();
+    return;
+  }
+
   // // key exchange
   std::pair<CryptoPP::SecByteBlock, CryptoPP::SecByteBlock> keys = 
     this->HandleKeyExchange(network_driver, crypto_driver);
@@ -176,7 +194,8 @@ void TallyerClient::HandleTally(std::shared_ptr<NetworkDriver> network_driver,
   VoterToTallyer_Vote_Message voter_to_tallyer_msg;
   voter_to_tallyer_msg.deserialize(voter_to_tallyer_cipher.first);
 
-  // check that the user has not voted
+  // check that the user has not voted, before verifying anything; checked
+  // again when the ballot is stored
   if (this->db_driver->voter_voted(voter_to_tallyer_msg.cert.id)) {
     this->cli_driver->print_warning("Voter has previously voted");
     network_driver->disconnect();
@@ -192,10 +211,32 @@ void TallyerClient::HandleTally(std::shared_ptr<NetworkDriver> network_driver,
     return;
   }
 
-  //verify the voter's signature
-  std::vector<unsigned char> vote_info_str = 
-    concat_votes_and_zkps(voter_to_tallyer_msg.votes, voter_to_tallyer_msg.zkps, 
-                          voter_to_tallyer_msg.vote_count, voter_to_tallyer_msg.count_zkps);
+  // check the ballot has one vote per candidate, each a pair of elements of
+  // the prime-order subgroup, and a proof for each count; anything else must
+  // not reach the aggregate the arbiters decrypt
+  bool malformed = voter_to_tallyer_msg.votes.votes.size() != this->num_candidates ||
+                   voter_to_tallyer_msg.zkps.zkps.size() != this->num_candidates ||
+                   voter_to_tallyer_msg.count_zkps.count_zkps.size() != this->k + 1;
+  std::vector<GroupElement> elements;
+  for (auto &vote : voter_to_tallyer_msg.votes.votes) {
+    elements.push_back(vote.a);
+    elements.push_back(vote.b);
+  }
+  for (bool in_subgroup : this->group->BatchIsSubgroupElement(elements)) {
+    malformed = malformed || !in_subgroup;
+  }
+  if (malformed) {
+    this->cli_driver->print_warning("Malformed ballot provided by voter");
+    network_driver->disconnect();
+    return;
+  }
+
+  // recompute the vote count, which the ballot does not carry
+  Vote_Struct vote_count = ElectionClient::CountVotes(*this->group, voter_to_tallyer_msg.votes);
+
+  //verify the voter's signature, on the ballot's bytes as received
+  BallotView ballot = view_ballot(voter_to_tallyer_msg);
+  std::vector<unsigned char> vote_info_str = concat_votes_and_zkps(ballot, vote_count);
 
   if (!(crypto_driver->DSA_verify(voter_to_tallyer_msg.cert.verification_key, vote_info_str, voter_to_tallyer_msg.voter_signature))) {
     this->cli_driver->print_warning("Invalid voter signature provided in voter to tallyer message");
@@ -204,31 +245,100 @@ void TallyerClient::HandleTally(std::shared_ptr<NetworkDriver> network_driver,
   }
 
   // check zkps for each vote
-  std::pair<Votes_Struct, VoteZKPs_Struct> votes = 
-    std::make_pair(voter_to_tallyer_msg.votes, voter_to_tallyer_msg.zkps);
-  if (!(ElectionClient::VerifyVoteZKPs(votes, this->EG_arbiter_public_key))) {
+  if (!(ElectionClient::VerifyVoteZKPs(*this->group, voter_to_tallyer_msg.votes, voter_to_tallyer_msg.zkps,
+                                       *this->EG_arbiter_public_key_table))) {
     this->cli_driver->print_warning("Invalid zkp provided by voter");
     network_driver->disconnect();
     return;
   }
 
   // check zkps for vote count
-  std::pair<Vote_Struct, Count_ZKPs_Struct> vote_count = 
-    std::make_pair(voter_to_tallyer_msg.vote_count, voter_to_tallyer_msg.count_zkps);
-  if (!(ElectionClient::VerifyCountZKPs(vote_count, this->EG_arbiter_public_key))) {
+  if (!(ElectionClient::VerifyCountZKPs(*this->group, vote_count, voter_to_tallyer_msg.count_zkps,
+                                        *this->EG_arbiter_public_key_table))) {
     this->cli_driver->print_warning("Invalid count zkp provided by voter");
     network_driver->disconnect();
     return;
   }
 
-  // create a TallyerToWorld_Vote_Message, add the votes to the database, and mark the voter as having voted
-  TallyerToWorld_Vote_Message vote_row;
-  vote_row.votes = voter_to_tallyer_msg.votes;
-  vote_row.zkps = voter_to_tallyer_msg.zkps;
-  vote_row.vote_count = voter_to_tallyer_msg.vote_count;
-  vote_row.count_zkps = voter_to_tallyer_msg.count_zkps;
-  vote_row.tallyer_signature = crypto_driver->DSA_sign(this->DSA_tallyer_signing_key, vote_info_str);
+  // sign the ballot, add it to the database as received, and mark the voter as having voted
+  std::string tallyer_signature = crypto_driver->DSA_sign(this->DSA_tallyer_signing_key, vote_info_str);
+  ballot.tallyer_signature = tallyer_signature;
+
+  // fold the ballot into the running aggregate and store both together,
+  // the ballot as the next row of the vote table, marking the voter as
+  // having voted in the same transaction; a voter's second connection
+  // waits on the lock and is then refused
+  std::unique_lock<std::mutex> lck(this->aggregate_mtx);
+  AggregateRow aggregate = this->CurrentAggregate(crypto_driver);
+  aggregate.votes = ElectionClient::FoldVotes(*this->group, std::move(aggregate.votes), voter_to_tallyer_msg.votes);
+  aggregate.ballot_count += CryptoPP::Integer::One();
+  aggregate.last_row_id += CryptoPP::Integer::One();
+  std::vector<unsigned char> aggregate_str =
+    concat_votes_and_count(aggregate.votes, aggregate.ballot_count, aggregate.last_row_id);
+  aggregate.tallyer_signature = crypto_driver->DSA_sign(this->DSA_tallyer_signing_key, aggregate_str);
+
+  if (!this->db_driver->insert_vote_and_aggregate(voter_to_tallyer_msg.cert.id, ballot, aggregate)) {
+    this->cli_driver->print_warning("Ballot not stored; the voter may have previously voted");
+    network_driver->disconnect();
+    return;
+  }
+}
+
+/**
+ * Return the running aggregate, first rebuilding it from the votes if it is
+ * invalid or does not cover every vote on the board, such as on a board
+ * filled before the aggregate was kept. A rebuilt aggregate holds the votes
+ * an audit would count: those whose zkps and tallyer signature are valid.
+ * Call with the aggregate mutex held.
+ */
+AggregateRow TallyerClient::CurrentAggregate(std::shared_ptr<CryptoDriver> crypto_driver) {
+  CryptoPP::Integer last_vote_row_id;
+  AggregateRow aggregate = this->db_driver->find_aggregate(&last_vote_row_id);
+  if (last_vote_row_id.IsZero()) {
+    // an empty board
+    aggregate.votes = ElectionClient::CombineVotes(*this->group, std::vector<VoteRow>(), this->num_candidates);
+    aggregate.ballot_count = CryptoPP::Integer::Zero();
+    aggregate.last_row_id = CryptoPP::Integer::Zero();
+    return aggregate;
+  }
+  std::vector<unsigned char> aggregate_str =
+    concat_votes_and_count(aggregate.votes, aggregate.ballot_count, aggregate.last_row_id);
+  if (aggregate.last_row_id == last_vote_row_id &&
+      crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, aggregate_str, aggregate.tallyer_signature) &&
+      aggregate.votes.votes.size() == this->num_candidates) {
+    return aggregate;
+  }
+
+  // combine every valid vote
+  BallotBatch votes;
+  this->db_driver->all_votes(votes);
+  std::vector<int> valid_votes;
+  std::vector<bool> zkps_valid = ElectionClient::BatchVerifyBallots(
+      *this->group, votes, this->num_candidates, this->k, *this->EG_arbiter_public_key_table);
+
+  for (int i=0; i<votes.Size(); i++) {
+    if (!zkps_valid[i]) {
+      continue;
+    }
+
+    Vote_Struct vote_count = ElectionClient::CountVotes(*this->group, votes[i]);
+    std::vector<unsigned char> vote_info_str = concat_votes_and_zkps(votes[i], vote_count);
+    if (!(crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, vote_info_str,
+                                    votes[i].tallyer_signature))) {
+      continue;
+    }
+
+    valid_votes.push_back(i);
+  }
+
+  aggregate.votes = ElectionClient::CombineVotes(*this->group, votes, valid_votes, this->num_candidates);
+  aggregate.ballot_count = CryptoPP::Integer((long)valid_votes.size());
+  aggregate.last_row_id = last_vote_row_id;
+  aggregate_str = concat_votes_and_count(aggregate.votes, aggregate.ballot_count, aggregate.last_row_id);
+  aggregate.tallyer_signature = crypto_driver->DSA_sign(this->DSA_tallyer_signing_key, aggregate_str);
+  this->db_driver->insert_aggregate(aggregate);
 
-  this->db_driver->insert_vote(vote_row);
-  this->db_driver->insert_voted(voter_to_tallyer_msg.cert.id);
+  this->cli_driver->print_info("Rebuilt the aggregate from " +
+                               std::to_string(valid_votes.size()) + " votes");
+  return aggregate;
 }
@@ -0,0 +1,135 @@
+#include "../../include/pkg/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+// A ParallelFor in progress
+struct ThreadPool::Loop {
+  const std::function<void(int)> *task;
+  int count;
+  std::atomic<int> next{0};     // first unclaimed iteration
+  std::atomic<int> finished{0}; // iterations done
+
+  std::mutex mtx;
+  std::condition_variable done;
+  std::exception_ptr error; // the first thrown
+};
+
+/**
+ * Starts the workers.
+ */
+ThreadPool::ThreadPool(int num_threads) {
+  this->stopping = false;
+  for (int i = 0; i < num_threads; i++) {
+    this->workers.emplace_back(&ThreadPool::Work, this);
+  }
+}
+
+/**
+ * Stops the workers, after the loops they are helping with.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lck(this->mtx);
+    this->stopping = true;
+  }
+  this->cv.notify_all();
+  for (auto &worker : this->workers) {
+    worker.join();
+  }
+}
+
+/**
+ * Runs the loop on the calling thread and up to one worker per remaining
+ * iteration, waiting for the iterations the workers claimed.
+ */
+void ThreadPool::ParallelFor(int count, const std::function<void(int)> &task) {
+  if (count <= 0) {
+    return;
+  }
+  auto loop = std::make_shared<Loop>();
+  loop->task = &task;
+  loop->count = count;
+
+  int helpers = std::min<int>(count - 1, this->workers.size());
+  if (helpers > 0) {
+    {
+      std::unique_lock<std::mutex> lck(this->mtx);
+      for (int i = 0; i < helpers; i++) {
+        this->loops.push_back(loop);
+      }
+    }
+    this->cv.notify_all();
+  }
+
+  RunLoop(*loop);
+  std::unique_lock<std::mutex> lck(loop->mtx);
+  loop->done.wait(lck, [&] { return loop->finished == count; });
+  if (loop->error) {
+    std::rethrow_exception(loop->error);
+  }
+}
+
+/**
+ * Number of worker threads.
+ */
+int ThreadPool::Size() const { return this->workers.size(); }
+
+/**
+ * The process-wide pool. The threads that start a loop help run it, so
+ * hardware_concurrency - 1 workers keep every core busy.
+ */
+ThreadPool &ThreadPool::Shared() {
+  static ThreadPool pool(
+      std::max<int>(1, (int)std::thread::hardware_concurrency() - 1));
+  return pool;
+}
+
+/**
+ * Claims and runs iterations until none are left. An iteration that throws
+ * records the error; the rest still run, so the loop can finish.
+ */
+void ThreadPool::RunLoop(Loop &loop) {
+  while (true) {
+    int i = loop.next++;
+    if (i >= loop.count) {
+      return;
+    }
+    try {
+      (*loop.task)(i);
+    } catch (...) {
+      std::unique_lock<std::mutex> lck(loop.mtx);
+      if (!loop.error) {
+        loop.error = std::current_exception();
+      }
+    }
+    if (++loop.finished == loop.count) {
+      std::unique_lock<std::mutex> lck(loop.mtx);
+      loop.done.notify_all();
+    }
+  }
+}
+
+/**
+ * Worker thread: helps with queued loops until the pool is stopped. A loop
+ * that has already been claimed in full is dropped at once.
+ */
+void ThreadPool::Work() {
+  std::unique_lock<std::mutex> lck(this->mtx);
+  while (true) {
+    this->cv.wait(lck, [this] {
+      return this->stopping || !this->loops.empty();
+    });
+    if (this->loops.empty()) {
+      return;
+    }
+    std::shared_ptr<Loop> loop = std::move(this->loops.front());
+    this->loops.pop_front();
+
+    // run without holding the lock
+    lck.unlock();
+    RunLoop(*loop);
+    lck.lock();
+  }
+}
@@ -26,6 +26,7 @@ VoterClient::VoterClient(std::shared_ptr<NetworkDriver> network_driver,
   this->common_config = common_config;
   this->num_candidates = std::stoi(common_config.num_candidates);
   this->k = std::stoi(common_config.k);
+  this->group = &ElectionGroup(common_config.group);
   this->network_driver = network_driver;
   this->crypto_driver = crypto_driver;
   this->cli_driver = std::make_shared<CLIDriver>();
@@ -54,8 +55,16 @@ VoterClient::VoterClient(std::shared_ptr<NetworkDriver> network_driver,
 
   // Load election public key
   try {
-    LoadElectionPublicKey(common_config.arbiter_public_key_paths,
-                          &this->EG_arbiter_public_key);
+    std::vector<CryptoPP::Integer> arbiter_public_keys;
+    LoadElectionPublicKeys(common_config.arbiter_public_key_paths,
+                           &arbiter_public_keys);
+    this->EG_arbiter_public_key =
+        this->group->CombinePublicKeys(arbiter_public_keys);
+    this->EG_arbiter_public_key_table = std::make_shared<FixedBaseTable>(
+        *this->group, this->EG_arbiter_public_key);
+    this->ballot_pool = std::make_shared<BallotPool>(
+        *this->group, this->EG_arbiter_public_key_table, this->num_candidates,
+        this->k);
   } catch (CryptoPP::FileStore::OpenErr) {
     this->cli_driver->print_warning("Error loading arbiter public keys; "
                                     "application may be non-functional.");
@@ -90,7 +99,7 @@ void VoterClient::run() {
                   &VoterClient::HandleRegister);
   repl.add_action("vote", "vote <address> <port> {0, 1}, ..., {0, 1}",
                   &VoterClient::HandleVote);
-  repl.add_action("verify", "verify", &VoterClient::HandleVerify);
+  repl.add_action("verify", "verify [audit]", &VoterClient::HandleVerify);
   repl.run();
 }
 
@@ -198,24 +207,26 @@ void VoterClient::HandleRegister(std::string input) {
 
 /**
  * Handle voting with the tallyer. This function:
- * 1) Handles key exchange.
- * 2) Generates a vote and zkp.
- * 3) Signs the vote and sends it to the tallyer
+ * 1) Generates a vote and zkp from a precomputed ballot.
+ * 2) Signs the vote.
+ * 3) Handles key exchange and sends it to the tallyer
+ * The ballot is ready before connecting, so the connection is only held
+ * for the key exchange and the send.
  */
 void VoterClient::HandleVote(std::string input) {
-  // Parse input and connect to tallyer
+  // Parse input
   std::vector<std::string> args = string_split(input, ' ');
-  if ((args.size() - 3) != this->num_candidates) {
+  if (args.size() < 3 || (args.size() - 3) != this->num_candidates) {
     this->cli_driver->print_warning("Must vote for exactly " + std::to_string(this->num_candidates) + " candidates");
+    return;
+  }
+  if (!this->EG_arbiter_public_key_table) {
+    this->cli_driver->print_warning("No election public key loaded");
+    return;
   }
-  this->network_driver->connect(args[1], std::stoi(args[2]));
 
   // TODO: implement me!
 
-  // handle key exchange
-  std::pair<CryptoPP::SecByteBlock, CryptoPP::SecByteBlock> keys = 
-    this->HandleKeyExchange(this->DSA_tallyer_verification_key);
-
   // generate a vote
   int num_votes = 0;
   std::vector<CryptoPP::Integer> vote_nums;
@@ -231,32 +242,36 @@ void VoterClient::HandleVote(std::string input) {
     }
   }
 
+  PrecomputedBallot pre = this->ballot_pool->Take();
+
   // votes + zkps for each vote
-  std::tuple<Votes_Struct, VoteZKPs_Struct, CryptoPP::Integer> votes =
-    ElectionClient::GenerateVotes(vote_nums, this->EG_arbiter_public_key);
+  std::tuple<Votes_Struct, VoteZKPs_Struct, Scalar> votes =
+    ElectionClient::GenerateVotes(*this->group, vote_nums, *this->EG_arbiter_public_key_table, pre);
   
   // vote count zkps
-  Votes_Struct votes_struct = std::get<0>(votes);
-  VoteZKPs_Struct zkps_struct = std::get<1>(votes);
-  CryptoPP::Integer r = std::get<2>(votes);
+  Scalar r = std::get<2>(votes);
 
   std::pair<Vote_Struct, Count_ZKPs_Struct> count_zkps =
-    ElectionClient::GenerateCountZKPs(votes_struct.votes, num_votes, this->k, r, this->EG_arbiter_public_key);
+    ElectionClient::GenerateCountZKPs(*this->group, std::get<0>(votes).votes, num_votes, this->k, r, *this->EG_arbiter_public_key_table, pre);
   
   VoterToTallyer_Vote_Message voter_to_tallyer_msg;
   voter_to_tallyer_msg.cert = this->certificate;
-  voter_to_tallyer_msg.votes = votes_struct;
-  voter_to_tallyer_msg.zkps = zkps_struct;
-
-  voter_to_tallyer_msg.vote_count = count_zkps.first;
-  voter_to_tallyer_msg.count_zkps = count_zkps.second;
+  voter_to_tallyer_msg.votes = std::move(std::get<0>(votes));
+  voter_to_tallyer_msg.zkps = std::move(std::get<1>(votes));
+  voter_to_tallyer_msg.count_zkps = std::move(count_zkps.second);
 
   std::vector<unsigned char> vote_info_str = 
-    concat_votes_and_zkps(votes_struct, zkps_struct, count_zkps.first, count_zkps.second); 
+    concat_votes_and_zkps(voter_to_tallyer_msg.votes, voter_to_tallyer_msg.zkps, count_zkps.first,
+                          voter_to_tallyer_msg.count_zkps);
 
   voter_to_tallyer_msg.voter_signature = 
     this->crypto_driver->DSA_sign(this->DSA_voter_signing_key, vote_info_str);
 
+  // connect to tallyer and handle key exchange
+  this->network_driver->connect(args[1], std::stoi(args[2]));
+  std::pair<CryptoPP::SecByteBlock, CryptoPP::SecByteBlock> keys = 
+    this->HandleKeyExchange(this->DSA_tallyer_verification_key);
+
   std::vector<unsigned char> encrypted_voter_to_tallyer_msg = 
     this->crypto_driver->encrypt_and_tag(keys.first, keys.second, &voter_to_tallyer_msg);
   this->network_driver->send(encrypted_voter_to_tallyer_msg);
@@ -269,7 +284,8 @@ void VoterClient::HandleVote(std::string input) {
  */
 void VoterClient::HandleVerify(std::string input) {
   // Verify
-  auto result = this->DoVerify();
+  std::vector<std::string> args = string_split(input, ' ');
+  auto result = this->DoVerify(args.size() > 1 && args[1] == "audit");
 
   // Error if election failed
   if (!std::get<2>(result)) {
@@ -293,59 +309,131 @@ void VoterClient::HandleVerify(std::string input) {
 
 /**
  * Handle verifying the results of the election. This function
- * 1) Verifies all vote ZKPs
- * 2) Verifies all partial decryption
- * 3) Combines the partial decryptions to retrieve the final result
- * 4) Returns a tuple of <0-votes, 1-votes, success>
+ * 1) Reads the tallyer's running aggregate and verifies its signature and
+ *    that it covers every vote
+ * 2) With `audit`, instead verifies all vote ZKPs, combines the valid votes,
+ *    and checks that the aggregate matches them
+ * 3) Verifies all partial decryption, and that each is of the combined votes
+ * 4) Combines the partial decryptions to retrieve the final result
+ * 5) Returns a tuple of <0-votes, 1-votes, success>
  * If a vote is invalid, don't include it in the final combined vote or
  * throw an error either.
  */
-std::tuple<std::vector<CryptoPP::Integer>, std::vector<CryptoPP::Integer>, bool> VoterClient::DoVerify() {
+std::tuple<std::vector<CryptoPP::Integer>, std::vector<CryptoPP::Integer>, bool> VoterClient::DoVerify(bool audit) {
   // TODO: implement me!
+  if (!this->EG_arbiter_public_key_table) {
+    this->cli_driver->print_warning("No election public key loaded");
+    return std::make_tuple(std::vector<CryptoPP::Integer>(),
+                           std::vector<CryptoPP::Integer>(), false);
+  }
 
-  std::vector<VoteRow> votes = this->db_driver->all_votes();
-  std::vector<VoteRow> valid_votes;
-
-  for (int i=0; i<votes.size(); i++) {
-    std::pair<Votes_Struct, VoteZKPs_Struct> vote = std::make_pair(votes[i].votes, votes[i].zkps);
-    if (!(ElectionClient::VerifyVoteZKPs(vote, this->EG_arbiter_public_key))) {
-      continue;
+  // read the tallyer's running aggregate, which must cover every vote on
+  // the board; an empty board has none
+  CryptoPP::Integer last_vote_row_id;
+  AggregateRow aggregate = this->db_driver->find_aggregate(&last_vote_row_id);
+  if (last_vote_row_id.IsZero()) {
+    aggregate.votes = ElectionClient::CombineVotes(*this->group, std::vector<VoteRow>(), this->num_candidates);
+    aggregate.ballot_count = CryptoPP::Integer::Zero();
+  } else {
+    std::vector<unsigned char> aggregate_str =
+      concat_votes_and_count(aggregate.votes, aggregate.ballot_count, aggregate.last_row_id);
+    if (aggregate.last_row_id != last_vote_row_id ||
+        !(this->crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, aggregate_str, aggregate.tallyer_signature)) ||
+        aggregate.votes.votes.size() != this->num_candidates) {
+      if (!audit) {
+        this->cli_driver->print_warning("Missing, invalid or out of date aggregate; rerun with audit to rescan the votes");
+        return std::make_tuple(std::vector<CryptoPP::Integer>(),
+                               std::vector<CryptoPP::Integer>(), false);
+      }
+      aggregate.votes = Votes_Struct();
     }
+  }
 
-    std::pair<Vote_Struct, Count_ZKPs_Struct> vote_count = std::make_pair(votes[i].vote_count, votes[i].count_zkps);
-    if (!(ElectionClient::VerifyCountZKPs(vote_count, this->EG_arbiter_public_key))) {
-      continue;
+  Votes_Struct combined_votes = aggregate.votes;
+  long num_valid_votes = aggregate.ballot_count.ConvertToLong();
+  if (audit) {
+    BallotBatch votes;
+    this->db_driver->all_votes(votes);
+    std::vector<int> valid_votes;
+    std::vector<bool> zkps_valid = ElectionClient::BatchVerifyBallots(
+        *this->group, votes, this->num_candidates, this->k, *this->EG_arbiter_public_key_table);
+
+    for (int i=0; i<votes.Size(); i++) {
+      if (!zkps_valid[i]) {
+        continue;
+      }
+
+      Vote_Struct vote_count = ElectionClient::CountVotes(*this->group, votes[i]);
+      std::vector<unsigned char> vote_info_str = concat_votes_and_zkps(votes[i], vote_count);
+      if (!(this->crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, vote_info_str,
+                                            votes[i].tallyer_signature))) {
+        continue;
+      }
+
+      valid_votes.push_back(i);
     }
 
-    std::vector<unsigned char> vote_info_str = 
-      concat_votes_and_zkps(votes[i].votes, votes[i].zkps, votes[i].vote_count, votes[i].count_zkps);
-    if (!(this->crypto_driver->DSA_verify(this->DSA_tallyer_verification_key, vote_info_str, votes[i].tallyer_signature))) {
-      continue;
+    combined_votes = ElectionClient::CombineVotes(*this->group, votes, valid_votes, this->num_candidates);
+    std::vector<unsigned char> combined_data;
+    combined_votes.serialize(combined_data);
+    std::vector<unsigned char> aggregate_data;
+    aggregate.votes.serialize(aggregate_data);
+    if (combined_data != aggregate_data || num_valid_votes != valid_votes.size()) {
+      this->cli_driver->print_warning("Aggregate does not match the votes; using the votes");
     }
-
-    valid_votes.push_back(votes[i]);
+    num_valid_votes = valid_votes.size();
   }
 
-  Votes_Struct combined_votes = ElectionClient::CombineVotes(valid_votes, this->num_candidates);
-
   bool success = true;
   std::vector<PartialDecryptionRow> partial_dec_rows = this->db_driver->all_partial_decryptions();
 
   for (int i=0; i<partial_dec_rows.size(); i++) {
-    PartialDecryptionRow row = partial_dec_rows[i];
+    const PartialDecryptionRow &row = partial_dec_rows[i];
     CryptoPP::Integer pki;
     LoadInteger(row.arbiter_vk_path, &pki);
-    if (!(ElectionClient::VerifyPartialDecryptZKPs(row, pki))) {
+    if (!(ElectionClient::VerifyPartialDecryptZKPs(*this->group, row, pki))) {
       success = false;
       break;
     }
   }
 
-  std::vector<CryptoPP::Integer> zeros;
+  // every arbiter must have decrypted the votes combined here, one
+  // decryption per candidate
+  for (int i=0; i<partial_dec_rows.size(); i++) {
+    const std::vector<PartialDecryption_Struct> &decs = partial_dec_rows[i].decs.decs;
+    bool matches = decs.size() == this->num_candidates &&
+                   combined_votes.votes.size() == this->num_candidates;
+    for (int j=0; matches && j<decs.size(); j++) {
+      matches = decs[j].aggregate_ciphertext.a == combined_votes.votes[j].a &&
+                decs[j].aggregate_ciphertext.b == combined_votes.votes[j].b;
+    }
+    if (!matches) {
+      this->cli_driver->print_warning("Partial decryption by " + partial_dec_rows[i].arbiter_id +
+                                      " does not match the combined votes");
+      return std::make_tuple(std::vector<CryptoPP::Integer>(),
+                             std::vector<CryptoPP::Integer>(), false);
+    }
+  }
+
+  // every tally is at most the number of valid ballots
+  if (!this->tally_dlog_table ||
+      this->tally_dlog_table->GetBound() < num_valid_votes) {
+    this->tally_dlog_table =
+        std::make_shared<DiscreteLogTable>(*this->group, num_valid_votes);
+  }
 
-  std::vector<CryptoPP::Integer> ones = ElectionClient::CombineResults(combined_votes, partial_dec_rows);
+  std::vector<CryptoPP::Integer> zeros;
+  std::vector<CryptoPP::Integer> ones;
+  try {
+    ones = ElectionClient::CombineResults(*this->group, combined_votes, partial_dec_rows,
+                                          *this->tally_dlog_table);
+  } catch (std::runtime_error &e) {
+    this->cli_driver->print_warning(e.what());
+    return std::make_tuple(std::vector<CryptoPP::Integer>(),
+                           std::vector<CryptoPP::Integer>(), false);
+  }
   for (int i=0; i<ones.size(); i++) {
-    CryptoPP::Integer num_zeros(valid_votes.size() - ones[i]);
+    CryptoPP::Integer num_zeros(CryptoPP::Integer(num_valid_votes) - ones[i]);
     zeros.push_back(num_zeros);
   }
 
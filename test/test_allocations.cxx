@@ -0,0 +1,204 @@
+#include "doctest/doctest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <crypto++/integer.h>
+
+#include "../include-shared/ballot_batch.hpp"
+#include "../include-shared/rng.hpp"
+#include "../include/drivers/crypto_driver.hpp"
+#include "../include/drivers/db_driver.hpp"
+#include "../include/pkg/election.hpp"
+
+namespace {
+std::atomic<long> allocations{0};
+std::atomic<long> allocated_bytes{0};
+
+void *Allocate(std::size_t size) {
+  allocations++;
+  allocated_bytes += size;
+  void *p = std::malloc(size == 0 ? 1 : size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+} // namespace
+
+// Every allocation in the test binary is counted; the counts are only read
+// around the flows below.
+void *operator new(std::size_t size) { return Allocate(size); }
+void *operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+const int NUM_CANDIDATES = 3;
+const int K = 2;
+
+struct Count {
+  double allocations;
+  double bytes;
+};
+
+/**
+ * Runs f once to warm caches, then returns the mean allocations of reps
+ * more runs.
+ */
+template <typename F> Count Measure(int reps, F f) {
+  f();
+  long start = allocations.load();
+  long start_bytes = allocated_bytes.load();
+  for (int i = 0; i < reps; i++) {
+    f();
+  }
+  return Count{double(allocations.load() - start) / reps,
+               double(allocated_bytes.load() - start_bytes) / reps};
+}
+
+/**
+ * A voter's and a tallyer's view of one election: its keys, a channel's
+ * keys, and a board in memory.
+ */
+struct Election {
+  const GroupContext &group;
+  CryptoDriver crypto_driver;
+  std::pair<CryptoPP::DSA::PrivateKey, CryptoPP::DSA::PublicKey> dsa;
+  FixedBaseTable pk;
+  CryptoPP::SecByteBlock aes_key;
+  CryptoPP::SecByteBlock hmac_key;
+  DBDriver db_driver;
+
+  explicit Election(const std::string &name)
+      : group(ElectionGroup(name)), dsa(crypto_driver.DSA_generate_keys()),
+        pk(group, group.Generator().Exponentiate(group.RandomScalar()).ToInteger()),
+        aes_key(16), hmac_key(32) {
+    ThreadRNG().GenerateBlock(this->aes_key, this->aes_key.size());
+    ThreadRNG().GenerateBlock(this->hmac_key, this->hmac_key.size());
+    this->db_driver.open(":memory:");
+    this->db_driver.init_tables();
+
+    AggregateRow aggregate;
+    aggregate.votes = ElectionClient::CombineVotes(this->group, std::vector<VoteRow>(), NUM_CANDIDATES);
+    aggregate.ballot_count = CryptoPP::Integer::Zero();
+    aggregate.last_row_id = CryptoPP::Integer::Zero();
+    this->db_driver.insert_aggregate(aggregate);
+  }
+
+  /**
+   * A ballot for the first and last candidates, encrypted for the tallyer,
+   * as VoterClient::HandleVote sends it.
+   */
+  std::vector<unsigned char> Cast(const PrecomputedBallot &pre) {
+    std::vector<CryptoPP::Integer> votes = {CryptoPP::Integer::One(), CryptoPP::Integer::Zero(),
+                                            CryptoPP::Integer::One()};
+    auto generated = ElectionClient::GenerateVotes(this->group, votes, this->pk, pre);
+    auto count = ElectionClient::GenerateCountZKPs(this->group, std::get<0>(generated).votes, 2, K,
+                                                   std::get<2>(generated), this->pk, pre);
+
+    VoterToTallyer_Vote_Message msg;
+    msg.cert.id = "voter";
+    msg.cert.verification_key = this->dsa.second;
+    msg.votes = std::move(std::get<0>(generated));
+    msg.zkps = std::move(std::get<1>(generated));
+    msg.count_zkps = std::move(count.second);
+    std::vector<unsigned char> info = concat_votes_and_zkps(msg.votes, msg.zkps, count.first, msg.count_zkps);
+    msg.voter_signature = this->crypto_driver.DSA_sign(this->dsa.first, info);
+    return this->crypto_driver.encrypt_and_tag(this->aes_key, this->hmac_key, &msg);
+  }
+
+  /**
+   * Checks a ballot from the wire and stores it with the new aggregate, as
+   * TallyerClient::HandleTally does. Returns whether it was stored.
+   */
+  bool Receive(const std::vector<unsigned char> &wire, const std::string &voter_id) {
+    std::pair<std::vector<unsigned char>, bool> plaintext =
+        this->crypto_driver.decrypt_and_verify(this->aes_key, this->hmac_key, wire);
+    if (!plaintext.second) {
+      return false;
+    }
+    VoterToTallyer_Vote_Message msg;
+    msg.deserialize(plaintext.first);
+
+    Vote_Struct vote_count = ElectionClient::CountVotes(this->group, msg.votes);
+    BallotView ballot = view_ballot(msg);
+    std::vector<unsigned char> info = concat_votes_and_zkps(ballot, vote_count);
+    if (!this->crypto_driver.DSA_verify(msg.cert.verification_key, info, msg.voter_signature) ||
+        !ElectionClient::VerifyVoteZKPs(this->group, msg.votes, msg.zkps, this->pk) ||
+        !ElectionClient::VerifyCountZKPs(this->group, vote_count, msg.count_zkps, this->pk)) {
+      return false;
+    }
+    std::string tallyer_signature = this->crypto_driver.DSA_sign(this->dsa.first, info);
+    ballot.tallyer_signature = tallyer_signature;
+
+    AggregateRow aggregate = this->db_driver.find_aggregate();
+    aggregate.votes = ElectionClient::FoldVotes(this->group, std::move(aggregate.votes), msg.votes);
+    aggregate.ballot_count += CryptoPP::Integer::One();
+    aggregate.last_row_id += CryptoPP::Integer::One();
+    std::vector<unsigned char> aggregate_str =
+        concat_votes_and_count(aggregate.votes, aggregate.ballot_count, aggregate.last_row_id);
+    aggregate.tallyer_signature = this->crypto_driver.DSA_sign(this->dsa.first, aggregate_str);
+    return this->db_driver.insert_vote_and_aggregate(voter_id, ballot, aggregate);
+  }
+};
+} // namespace
+
+TEST_CASE("casting, receiving and combining ballots do not copy them") {
+  for (const char *name : {"modp2048", "p256"}) {
+    CAPTURE(name);
+    Election election(name);
+    const int reps = 20;
+    std::vector<PrecomputedBallot> pres;
+    std::vector<std::string> voter_ids;
+    for (int i = 0; i < 2 * (reps + 1); i++) {
+      pres.push_back(ElectionClient::PrecomputeBallot(election.group, NUM_CANDIDATES, K, election.pk));
+      voter_ids.push_back("voter" + std::to_string(i));
+    }
+
+    // a board rejects a ballot it already holds, so each is cast afresh
+    int next = 0;
+    std::vector<std::vector<unsigned char>> wires;
+    wires.reserve(pres.size());
+    Count cast = Measure(2 * reps + 1, [&] { wires.push_back(election.Cast(pres[next++])); });
+    MESSAGE(name << " cast: " << cast.allocations << " allocations, " << cast.bytes << " bytes");
+
+    // the ballot's cost should not depend on how many are already stored
+    next = 0;
+    bool stored = true;
+    auto receive = [&] {
+      stored = election.Receive(wires[next], voter_ids[next]) && stored;
+      next++;
+    };
+    Count first = Measure(reps, receive);
+    Count second = Measure(reps, receive);
+    CHECK(stored);
+    MESSAGE(name << " receive: " << second.allocations << " allocations, " << second.bytes << " bytes");
+    CHECK(second.allocations <= first.allocations * 1.1);
+
+    // combining copies no rows: each extra row costs less than a copy of it
+    std::vector<VoteRow> rows = election.db_driver.all_votes();
+    REQUIRE(rows.size() == 2 * (reps + 1));
+    std::vector<VoteRow> small(200, rows[0]);
+    std::vector<VoteRow> large(400, rows[0]);
+    Count row_copy = Measure(reps, [&] { VoteRow copy(rows[0]); });
+    Votes_Struct combined;
+    Count combine_small = Measure(3, [&] {
+      combined = ElectionClient::CombineVotes(election.group, small, NUM_CANDIDATES);
+    });
+    Count combine_large = Measure(3, [&] {
+      combined = ElectionClient::CombineVotes(election.group, large, NUM_CANDIDATES);
+    });
+    MESSAGE(name << " combine 200: " << combine_small.allocations << " allocations, "
+                 << combine_small.bytes << " bytes; 400: " << combine_large.allocations
+                 << " allocations, " << combine_large.bytes << " bytes; a row copy: "
+                 << row_copy.allocations << " allocations, " << row_copy.bytes << " bytes");
+    double extra_rows = large.size() - small.size();
+    CHECK((combine_large.bytes - combine_small.bytes) / extra_rows < row_copy.bytes);
+  }
+}
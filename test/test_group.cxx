@@ -0,0 +1,182 @@
+#include "doctest/doctest.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include <crypto++/ecp.h>
+#include <crypto++/integer.h>
+
+#include "../include-shared/constants.hpp"
+#include "../include-shared/messages.hpp"
+#include "../include/pkg/election_math.hpp"
+
+namespace {
+const size_t POINT_SIZE = 33; // SEC1 compressed: a parity byte and x
+
+const CryptoPP::ECP &Curve() {
+  static const CryptoPP::ECP curve(EC_P, EC_A, EC_B);
+  return curve;
+}
+
+/**
+ * The group element Crypto++'s point p is sent as.
+ */
+GroupElement FromPoint(const CryptoPP::ECPPoint &p) {
+  GroupElement result;
+  if (p.identity) {
+    return result;
+  }
+  CryptoPP::byte encoded[POINT_SIZE];
+  Curve().EncodePoint(encoded, p, true);
+  REQUIRE(GroupElement::FromInteger(CryptoPP::Integer(encoded, POINT_SIZE), &result));
+  return result;
+}
+
+CryptoPP::ECPPoint ToPoint(const GroupElement &x) {
+  CryptoPP::ECPPoint p;
+  if (x.IsZero()) {
+    return p;
+  }
+  CryptoPP::byte encoded[POINT_SIZE];
+  x.ToInteger().Encode(encoded, POINT_SIZE);
+  REQUIRE(Curve().DecodePoint(p, encoded, POINT_SIZE));
+  return p;
+}
+
+GroupElement RandomPoint() {
+  const GroupContext &group = ECGroup();
+  return group.Generator().Exponentiate(group.RandomScalar());
+}
+
+Scalar ToScalar(const CryptoPP::Integer &x) {
+  Scalar result;
+  REQUIRE(Scalar::FromInteger(x, &result));
+  return result;
+}
+} // namespace
+
+TEST_CASE("curve multiplication matches Crypto++") {
+  const GroupContext &group = ECGroup();
+  const GroupElement identity;
+  for (int i = 0; i < 20; i++) {
+    GroupElement x = RandomPoint();
+    GroupElement y = RandomPoint();
+    // Crypto++ returns results in a buffer the next call overwrites
+    CryptoPP::ECPPoint p = ToPoint(x);
+    CryptoPP::ECPPoint q = ToPoint(y);
+    CryptoPP::ECPPoint minus_q = Curve().Inverse(q);
+
+    CHECK(group.Multiply(x, y) == FromPoint(Curve().Add(p, q)));
+    CHECK(group.Multiply(x, x) == FromPoint(Curve().Double(p)));
+    CHECK(group.Inverse(y) == FromPoint(minus_q));
+    CHECK(group.Divide(x, y) == FromPoint(Curve().Add(p, minus_q)));
+    CHECK(group.Multiply(y, group.Inverse(y)) == identity);
+    CHECK(group.Multiply(x, identity) == x);
+    CHECK(group.Multiply(identity, x) == x);
+    CHECK(group.BatchMultiply(std::vector<GroupElement>{x, y, x}) ==
+          FromPoint(Curve().Add(Curve().Double(p), q)));
+  }
+  CHECK(group.Multiply(identity, identity) == identity);
+  CHECK(group.Inverse(identity) == identity);
+}
+
+TEST_CASE("curve exponentiation matches Crypto++") {
+  const GroupContext &group = ECGroup();
+  CryptoPP::ECPPoint g(EC_GX, EC_GY);
+  REQUIRE(Curve().VerifyPoint(g));
+  CHECK(group.Generator().GetBase() == FromPoint(g).ToInteger());
+
+  std::vector<GroupElement> bases;
+  std::vector<Scalar> exponents;
+  std::vector<GroupElement> expected;
+  for (int i = 0; i < 10; i++) {
+    GroupElement x = RandomPoint();
+    Scalar e = group.RandomScalar();
+    GroupElement power = FromPoint(Curve().ScalarMultiply(ToPoint(x), e.ToInteger()));
+    CHECK(group.Exponentiate(x, e) == power);
+    CHECK(group.Generator().Exponentiate(e) == FromPoint(Curve().ScalarMultiply(g, e.ToInteger())));
+    bases.push_back(x);
+    exponents.push_back(e);
+    expected.push_back(power);
+
+    CHECK(group.Exponentiate(x, Scalar()) == GroupElement());
+    CHECK(group.Exponentiate(x, ToScalar(1)) == x);
+    CHECK(group.Exponentiate(x, ToScalar(2)) == group.Multiply(x, x));
+    CHECK(group.Exponentiate(x, ToScalar(EC_N - 1)) == group.Inverse(x));
+  }
+  CHECK(group.BatchExponentiate(bases, exponents) == expected);
+  CHECK(group.Exponentiate(GroupElement(), group.RandomScalar()) == GroupElement());
+  CHECK(group.Generator().Exponentiate(ToScalar(EC_N - 1)) == FromPoint(Curve().Inverse(g)));
+}
+
+TEST_CASE("curve points are sent in their compressed encoding") {
+  for (int i = 0; i < 20; i++) {
+    GroupElement x = RandomPoint();
+    CryptoPP::byte encoded[POINT_SIZE];
+    Curve().EncodePoint(encoded, ToPoint(x), true);
+
+    // a length byte, then the SEC1 encoding
+    std::vector<unsigned char> data;
+    put_integer(x, data, 2);
+    CHECK(size_of_integer(x, 2) == 1 + POINT_SIZE);
+    REQUIRE(data.size() == 1 + POINT_SIZE);
+    CHECK(std::vector<unsigned char>(data.begin() + 1, data.end()) ==
+          std::vector<unsigned char>(encoded, encoded + POINT_SIZE));
+
+    GroupElement read;
+    CHECK(get_integer(&read, data, 0, 2) == data.size());
+    CHECK(read == x);
+    CHECK(ECGroup().IsElement(read));
+  }
+}
+
+TEST_CASE("curve elements reject what is not a point") {
+  const GroupContext &group = ECGroup();
+  GroupElement x = RandomPoint();
+  CHECK(group.IsElement(x));
+  CHECK(group.IsElement(GroupElement())); // the identity
+
+  for (std::uint64_t parity : {0x00, 0x01, 0x04, 0x12}) {
+    GroupElement bad = x;
+    bad[4] = parity;
+    CAPTURE(parity);
+    CHECK_FALSE(group.IsElement(bad));
+  }
+
+  GroupElement high = x;
+  high[5] = 1;
+  CHECK_FALSE(group.IsElement(high));
+  CHECK_FALSE(group.IsSubgroupElement(high.ToInteger()));
+  CHECK_THROWS_AS(group.Multiply(high, x), std::runtime_error);
+
+  // an x for which x^3 - 3x + b has no square root
+  GroupElement off_curve = x;
+  CryptoPP::byte encoded[POINT_SIZE];
+  CryptoPP::ECPPoint p;
+  do {
+    off_curve[0]++;
+    off_curve.ToInteger().Encode(encoded, POINT_SIZE);
+  } while (Curve().DecodePoint(p, encoded, POINT_SIZE));
+  CHECK_FALSE(group.IsElement(off_curve));
+  std::vector<bool> expected = {true, false, false, true};
+  CHECK(group.BatchIsSubgroupElement({x, off_curve, high, GroupElement()}) == expected);
+}
+
+TEST_CASE("discrete logs are found up to the bound") {
+  for (const GroupContext *group : {&DLGroup(), &ECGroup()}) {
+    CAPTURE(group->Name());
+    const long bound = 300;
+    DiscreteLogTable table(*group, bound);
+    CHECK(table.GetBound() == bound);
+
+    for (long m = 0; m <= bound; m++) {
+      long found = -1;
+      CHECK(table.Solve(group->Generator().Exponentiate(ToScalar(m)), &found));
+      CHECK(found == m);
+    }
+    long found = -1;
+    CHECK_FALSE(table.Solve(group->Generator().Exponentiate(ToScalar(bound + 1)), &found));
+    CHECK_FALSE(table.Solve(group->Generator().Exponentiate(ToScalar(group->Order() - 1)), &found));
+    CHECK_FALSE(table.Solve(group->Generator().Exponentiate(group->RandomScalar()), &found));
+  }
+}
@@ -0,0 +1,435 @@
+#include "doctest/doctest.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include <crypto++/integer.h>
+
+#include "../include-shared/messages.hpp"
+#include "../include-shared/rng.hpp"
+#include "../include/drivers/crypto_driver.hpp"
+
+namespace {
+const int VERSIONS[] = {1, 2, 3};
+
+UInt2048 RandomElement() {
+  UInt2048 result;
+  REQUIRE(UInt2048::FromInteger(CryptoPP::Integer(ThreadRNG(), 2047), &result));
+  return result;
+}
+
+UInt256 RandomScalar() {
+  UInt256 result;
+  REQUIRE(UInt256::FromInteger(CryptoPP::Integer(ThreadRNG(), 255), &result));
+  return result;
+}
+
+CryptoPP::SecByteBlock RandomBlock(size_t size) {
+  CryptoPP::SecByteBlock block(size);
+  ThreadRNG().GenerateBlock(block, block.size());
+  return block;
+}
+
+const CryptoPP::DSA::PublicKey &VerificationKey() {
+  static const CryptoPP::DSA::PublicKey key =
+      CryptoDriver().DSA_generate_keys().second;
+  return key;
+}
+
+// Fixtures, written in the given version all the way down
+Vote_Struct MakeVote(int version) {
+  Vote_Struct vote;
+  vote.format_version = version;
+  vote.a = RandomElement();
+  vote.b = RandomElement();
+  return vote;
+}
+
+Votes_Struct MakeVotes(int version, int count) {
+  Votes_Struct votes;
+  votes.format_version = version;
+  for (int i = 0; i < count; i++) {
+    votes.votes.push_back(MakeVote(version));
+  }
+  return votes;
+}
+
+VoteZKPs_Struct MakeVoteZKPs(int version, int count) {
+  VoteZKPs_Struct zkps;
+  zkps.format_version = version;
+  for (int i = 0; i < count; i++) {
+    VoteZKP_Struct zkp;
+    zkp.format_version = version;
+    zkp.a0 = RandomElement();
+    zkp.a1 = RandomElement();
+    zkp.b0 = RandomElement();
+    zkp.b1 = RandomElement();
+    zkp.c0 = RandomScalar();
+    zkp.c1 = RandomScalar();
+    zkp.r0 = RandomScalar();
+    zkp.r1 = RandomScalar();
+    zkps.zkps.push_back(zkp);
+  }
+  return zkps;
+}
+
+Count_ZKPs_Struct MakeCountZKPs(int version, int count) {
+  Count_ZKPs_Struct zkps;
+  zkps.format_version = version;
+  for (int i = 0; i < count; i++) {
+    Count_ZKP_Struct zkp;
+    zkp.format_version = version;
+    zkp.a_i = RandomElement();
+    zkp.b_i = RandomElement();
+    zkp.c_i = RandomScalar();
+    zkp.r_i = RandomScalar();
+    zkps.count_zkps.push_back(zkp);
+  }
+  return zkps;
+}
+
+PartialDecryptions_Struct MakePartialDecryptions(int version, int count) {
+  PartialDecryptions_Struct decs;
+  decs.format_version = version;
+  for (int i = 0; i < count; i++) {
+    PartialDecryption_Struct dec;
+    dec.format_version = version;
+    dec.d = RandomElement();
+    dec.aggregate_ciphertext = MakeVote(version);
+    decs.decs.push_back(dec);
+  }
+  return decs;
+}
+
+DecryptionZKPs_Struct MakeDecryptionZKPs(int version, int count) {
+  DecryptionZKPs_Struct zkps;
+  zkps.format_version = version;
+  for (int i = 0; i < count; i++) {
+    DecryptionZKP_Struct zkp;
+    zkp.format_version = version;
+    zkp.u = RandomElement();
+    zkp.v = RandomElement();
+    zkp.s = RandomScalar();
+    zkp.sigma = RandomScalar();
+    zkps.zkps.push_back(zkp);
+  }
+  return zkps;
+}
+
+RegistrarToVoter_Certificate_Message MakeCertificate(int version) {
+  RegistrarToVoter_Certificate_Message cert;
+  cert.format_version = version;
+  cert.id = "voter";
+  cert.verification_key = VerificationKey();
+  cert.registrar_signature = "registrar signature";
+  return cert;
+}
+
+VoterToTallyer_Vote_Message MakeBallot(int outer_version, int version) {
+  VoterToTallyer_Vote_Message ballot;
+  ballot.format_version = outer_version;
+  ballot.cert = MakeCertificate(version);
+  ballot.votes = MakeVotes(version, 3);
+  ballot.zkps = MakeVoteZKPs(version, 3);
+  ballot.count_zkps = MakeCountZKPs(version, 3);
+  ballot.voter_signature = "voter signature";
+  return ballot;
+}
+
+/**
+ * Serializes message after some bytes already in the buffer, checks that
+ * serialized_size is what was written and that it reads back to the same
+ * bytes, and returns what was read.
+ */
+template <typename T> T RoundTrip(const T &message) {
+  std::vector<unsigned char> data = {0xAA, 0xBB};
+  message.serialize(data);
+  CHECK(data.size() - 2 == message.serialized_size());
+
+  std::span<const unsigned char> bytes = std::span(data).subspan(2);
+  CHECK(get_message_version(bytes) == message.format_version);
+  T decoded;
+  CHECK(decoded.deserialize(bytes) == bytes.size());
+
+  // vote messages are written back in the current version, so compare them
+  // in the version they came in
+  decoded.format_version = message.format_version;
+  std::vector<unsigned char> again;
+  decoded.serialize(again);
+  CHECK(again == std::vector<unsigned char>(bytes.begin(), bytes.end()));
+  return decoded;
+}
+
+/**
+ * Checks that every proper prefix of message fails to deserialize.
+ */
+template <typename T> void CheckTruncationThrows(const T &message) {
+  std::vector<unsigned char> data;
+  message.serialize(data);
+  for (int cut = 0; cut < data.size(); cut++) {
+    T decoded;
+    CAPTURE(cut);
+    CHECK_THROWS_AS(decoded.deserialize(std::span(data).first(cut)),
+                    std::runtime_error);
+  }
+}
+
+std::vector<unsigned char> Bytes(std::initializer_list<unsigned char> bytes) {
+  return std::vector<unsigned char>(bytes);
+}
+} // namespace
+
+TEST_CASE("every message round-trips in every version") {
+  for (int version : VERSIONS) {
+    CAPTURE(version);
+
+    HMACTagged_Wrapper wrapper;
+    wrapper.format_version = version;
+    wrapper.payload = {1, 2, 3, 0, 4};
+    wrapper.iv = RandomBlock(16);
+    wrapper.mac = "mac";
+    CHECK(RoundTrip(wrapper).payload == wrapper.payload);
+
+    UserToServer_DHPublicValue_Message user_dh;
+    user_dh.format_version = version;
+    user_dh.public_value = RandomBlock(256);
+    CHECK(RoundTrip(user_dh).public_value == user_dh.public_value);
+
+    ServerToUser_DHPublicValue_Message server_dh;
+    server_dh.format_version = version;
+    server_dh.server_public_value = RandomBlock(256);
+    server_dh.user_public_value = RandomBlock(256);
+    server_dh.server_signature = "server signature";
+    CHECK(RoundTrip(server_dh).server_signature == server_dh.server_signature);
+
+    VoterToRegistrar_Register_Message register_message;
+    register_message.format_version = version;
+    register_message.id = "voter";
+    register_message.user_verification_key = VerificationKey();
+    CHECK(RoundTrip(register_message).id == "voter");
+
+    CHECK(RoundTrip(MakeCertificate(version)).registrar_signature ==
+          "registrar signature");
+
+    Vote_Struct vote = MakeVote(version);
+    Vote_Struct vote_read = RoundTrip(vote);
+    CHECK(vote_read.a == vote.a);
+    CHECK(vote_read.b == vote.b);
+
+    for (int count : {0, 1, 3}) {
+      CHECK(RoundTrip(MakeVotes(version, count)).votes.size() == count);
+      RoundTrip(MakeVoteZKPs(version, count));
+      RoundTrip(MakeCountZKPs(version, count));
+      RoundTrip(MakePartialDecryptions(version, count));
+      RoundTrip(MakeDecryptionZKPs(version, count));
+    }
+
+    TallyerToWorld_Aggregate_Message aggregate;
+    aggregate.format_version = version;
+    aggregate.votes = MakeVotes(version, 3);
+    aggregate.ballot_count = CryptoPP::Integer(300);
+    aggregate.last_row_id = CryptoPP::Integer(70000);
+    aggregate.tallyer_signature = "tallyer signature";
+    TallyerToWorld_Aggregate_Message aggregate_read = RoundTrip(aggregate);
+    CHECK(aggregate_read.ballot_count == aggregate.ballot_count);
+    CHECK(aggregate_read.last_row_id == aggregate.last_row_id);
+
+    ArbiterToWorld_PartialDecryption_Message decryption;
+    decryption.format_version = version;
+    decryption.arbiter_id = "1";
+    decryption.arbiter_vk_path = "arbiter.pub";
+    decryption.decs = MakePartialDecryptions(version, 3);
+    decryption.zkps = MakeDecryptionZKPs(version, 3);
+    CHECK(RoundTrip(decryption).arbiter_vk_path == "arbiter.pub");
+  }
+
+  // version 1 vote messages also carried the vote count, so are only read
+  for (int version : {2, 3}) {
+    CAPTURE(version);
+    VoterToTallyer_Vote_Message ballot = MakeBallot(version, version);
+    CHECK(RoundTrip(ballot).voter_signature == "voter signature");
+
+    TallyerToWorld_Vote_Message vote_message;
+    vote_message.format_version = version;
+    vote_message.votes = ballot.votes;
+    vote_message.zkps = ballot.zkps;
+    vote_message.count_zkps = ballot.count_zkps;
+    vote_message.tallyer_signature = "tallyer signature";
+    CHECK(RoundTrip(vote_message).tallyer_signature == "tallyer signature");
+  }
+}
+
+TEST_CASE("version 1 vote messages still decode") {
+  VoterToTallyer_Vote_Message ballot = MakeBallot(1, 1);
+  Vote_Struct vote_count = MakeVote(1);
+
+  // the version 1 layout, with the vote count between the two proof lists
+  std::vector<unsigned char> data;
+  put_message_type(MessageType::VoterToTallyer_Vote_Message, 1, data);
+  ballot.cert.serialize(data);
+  ballot.votes.serialize(data);
+  ballot.zkps.serialize(data);
+  vote_count.serialize(data);
+  ballot.count_zkps.serialize(data);
+  put_string(ballot.voter_signature, data, 1);
+
+  VoterToTallyer_Vote_Message decoded;
+  CHECK(decoded.deserialize(data) == data.size());
+  CHECK(decoded.cert.id == "voter");
+  CHECK(decoded.votes.format_version == 1);
+  CHECK(decoded.votes.votes.size() == 3);
+  CHECK(decoded.votes.votes[2].b == ballot.votes.votes[2].b);
+  CHECK(decoded.zkps.zkps[0].a1 == ballot.zkps.zkps[0].a1);
+  CHECK(decoded.count_zkps.count_zkps[1].r_i == ballot.count_zkps.count_zkps[1].r_i);
+  CHECK(decoded.voter_signature == "voter signature");
+
+  // the signed lists are the version 1 bytes they came in
+  std::vector<unsigned char> votes_data;
+  ballot.votes.serialize(votes_data);
+  CHECK(std::vector<unsigned char>(decoded.votes_data.begin(),
+                                   decoded.votes_data.end()) == votes_data);
+
+  TallyerToWorld_Vote_Message row;
+  std::vector<unsigned char> row_data;
+  put_message_type(MessageType::TallyerToWorld_Vote_Message, 1, row_data);
+  ballot.votes.serialize(row_data);
+  ballot.zkps.serialize(row_data);
+  vote_count.serialize(row_data);
+  ballot.count_zkps.serialize(row_data);
+  put_string("tallyer signature", row_data, 1);
+  CHECK(row.deserialize(row_data) == row_data.size());
+  CHECK(row.count_zkps.count_zkps.size() == 3);
+  CHECK(row.tallyer_signature == "tallyer signature");
+}
+
+TEST_CASE("version 1 structs nest in a version 3 message") {
+  VoterToTallyer_Vote_Message ballot = MakeBallot(3, 1);
+  VoterToTallyer_Vote_Message decoded = RoundTrip(ballot);
+  CHECK(decoded.cert.format_version == 1);
+  CHECK(decoded.votes.format_version == 1);
+  CHECK(decoded.zkps.zkps[2].format_version == 1);
+  CHECK(decoded.zkps.zkps[2].b0 == ballot.zkps.zkps[2].b0);
+  CHECK(decoded.count_zkps.count_zkps[0].a_i == ballot.count_zkps.count_zkps[0].a_i);
+
+  ArbiterToWorld_PartialDecryption_Message decryption;
+  decryption.decs = MakePartialDecryptions(1, 2);
+  decryption.zkps = MakeDecryptionZKPs(2, 2);
+  ArbiterToWorld_PartialDecryption_Message decryption_read = RoundTrip(decryption);
+  CHECK(decryption_read.decs.decs[1].d == decryption.decs.decs[1].d);
+  CHECK(decryption_read.zkps.zkps[1].v == decryption.zkps.zkps[1].v);
+}
+
+TEST_CASE("version 3 proofs carry only challenges and responses") {
+  VoteZKPs_Struct zkps = MakeVoteZKPs(3, 2);
+  VoteZKPs_Struct zkps_read = RoundTrip(zkps);
+  VoteZKPs_Struct full = zkps;
+  full.format_version = 2;
+  for (auto &zkp : full.zkps) {
+    zkp.format_version = 2;
+  }
+  CHECK(zkps.serialized_size() < full.serialized_size());
+  for (int i = 0; i < zkps.zkps.size(); i++) {
+    CHECK(zkps_read.zkps[i].c0 == zkps.zkps[i].c0);
+    CHECK(zkps_read.zkps[i].c1 == zkps.zkps[i].c1);
+    CHECK(zkps_read.zkps[i].r0 == zkps.zkps[i].r0);
+    CHECK(zkps_read.zkps[i].r1 == zkps.zkps[i].r1);
+  }
+
+  Count_ZKPs_Struct count_zkps = MakeCountZKPs(3, 2);
+  Count_ZKPs_Struct count_read = RoundTrip(count_zkps);
+  CHECK(count_read.count_zkps[1].c_i == count_zkps.count_zkps[1].c_i);
+  CHECK(count_read.count_zkps[1].r_i == count_zkps.count_zkps[1].r_i);
+
+  DecryptionZKPs_Struct decryption_zkps = MakeDecryptionZKPs(3, 2);
+  DecryptionZKPs_Struct decryption_read = RoundTrip(decryption_zkps);
+  CHECK(decryption_read.zkps[0].sigma == decryption_zkps.zkps[0].sigma);
+  CHECK(decryption_read.zkps[0].s == decryption_zkps.zkps[0].s);
+}
+
+TEST_CASE("group elements of every width round-trip") {
+  // zero and small values are written in as few bytes as they need
+  for (int version : VERSIONS) {
+    for (std::uint64_t word : {0, 1, 255, 256}) {
+      Vote_Struct vote;
+      vote.format_version = version;
+      vote.a = UInt2048::FromWord(word);
+      vote.b = RandomElement();
+      CHECK(RoundTrip(vote).a == vote.a);
+    }
+  }
+}
+
+TEST_CASE("sizes are varints from version 2") {
+  for (size_t n : {size_t(0), size_t(127), size_t(128), size_t(300),
+                   size_t(1) << 32, ~size_t(0)}) {
+    for (int version : VERSIONS) {
+      std::vector<unsigned char> data;
+      int written = put_size(n, data, version);
+      CHECK(written == data.size());
+      CHECK(size_of_size(n, version) == data.size());
+      size_t read;
+      CHECK(get_size(&read, data, 0, version) == written);
+      CHECK(read == n);
+    }
+  }
+
+  size_t n;
+  CHECK(get_size(&n, Bytes({0xAC, 0x02}), 0, 2) == 2);
+  CHECK(n == 300);
+}
+
+TEST_CASE("truncated and overlong sizes throw") {
+  size_t n;
+  CHECK_THROWS_AS(get_size(&n, Bytes({}), 0, 2), std::runtime_error);
+  CHECK_THROWS_AS(get_size(&n, Bytes({0x80}), 0, 2), std::runtime_error);
+  CHECK_THROWS_AS(get_size(&n, Bytes({0xFF, 0xFF, 0xFF}), 0, 3), std::runtime_error);
+  CHECK_THROWS_AS(get_size(&n, Bytes({0x01, 0x02, 0x03}), 0, 1), std::runtime_error);
+
+  // ten bytes already carry every bit of a size; an eleventh is overlong
+  std::vector<unsigned char> overlong(10, 0xFF);
+  overlong.push_back(0x01);
+  CHECK_THROWS_AS(get_size(&n, overlong, 0, 2), std::runtime_error);
+
+  // a string or integer longer than what is left
+  std::string s;
+  CHECK_THROWS_AS(get_string(&s, Bytes({0x05, 'a', 'b'}), 0, 2), std::runtime_error);
+  UInt2048 element;
+  CHECK_THROWS_AS(get_integer(&element, Bytes({0x03, 0x01}), 0, 3), std::runtime_error);
+  UInt256 scalar;
+  CHECK_THROWS_AS(get_integer(&scalar, Bytes({0x01, 0x02}), 0, 3), std::runtime_error);
+}
+
+TEST_CASE("empty messages have no type or version") {
+  CHECK_THROWS_AS(get_message_type(Bytes({})), std::runtime_error);
+  CHECK_THROWS_AS(get_message_version(Bytes({})), std::runtime_error);
+  CHECK(get_message_type(Bytes({MessageType::Votes_Struct | MESSAGE_V3})) ==
+        MessageType::Votes_Struct);
+  CHECK(get_message_version(Bytes({MessageType::Votes_Struct | MESSAGE_V2})) == 2);
+  CHECK(get_message_version(Bytes({MessageType::Votes_Struct})) == 1);
+}
+
+TEST_CASE("truncated messages throw") {
+  for (int version : VERSIONS) {
+    CAPTURE(version);
+    CheckTruncationThrows(MakeVotes(version, 2));
+    CheckTruncationThrows(MakeVoteZKPs(version, 2));
+    CheckTruncationThrows(MakeDecryptionZKPs(version, 1));
+  }
+  CheckTruncationThrows(MakeBallot(3, 3));
+  CheckTruncationThrows(MakeBallot(3, 1));
+}
+
+TEST_CASE("an oversized group element reads as a non-element") {
+  // 257 bytes cannot be a group element, so it reads as all ones
+  std::vector<unsigned char> data;
+  put_message_type(MessageType::Vote_Struct, 2, data);
+  put_size(257, data, 2);
+  data.insert(data.end(), 257, 0x01);
+  put_integer(UInt2048::FromWord(1), data, 2);
+
+  Vote_Struct vote;
+  CHECK(vote.deserialize(data) == data.size());
+  CHECK(vote.a.BitCount() == 2048);
+  CHECK(vote.a[0] == ~std::uint64_t(0));
+  CHECK(vote.b == UInt2048::FromWord(1));
+}
@@ -0,0 +1,186 @@
+#include "doctest/doctest.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include <crypto++/integer.h>
+#include <crypto++/nbtheory.h>
+
+#include "../include-shared/constants.hpp"
+#include "../include-shared/fixed_uint.hpp"
+#include "../include-shared/rng.hpp"
+#include "../include/pkg/group_traits.hpp"
+#include "../include/pkg/multi_buffer.hpp"
+
+namespace {
+using Traits = ModP2048Traits;
+
+CryptoPP::Integer RandomBelow(const CryptoPP::Integer &bound) {
+  return CryptoPP::Integer(ThreadRNG(), CryptoPP::Integer::Zero(),
+                           bound - CryptoPP::Integer::One());
+}
+
+UInt2048 ToFixed(const CryptoPP::Integer &x) {
+  UInt2048 result;
+  REQUIRE(UInt2048::FromInteger(x, &result));
+  return result;
+}
+
+UInt256 RandomExponent() {
+  UInt256 result;
+  REQUIRE(UInt256::FromInteger(CryptoPP::Integer(ThreadRNG(), 256), &result));
+  return result;
+}
+
+// A random odd 2048-bit modulus with its top bit set, of no special form
+UInt2048 RandomModulus() {
+  CryptoPP::Integer x(ThreadRNG(), 2048);
+  x.SetBit(2047);
+  x.SetBit(0);
+  return ToFixed(x);
+}
+
+// An engine on every kernel this CPU can run
+std::vector<MultiBufferModExp> Engines(const UInt2048 &modulus) {
+  std::vector<MultiBufferModExp> engines;
+  for (auto kernel : {MultiBufferModExp::Kernel::AVX512_IFMA,
+                      MultiBufferModExp::Kernel::AVX2,
+                      MultiBufferModExp::Kernel::SCALAR}) {
+    try {
+      engines.emplace_back(modulus, kernel);
+    } catch (std::runtime_error &) {
+      MESSAGE("skipping a kernel this CPU does not support");
+    }
+  }
+  return engines;
+}
+
+// The modulus of the RFC 5114 group and a random one
+std::vector<UInt2048> Moduli() {
+  return {Traits::MODULUS, RandomModulus()};
+}
+} // namespace
+
+TEST_CASE("multi-buffer exponentiation matches ModularExponentiation") {
+  for (const UInt2048 &modulus : Moduli()) {
+    CryptoPP::Integer p = modulus.ToInteger();
+    CryptoPP::Integer all_ones = CryptoPP::Integer::Power2(2048) - CryptoPP::Integer::One();
+
+    for (auto &engine : Engines(modulus)) {
+      // lengths around and between the lane counts, and none at all
+      for (int count : {0, 1, 3, 4, 5, 8, 13, 17}) {
+        std::vector<UInt2048> bases;
+        std::vector<UInt256> exponents;
+        for (int i = 0; i < count; i++) {
+          bases.push_back(ToFixed(RandomBelow(p)));
+          exponents.push_back(RandomExponent());
+        }
+        std::vector<UInt2048> powers = engine.Exponentiate(bases, exponents);
+        REQUIRE(powers.size() == count);
+        for (int i = 0; i < count; i++) {
+          CHECK(powers[i].ToInteger() ==
+                CryptoPP::ModularExponentiation(bases[i].ToInteger(),
+                                                exponents[i].ToInteger(), p));
+        }
+      }
+
+      // exponent 0, base 0, base 1, base p - 1, and a base above p
+      std::vector<UInt2048> bases = {
+          ToFixed(RandomBelow(p)), UInt2048::FromWord(0), UInt2048::FromWord(1),
+          UInt2048::FromWord(1), ToFixed(p - 1), ToFixed(p - 1),
+          ToFixed(all_ones), ToFixed(all_ones)};
+      std::vector<UInt256> exponents = {
+          UInt256::FromWord(0), UInt256::FromWord(5), UInt256::FromWord(0),
+          Traits::ORDER, UInt256::FromWord(2), UInt256::FromWord(3),
+          UInt256::FromWord(1), Traits::ORDER};
+      std::vector<UInt2048> powers = engine.Exponentiate(bases, exponents);
+      REQUIRE(powers.size() == bases.size());
+      CHECK(powers[0] == UInt2048::FromWord(1));
+      CHECK(powers[1] == UInt2048::FromWord(0));
+      CHECK(powers[2] == UInt2048::FromWord(1));
+      CHECK(powers[3] == UInt2048::FromWord(1));
+      CHECK(powers[4] == UInt2048::FromWord(1));
+      CHECK(powers[5] == ToFixed(p - 1));
+      for (int i = 6; i < bases.size(); i++) {
+        CHECK(powers[i].ToInteger() ==
+              CryptoPP::ModularExponentiation(all_ones, exponents[i].ToInteger(), p));
+      }
+    }
+  }
+}
+
+TEST_CASE("multi-buffer exponentiation rejects mismatched inputs") {
+  for (auto &engine : Engines(Traits::MODULUS)) {
+    CHECK_THROWS(engine.Exponentiate({UInt2048::FromWord(2)}, {}));
+  }
+}
+
+TEST_CASE("multi-buffer product matches the product mod p") {
+  for (const UInt2048 &modulus : Moduli()) {
+    CryptoPP::Integer p = modulus.ToInteger();
+    for (auto &engine : Engines(modulus)) {
+      for (int count : {0, 1, 2, 7, 8, 9, 21}) {
+        std::vector<UInt2048> factors;
+        CryptoPP::Integer expected = CryptoPP::Integer::One();
+        for (int i = 0; i < count; i++) {
+          // unreduced factors, up to 2^2048 - 1, are allowed
+          CryptoPP::Integer x = i == 0 ? CryptoPP::Integer::Power2(2048) - 1
+                                       : RandomBelow(p);
+          factors.push_back(ToFixed(x));
+          expected = expected * x % p;
+        }
+        CHECK(engine.Multiply(factors).ToInteger() == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("Montgomery constants match their definitions") {
+  CryptoPP::Integer p = Traits::MODULUS.ToInteger();
+  CryptoPP::Integer word = CryptoPP::Integer::Power2(64);
+
+  CHECK((CryptoPP::Integer(Traits::MONTGOMERY_INVERSE) * Traits::MODULUS[0] + 1) % word ==
+        CryptoPP::Integer::Zero());
+  CHECK(Traits::MONTGOMERY_R.ToInteger() == CryptoPP::Integer::Power2(2048) % p);
+  CHECK(Traits::MONTGOMERY_R_SQUARED.ToInteger() == CryptoPP::Integer::Power2(4096) % p);
+
+  CryptoPP::Integer q = Traits::ORDER.ToInteger();
+  CHECK(Traits::ORDER_MONTGOMERY_R.ToInteger() == CryptoPP::Integer::Power2(256) % q);
+  CHECK(Traits::ORDER_MONTGOMERY_R_SQUARED.ToInteger() == CryptoPP::Integer::Power2(512) % q);
+}
+
+TEST_CASE("Montgomery multiplication matches a * b / R mod p") {
+  for (const UInt2048 &modulus : Moduli()) {
+    CryptoPP::Integer p = modulus.ToInteger();
+    std::uint64_t inverse = NegatedInverse(modulus[0]);
+    CryptoPP::Integer r_inverse = CryptoPP::Integer::Power2(2048).InverseMod(p);
+
+    std::vector<CryptoPP::Integer> values = {CryptoPP::Integer::Zero(),
+                                             CryptoPP::Integer::One(), p - 1};
+    for (int i = 0; i < 8; i++) {
+      values.push_back(RandomBelow(p));
+    }
+    for (auto &a : values) {
+      for (auto &b : values) {
+        UInt2048 product = MontgomeryMultiply(ToFixed(a), ToFixed(b), modulus, inverse);
+        CHECK(product.ToInteger() == a * b * r_inverse % p);
+      }
+      CHECK(MontgomerySquare(ToFixed(a), modulus, inverse) ==
+            MontgomeryMultiply(ToFixed(a), ToFixed(a), modulus, inverse));
+    }
+  }
+}
+
+TEST_CASE("Montgomery multiplication agrees at compile time and at runtime") {
+  // the portable kernel, evaluated by the compiler
+  constexpr UInt2048 compile_time =
+      MontgomeryMultiply(Traits::GENERATOR, Traits::MONTGOMERY_R_SQUARED,
+                         Traits::MODULUS, Traits::MONTGOMERY_INVERSE);
+  // MULX/ADX where the CPU has them
+  UInt2048 runtime =
+      MontgomeryMultiply(Traits::GENERATOR, Traits::MONTGOMERY_R_SQUARED,
+                         Traits::MODULUS, Traits::MONTGOMERY_INVERSE);
+  CHECK(compile_time == runtime);
+  CHECK(runtime.ToInteger() ==
+        DL_G * CryptoPP::Integer::Power2(2048) % DL_P);
+}